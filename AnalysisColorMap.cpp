@@ -0,0 +1,225 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisColorMap.cpp
+
+#include "stdafx.h"
+#include "AnalysisColorMap.h"
+
+// Evenly spaced control colors of the built in maps, from 0.0 to 1.0.
+// The colors in between are interpolated linearly.
+
+static const ON_Color g_viridis[] =
+{
+  ON_Color(68, 1, 84), ON_Color(71, 44, 122), ON_Color(59, 81, 139), ON_Color(44, 113, 142),
+  ON_Color(33, 144, 141), ON_Color(39, 173, 129), ON_Color(92, 200, 99), ON_Color(170, 220, 50),
+  ON_Color(253, 231, 37)
+};
+
+static const ON_Color g_turbo[] =
+{
+  ON_Color(48, 18, 59), ON_Color(73, 62, 175), ON_Color(68, 106, 238), ON_Color(50, 149, 247),
+  ON_Color(38, 189, 225), ON_Color(41, 221, 187), ON_Color(64, 243, 146), ON_Color(102, 253, 109),
+  ON_Color(150, 250, 80), ON_Color(198, 235, 59), ON_Color(238, 208, 45), ON_Color(255, 171, 36),
+  ON_Color(255, 128, 29), ON_Color(238, 84, 21), ON_Color(201, 45, 12), ON_Color(161, 18, 2),
+  ON_Color(122, 4, 3)
+};
+
+static const ON_Color g_cool_warm[] =
+{
+  ON_Color(59, 76, 192), ON_Color(98, 130, 234), ON_Color(141, 176, 254), ON_Color(184, 208, 249),
+  ON_Color(221, 221, 221), ON_Color(245, 196, 173), ON_Color(244, 154, 123), ON_Color(222, 96, 77),
+  ON_Color(180, 4, 38)
+};
+
+static const wchar_t* g_type_names[CAnalysisColorMap::map_type_count] =
+{
+  L"Rainbow",
+  L"Viridis",
+  L"Turbo",
+  L"CoolWarm",
+  L"Custom"
+};
+
+static ON_Color LerpColor(const ON_Color& a, const ON_Color& b, double t)
+{
+  const int r = ON_Round(a.Red() + t * (b.Red() - a.Red()));
+  const int g = ON_Round(a.Green() + t * (b.Green() - a.Green()));
+  const int bl = ON_Round(a.Blue() + t * (b.Blue() - a.Blue()));
+  return ON_Color(r, g, bl);
+}
+
+// Interpolates evenly spaced colors at a parameter in [0,1]
+static ON_Color EvaluateColors(const ON_Color* colors, int count, double s)
+{
+  const double t = s * (count - 1);
+  int i = (int)t;
+  if (i >= count - 1)
+    i = count - 2;
+  return LerpColor(colors[i], colors[i + 1], t - i);
+}
+
+CAnalysisColorMap::CAnalysisColorMap()
+  : m_type(rainbow)
+  , m_band_count(0)
+{
+}
+
+bool CAnalysisColorMap::operator==(const CAnalysisColorMap& other) const
+{
+  if (m_type != other.m_type || m_band_count != other.m_band_count)
+    return false;
+  if (m_colors.Count() != other.m_colors.Count())
+    return false;
+  for (int i = 0; i < m_colors.Count(); i++)
+  {
+    if (m_colors[i] != other.m_colors[i])
+      return false;
+  }
+  return true;
+}
+
+bool CAnalysisColorMap::operator!=(const CAnalysisColorMap& other) const
+{
+  return !operator==(other);
+}
+
+bool CAnalysisColorMap::SetCustomColors(const ON_Color* colors, int count)
+{
+  if (nullptr == colors || count < 2)
+    return false;
+  m_type = custom;
+  m_colors.SetCapacity(count);
+  m_colors.SetCount(0);
+  m_colors.Append(count, colors);
+  return true;
+}
+
+const wchar_t* CAnalysisColorMap::TypeName(map_type type)
+{
+  if (type < 0 || type >= map_type_count)
+    return nullptr;
+  return g_type_names[type];
+}
+
+int CAnalysisColorMap::FindType(const wchar_t* name)
+{
+  if (nullptr == name)
+    return -1;
+  for (int i = 0; i < map_type_count; i++)
+  {
+    if (ON_wString(g_type_names[i]).EqualOrdinal(name, true))
+      return i;
+  }
+  return -1;
+}
+
+ON_Color CAnalysisColorMap::Evaluate(double s) const
+{
+  if (!(s >= 0.0))
+    s = 0.0;
+  else if (s > 1.0)
+    s = 1.0;
+
+  // Each band has the color of its lower end, except the last, which
+  // has the color at 1.0, so the bands span the whole map.
+  if (m_band_count > 1)
+  {
+    int band = (int)(s * m_band_count);
+    if (band >= m_band_count)
+      band = m_band_count - 1;
+    s = (double)band / (double)(m_band_count - 1);
+  }
+
+  ON_Color color;
+  switch (m_type)
+  {
+  case viridis:
+    color = EvaluateColors(g_viridis, sizeof(g_viridis) / sizeof(g_viridis[0]), s);
+    break;
+  case turbo:
+    color = EvaluateColors(g_turbo, sizeof(g_turbo) / sizeof(g_turbo[0]), s);
+    break;
+  case cool_warm:
+    color = EvaluateColors(g_cool_warm, sizeof(g_cool_warm) / sizeof(g_cool_warm[0]), s);
+    break;
+  case custom:
+    if (m_colors.Count() > 1)
+    {
+      color = EvaluateColors(m_colors.Array(), m_colors.Count(), s);
+      break;
+    }
+    // A custom map without colors is drawn as a rainbow
+  default:
+    // Hue sweeps from red (0) through green to blue (4/3 pi)
+    color.SetHSV(s * 4.0 * ON_PI / 3.0, 1.0, 1.0);
+    break;
+  }
+
+  return color;
+}
+
+bool CAnalysisColorMap::Write(ON_BinaryArchive& archive) const
+{
+  bool rc = archive.BeginWrite3dmChunk(TCODE_ANONYMOUS_CHUNK, 1, 0);
+  if (!rc)
+    return false;
+
+  for (;;)
+  {
+    rc = archive.WriteInt((int)m_type);
+    if (!rc) break;
+
+    rc = archive.WriteInt(m_band_count);
+    if (!rc) break;
+
+    rc = archive.WriteArray(m_colors);
+    if (!rc) break;
+
+    break;
+  }
+
+  if (!archive.EndWrite3dmChunk())
+    rc = false;
+
+  return rc;
+}
+
+bool CAnalysisColorMap::Read(ON_BinaryArchive& archive)
+{
+  *this = CAnalysisColorMap();
+
+  int major_version = 0;
+  int minor_version = 0;
+  bool rc = archive.BeginRead3dmChunk(TCODE_ANONYMOUS_CHUNK, &major_version, &minor_version);
+  if (!rc)
+    return false;
+
+  for (;;)
+  {
+    rc = (1 == major_version);
+    if (!rc) break;
+
+    int type = rainbow;
+    rc = archive.ReadInt(&type);
+    if (!rc) break;
+
+    rc = archive.ReadInt(&m_band_count);
+    if (!rc) break;
+
+    rc = archive.ReadArray(m_colors);
+    if (!rc) break;
+
+    // Maps from newer versions fall back to the rainbow
+    m_type = (type >= 0 && type < map_type_count) ? (map_type)type : rainbow;
+    if (m_band_count < 0 || m_band_count > max_band_count)
+      m_band_count = 0;
+
+    break;
+  }
+
+  if (!archive.EndRead3dmChunk())
+    rc = false;
+
+  return rc;
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisColorMap.h
+
+#pragma once
+
+// CAnalysisColorMap
+// Describes how normalized analysis parameters, from 0.0 at
+// m_redblue[0] to 1.0 at m_redblue[1], become colors. A map is either
+// one of the built in maps or a list of user colors, and can be split
+// into a number of bands of constant color. The colors themselves are
+// looked up in a CAnalysisColorTable built from the map.
+//
+
+class CAnalysisColorMap
+{
+public:
+  enum map_type : int
+  {
+    rainbow = 0,    // hue from red to blue, the original analysis colors
+    viridis = 1,    // perceptually uniform, dark blue to yellow
+    turbo = 2,      // rainbow-like, dark blue to dark red
+    cool_warm = 3,  // diverging, blue to gray to red
+    custom = 4,     // m_colors[], evenly spaced
+    map_type_count = 5
+  };
+
+  // Largest number of bands
+  enum { max_band_count = 256 };
+
+  CAnalysisColorMap();
+  ~CAnalysisColorMap() = default;
+
+  bool operator==(const CAnalysisColorMap& other) const;
+  bool operator!=(const CAnalysisColorMap& other) const;
+
+  /*
+  Description:
+    Makes a map from user colors.
+  Parameters:
+    colors - [in] at least two colors. colors[0] is used at 0.0 and
+                  the last color at 1.0.
+    count  - [in] number of colors.
+  Returns:
+    True if successful.
+  */
+  bool SetCustomColors(const ON_Color* colors, int count);
+
+  // The English name of a map type, such as "Viridis", or nullptr.
+  static const wchar_t* TypeName(map_type type);
+
+  // The map type with a name, ignoring case, or -1.
+  static int FindType(const wchar_t* name);
+
+  /*
+  Description:
+    Evaluates the map, including its bands. This is slow; use
+    CAnalysisColorTable to color many values.
+  Parameters:
+    s - [in] normalized parameter. Values outside of [0,1] are clamped.
+  */
+  ON_Color Evaluate(double s) const;
+
+  bool Write(ON_BinaryArchive& archive) const;
+  bool Read(ON_BinaryArchive& archive);
+
+  map_type m_type;
+
+  // Number of bands of constant color, or 0 for a continuous map.
+  // A single band is the same as a continuous map.
+  int m_band_count;
+
+  // The colors of a custom map. Empty for the built in maps.
+  ON_SimpleArray<ON_Color> m_colors;
+};
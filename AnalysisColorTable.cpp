@@ -0,0 +1,275 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisColorTable.cpp
+
+#include "stdafx.h"
+#include "AnalysisColorTable.h"
+#include "AnalysisTexture.h"
+
+CAnalysisColorTable::CAnalysisColorTable(const CAnalysisColorMap& map)
+  : m_map(map)
+  , m_ref_count(0)
+{
+  for (int i = 0; i < color_count; i++)
+  {
+    const double s = (double)i / (double)(color_count - 1);
+    m_colors[i] = map.Evaluate(s);
+    m_runs[i] = (0 == i) ? 0 : m_runs[i - 1] + (m_colors[i] != m_colors[i - 1] ? 1 : 0);
+  }
+}
+
+const CAnalysisColorTable& CAnalysisColorTable::Default()
+{
+  static const CAnalysisColorTable& table = Get(CAnalysisColorMap());
+  return table;
+}
+
+// Number of custom tables that are kept when no mesh references them,
+// so switching between a few custom maps does not rebuild them
+static const int g_unused_custom_tables = 8;
+
+// The tables that have been built, the most recently used last.
+// Switching between a few maps, or coloring meshes with different
+// maps, does not rebuild any table.
+class CAnalysisColorTableCache
+{
+public:
+  ~CAnalysisColorTableCache()
+  {
+    for (int i = 0; i < m_tables.Count(); i++)
+      delete m_tables[i];
+  }
+
+  // Deletes the custom tables that are not referenced, apart from the
+  // most recently used ones. Called with the lock held.
+  void DeleteUnusedTables()
+  {
+    int unused_count = 0;
+    for (int i = m_tables.Count() - 1; i >= 0; i--)
+    {
+      CAnalysisColorTable* table = m_tables[i];
+      if (CAnalysisColorMap::custom != table->m_map.m_type || table->m_ref_count > 0)
+        continue;
+      if (++unused_count <= g_unused_custom_tables)
+        continue;
+      CAnalysisTexture::DeleteBitmapFile(*table);
+      m_tables.Remove(i);
+      delete table;
+    }
+  }
+
+  concurrency::critical_section m_lock;
+  ON_SimpleArray<CAnalysisColorTable*> m_tables;
+};
+
+const CAnalysisColorTable& CAnalysisColorTable::Get(const CAnalysisColorMap& map)
+{
+  static CAnalysisColorTableCache cache;
+
+  concurrency::critical_section::scoped_lock lock(cache.m_lock);
+  for (int i = cache.m_tables.Count() - 1; i >= 0; i--)
+  {
+    CAnalysisColorTable* table = cache.m_tables[i];
+    if (table->m_map == map)
+    {
+      // Custom tables that were just used are the last to be deleted
+      if (CAnalysisColorMap::custom == map.m_type && i + 1 < cache.m_tables.Count())
+      {
+        cache.m_tables.Remove(i);
+        cache.m_tables.Append(table);
+      }
+      return *table;
+    }
+  }
+
+  CAnalysisColorTable* table = new CAnalysisColorTable(map);
+  cache.m_tables.Append(table);
+  if (CAnalysisColorMap::custom == map.m_type)
+    cache.DeleteUnusedTables();
+  return *table;
+}
+
+void CAnalysisColorTable::AddRef(const CAnalysisColorTable* table)
+{
+  if (table)
+    InterlockedIncrement(&table->m_ref_count);
+}
+
+void CAnalysisColorTable::Release(const CAnalysisColorTable* table)
+{
+  if (table)
+    InterlockedDecrement(&table->m_ref_count);
+}
+
+const CAnalysisColorMap& CAnalysisColorTable::ColorMap() const
+{
+  return m_map;
+}
+
+ON_Color CAnalysisColorTable::Color(double s) const
+{
+  double t = s * (color_count - 1) + 0.5;
+  if (!(t >= 0.0))
+    t = 0.0;
+  else if (t > color_count - 1)
+    t = color_count - 1;
+  return m_colors[(int)t];
+}
+
+const ON_Color* CAnalysisColorTable::Colors() const
+{
+  return m_colors;
+}
+
+// Maps a value to a table index, exactly as MapValues() does
+class CTableIndex
+{
+public:
+  CTableIndex(const ON_Interval& redblue)
+    : m_max_index((double)(CAnalysisColorTable::color_count - 1))
+  {
+    m_scale = m_max_index / (redblue[1] - redblue[0]);
+    m_offset = 0.5 - redblue[0] * m_scale;
+  }
+
+  int operator()(double value) const
+  {
+    double t = value * m_scale + m_offset;
+    t = (t >= 0.0) ? t : 0.0;    // also maps NaN to index 0
+    t = (t <= m_max_index) ? t : m_max_index;
+    return (int)t;
+  }
+
+private:
+  double m_max_index;
+  double m_scale;
+  double m_offset;
+};
+
+template <class T>
+void CAnalysisColorTable::MapValues(const T* values, int count, const ON_Interval& redblue, ON_Color* colors) const
+{
+  if (nullptr == values || nullptr == colors || count <= 0)
+    return;
+
+  int i;
+  if (redblue[0] == redblue[1])
+  {
+    const double s = redblue[0];
+    const ON_Color red(255, 0, 0);
+    const ON_Color green(0, 255, 0);
+    const ON_Color blue(0, 0, 255);
+    for (i = 0; i < count; i++)
+      colors[i] = (values[i] < s) ? red : ((values[i] > s) ? blue : green);
+    return;
+  }
+
+  // The normalized parameter, scaled to a table index, is
+  // a * scale + offset. The loop has no calls and no data dependent
+  // branches, so the compiler can vectorize the index computation.
+  const CTableIndex index(redblue);
+  const ON_Color* table = m_colors;
+  for (i = 0; i < count; i++)
+    colors[i] = table[index(values[i])];
+}
+
+template <class T>
+int CAnalysisColorTable::RecolorValues(const T* values, const int* sorted, int count, const ON_Interval& old_redblue, const ON_Interval& new_redblue, ON_Color* colors) const
+{
+  if (nullptr == values || nullptr == sorted || nullptr == colors || count <= 0)
+    return 0;
+
+  // The red, green and blue of an empty range are not in the table
+  if (old_redblue[0] == old_redblue[1] || new_redblue[0] == new_redblue[1])
+  {
+    MapValues(values, count, new_redblue, colors);
+    return count;
+  }
+
+  // NaN values are first and are always the first color
+  int first = 0;
+  int last = count;
+  while (first < last)
+  {
+    const int mid = first + (last - first) / 2;
+    const double v = values[sorted[mid]];
+    if (v != v)
+      first = mid + 1;
+    else
+      last = mid;
+  }
+
+  // Both indices are monotonic in the value, and so are their color
+  // runs, so the values whose old and new colors are both in the same
+  // runs are a run of the sorted values. The end of each run is found
+  // with a binary search. A banded map has few color runs.
+  const CTableIndex old_index(old_redblue);
+  const CTableIndex new_index(new_redblue);
+
+  // The runs whose colors change. If more than a quarter of the
+  // colors change, one pass over the values in memory order is faster
+  // than writing them in sorted order.
+  class CRecolorRun
+  {
+  public:
+    int m_start;
+    int m_end;
+    int m_index;
+  };
+  ON_SimpleArray<CRecolorRun> runs(256);
+
+  int changed = 0;
+  int i = first;
+  while (i < count)
+  {
+    const double v = values[sorted[i]];
+    const int oi = old_index(v);
+    const int ni = new_index(v);
+    const int old_run = m_runs[oi];
+    const int new_run = m_runs[ni];
+
+    int lo = i + 1;
+    int hi = count;
+    while (lo < hi)
+    {
+      const int mid = lo + (hi - lo) / 2;
+      const double w = values[sorted[mid]];
+      if (m_runs[old_index(w)] == old_run && m_runs[new_index(w)] == new_run)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    if (m_colors[oi] != m_colors[ni])
+    {
+      CRecolorRun& run = runs.AppendNew();
+      run.m_start = i;
+      run.m_end = lo;
+      run.m_index = ni;
+      changed += lo - i;
+      if (changed > count / 4)
+      {
+        MapValues(values, count, new_redblue, colors);
+        return count;
+      }
+    }
+
+    i = lo;
+  }
+
+  for (int r = 0; r < runs.Count(); r++)
+  {
+    const ON_Color color = m_colors[runs[r].m_index];
+    for (int j = runs[r].m_start; j < runs[r].m_end; j++)
+      colors[sorted[j]] = color;
+  }
+
+  return changed;
+}
+
+// The values are stored in double or single precision
+template void CAnalysisColorTable::MapValues<double>(const double*, int, const ON_Interval&, ON_Color*) const;
+template void CAnalysisColorTable::MapValues<float>(const float*, int, const ON_Interval&, ON_Color*) const;
+template int CAnalysisColorTable::RecolorValues<double>(const double*, const int*, int, const ON_Interval&, const ON_Interval&, ON_Color*) const;
+template int CAnalysisColorTable::RecolorValues<float>(const float*, const int*, int, const ON_Interval&, const ON_Interval&, ON_Color*) const;
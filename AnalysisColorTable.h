@@ -0,0 +1,128 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisColorTable.h
+
+#pragma once
+
+#include "AnalysisColorMap.h"
+
+// CAnalysisColorTable
+// The false colors of a color map, precomputed at evenly spaced
+// parameters from 0.0 to 1.0, so mapping analysis values to colors is
+// a multiply and a table lookup rather than a color map evaluation for
+// every vertex. Tables are built once for each color map and shared.
+// The tables of the built in maps are kept until the plug-in is
+// unloaded. The tables of custom maps are kept while a mesh uses them,
+// so scripts that set many custom maps do not fill up memory.
+//
+
+class CAnalysisColorTable
+{
+public:
+  // Number of colors in the table
+  enum { color_count = 4096 };
+
+  explicit CAnalysisColorTable(const CAnalysisColorMap& map);
+  ~CAnalysisColorTable() = default;
+
+  // The table of the default color map, the red to blue rainbow.
+  static const CAnalysisColorTable& Default();
+
+  /*
+  Description:
+    Gets the shared table of a color map. The table is built the first
+    time the map is used. Safe to call from any thread.
+  Parameters:
+    map - [in] the color map.
+  Returns:
+    The table. Tables of the built in maps are valid until the
+    plug-in is unloaded. Tables of custom maps are valid while they
+    are referenced, see AddRef(), and otherwise until a few more
+    custom tables have been built.
+  */
+  static const CAnalysisColorTable& Get(const CAnalysisColorMap& map);
+
+  /*
+  Description:
+    References a table while a mesh is colored with it. When a custom
+    table is built, the custom tables that are not referenced are
+    deleted, apart from the most recently used few, along with their
+    bitmaps. See CAnalysisTexture::GetBitmapFile(). Safe to call from
+    any thread.
+  Parameters:
+    table - [in] a table from Get(), or nullptr.
+  */
+  static void AddRef(const CAnalysisColorTable* table);
+  static void Release(const CAnalysisColorTable* table);
+
+  // The color map the table was built from.
+  const CAnalysisColorMap& ColorMap() const;
+
+  /*
+  Description:
+    Gets the color at a normalized parameter.
+  Parameters:
+    s - [in] 0.0 = the start of the map, red for the rainbow, and
+             1.0 = the end of the map, blue for the rainbow. Values
+             outside of [0,1] are clamped.
+  */
+  ON_Color Color(double s) const;
+
+  // The color_count colors of the table, from 0.0 to 1.0.
+  const ON_Color* Colors() const;
+
+  /*
+  Description:
+    Maps analysis values to colors.
+  Parameters:
+    values  - [in] analysis values, doubles or floats.
+    count   - [in] number of values.
+    redblue - [in] redblue[0] is the value that maps to the start of
+                   the map and redblue[1] the value that maps to the
+                   end. If they are equal, values below are red, values
+                   above are blue and the value itself is green.
+    colors  - [out] count colors.
+  */
+  template <class T>
+  void MapValues(const T* values, int count, const ON_Interval& redblue, ON_Color* colors) const;
+
+  /*
+  Description:
+    Recolors values after the range changes, changing only the colors
+    that differ. Because the values are visited in sorted order, the
+    values that keep their color, such as those clamped to either end
+    of both ranges, are skipped in runs found by binary search, so the
+    work is proportional to the number of colors that change.
+  Parameters:
+    values      - [in] analysis values, doubles or floats.
+    sorted      - [in] the indices of the values in increasing order,
+                       NaN values first.
+    count       - [in] number of values.
+    old_redblue - [in] the range the colors were mapped with.
+    new_redblue - [in] the new range.
+    colors      - [in/out] count colors, mapped from the values with
+                           this table and old_redblue.
+  Returns:
+    The number of colors that changed.
+  */
+  template <class T>
+  int RecolorValues(const T* values, const int* sorted, int count, const ON_Interval& old_redblue, const ON_Interval& new_redblue, ON_Color* colors) const;
+
+private:
+  friend class CAnalysisColorTableCache;
+  CAnalysisColorTable(const CAnalysisColorTable&) = delete;
+  CAnalysisColorTable& operator=(const CAnalysisColorTable&) = delete;
+
+  CAnalysisColorMap m_map;
+
+  // Number of meshes colored with the table. Meshes are copied and
+  // destroyed on any thread, so the count is interlocked.
+  mutable volatile long m_ref_count;
+
+  ON_Color m_colors[color_count];
+
+  // Neighboring colors that are the same have the same run number.
+  // Runs increase with the index.
+  int m_runs[color_count];
+};
@@ -5,14 +5,9 @@
 
 #include "stdafx.h"
 #include "AnalysisDialog.h"
+#include "AnalysisColorTable.h"
 #include "AnalysisUserData.h"
 
-#define CLAMP(V,L,H) ( (V) < (L) ? (L) : ( (V) > (H) ? (H) : (V) ) )
-#define LERP(A,L,H) ((L)+((H)-(L))*(A))
-#define EPS_DIVIDE	0.000001
-static double BAD_COLOR_HUE = 0.0;                 // red
-static double GOOD_COLOR_HUE = ON_PI * 4.0 / 3.0; // blue 
-
 /////////////////////////////////////////////////////////////////////////////
 
 IMPLEMENT_DYNAMIC(CAnalysisDialog, CRhinoDialog)
@@ -24,7 +19,7 @@ CAnalysisDialog::CAnalysisDialog(CRhinoDoc& doc, CWnd* pParent)
   SetAllowEscapeAndEnter(false);
 
   m_range1 = m_range2 = 0.0;
-  m_range1_timer_on = m_range2_timer_on = false;
+  m_range1_timer_on = m_range2_timer_on = m_bands_timer_on = false;
   m_updating = true;
 }
 
@@ -39,6 +34,8 @@ void CAnalysisDialog::DoDataExchange(CDataExchange* pDX)
   DDX_Control(pDX, IDC_RANGE1_EDIT, m_range1_edit);
   DDX_Control(pDX, IDC_RANGE2_EDIT, m_range2_edit);
   DDX_Control(pDX, IDC_MIDRANGE_STATIC, m_midrange_static);
+  DDX_Control(pDX, IDC_COLORMAP_COMBO, m_colormap_combo);
+  DDX_Control(pDX, IDC_BANDS_EDIT, m_bands_edit);
   m_range1_edit.DDX_Text(pDX, IDC_RANGE1_EDIT, m_range1);
   m_range2_edit.DDX_Text(pDX, IDC_RANGE2_EDIT, m_range2);
 }
@@ -48,6 +45,8 @@ BEGIN_MESSAGE_MAP(CAnalysisDialog, CRhinoDialog)
   ON_BN_CLICKED(IDC_AUTO_BUTTON, &CAnalysisDialog::OnBnClickedAutoButton)
   ON_EN_CHANGE(IDC_RANGE1_EDIT, &CAnalysisDialog::OnEnChangeRange1Edit)
   ON_EN_CHANGE(IDC_RANGE2_EDIT, &CAnalysisDialog::OnEnChangeRange2Edit)
+  ON_CBN_SELCHANGE(IDC_COLORMAP_COMBO, &CAnalysisDialog::OnCbnSelchangeColormapCombo)
+  ON_EN_CHANGE(IDC_BANDS_EDIT, &CAnalysisDialog::OnEnChangeBandsEdit)
   ON_WM_TIMER()
 END_MESSAGE_MAP()
 
@@ -64,6 +63,21 @@ BOOL CAnalysisDialog::OnInitDialog()
   s.Format(L"%.5g", 0.5 * (m_range1 + m_range2));
   m_midrange_static.SetWindowText(s);
 
+  // The items are in CAnalysisColorMap::map_type order
+  m_colormap_combo.AddString(RHSTR(L"Rainbow"));
+  m_colormap_combo.AddString(RHSTR(L"Viridis"));
+  m_colormap_combo.AddString(RHSTR(L"Turbo"));
+  m_colormap_combo.AddString(RHSTR(L"Cool to warm"));
+  if (CAnalysisColorMap::custom == m_color_map.m_type)
+  {
+    m_custom_map = m_color_map;
+    m_colormap_combo.AddString(RHSTR(L"Custom"));
+  }
+  m_colormap_combo.SetCurSel((int)m_color_map.m_type);
+
+  s.Format(L"%d", m_color_map.m_band_count);
+  m_bands_edit.SetWindowText(s);
+
   m_conduit.Enable();
   m_conduit.Attach(this);
   CRhinoDoc* doc = RhinoApp().ActiveDoc();
@@ -75,89 +89,6 @@ BOOL CAnalysisDialog::OnInitDialog()
   return TRUE;
 }
 
-static void HSVToRGB(double h, double s, double v, double& r, double& g, double& b)
-{
-  int i;
-  double f, p, q, t;
-
-  if (s < EPS_DIVIDE)
-  {
-    r = v;
-    g = v;
-    b = v;
-  }
-  else
-  {
-    h = h * 3.0 / ON_PI;  // (6.0 / 2.0 * ON_PI);
-    i = (int)floor(h);
-    if (i > 5 || i < 0)
-    {
-      i = 0;
-      h = 0.0;
-    }
-    f = h - i;
-    p = v * (1.0 - s);
-    q = v * (1.0 - (s * f));
-    t = v * (1.0 - (s * (1.0 - f)));
-
-    switch (i)
-    {
-    case 0:
-      r = v;
-      g = t;
-      b = p;
-      break;
-    case 1:
-      r = q;
-      g = v;
-      b = p;
-      break;
-    case 2:
-      r = p;
-      g = v;
-      b = t;
-      break;
-    case 3:
-      r = p;
-      g = q;
-      b = v;
-      break;
-    case 4:
-      r = t;
-      g = p;
-      b = v;
-      break;
-    case 5:
-      r = v;
-      g = p;
-      b = q;
-      break;
-    }
-  }
-}
-
-static void HSVToRGBInt(double h, double s, double v, int& r_out, int& g_out, int& b_out)
-{
-  double r, g, b;
-
-  s = CLAMP(s, 0.0, 1.0);
-  v = CLAMP(v, 0.0, 1.0);
-
-  HSVToRGB(h, s, v, r, g, b);
-
-  r = CLAMP(r, 0.0, 1.0);
-  g = CLAMP(g, 0.0, 1.0);
-  b = CLAMP(b, 0.0, 1.0);
-
-  r *= 255.0;
-  g *= 255.0;
-  b *= 255.0;
-
-  r_out = ON_Round(r);
-  g_out = ON_Round(g);
-  b_out = ON_Round(b);
-}
-
 void CAnalysisDialog::CreateHueBar()
 {
   CRect rect;
@@ -173,20 +104,20 @@ void CAnalysisDialog::CreateHueBar()
   char* baseptr = (char*)m_huebar_dib.FindDIBBits();
   int scan_width = m_huebar_dib.ScanWidth();
 
-  double start_angle = GOOD_COLOR_HUE;
-  double end_angle = BAD_COLOR_HUE;
+  // The DIB is bottom up, so the first row is the end of the map,
+  // next to the m_range2 edit box. The legend uses the same table
+  // as the meshes, so they always agree.
+  const CAnalysisColorTable& table = CAnalysisColorTable::Get(m_color_map);
 
   int i, j;
   for (i = 0; i < height; i++)
   {
-    double t = (double)i / (double)(height - 1);
-    double angle = LERP(t, start_angle, end_angle);
-
-    int ir, ig, ib;
-    HSVToRGBInt(angle, 1.0, 1.0, ir, ig, ib);
-    char r = (unsigned char)ir;
-    char g = (unsigned char)ig;
-    char b = (unsigned char)ib;
+    double t = (height > 1) ? (double)i / (double)(height - 1) : 0.0;
+    ON_Color color = table.Color(1.0 - t);
+
+    char r = (unsigned char)color.Red();
+    char g = (unsigned char)color.Green();
+    char b = (unsigned char)color.Blue();
     char* ptr = baseptr + (i * scan_width);
 
     for (j = 0; j < width; j++)
@@ -231,7 +162,7 @@ void CAnalysisDialog::OnBnClickedAutoButton()
 
 void CAnalysisDialog::UpdateRange(EditTimers timer_id)
 {
-  bool& timer_on = (timer_id == range1_timer ? m_range1_timer_on : m_range2_timer_on);
+  bool& timer_on = TimerOn(timer_id);
   KillTimer(timer_id);
   timer_on = false;
 
@@ -255,21 +186,91 @@ void CAnalysisDialog::UpdateRange(EditTimers timer_id)
         redblue[0] = m_range1;
         redblue[1] = m_range2;
         const_cast<CAnalysisUserData*>(ud)->m_redblue = redblue;
-        CAnalysisUserData::UpdateColors(mesh);
       }
     }
   }
 
+  // Recolor every mesh concurrently, then redraw once. The values
+  // are sorted the first time, so later edits only recolor the
+  // vertices whose colors change. Meshes with texture colors are not
+  // recolored at all, and if no mesh changed a redraw is enough.
+  const int changed_count = CAnalysisUserData::UpdateColors(m_meshes, true);
+
   CRhinoDoc* doc = RhinoApp().ActiveDoc();
   if (doc)
-    doc->Regen();
+  {
+    if (changed_count > 0)
+      doc->Regen();
+    else
+      doc->Redraw();
+  }
 
   m_updating = false;
 }
 
+void CAnalysisDialog::UpdateColorMap()
+{
+  KillTimer(bands_timer);
+  m_bands_timer_on = false;
+
+  CAnalysisColorMap color_map;
+  const int sel = m_colormap_combo.GetCurSel();
+  if (CAnalysisColorMap::custom == sel)
+    color_map = m_custom_map;
+  else if (sel >= 0)
+    color_map.m_type = (CAnalysisColorMap::map_type)sel;
+
+  CString s;
+  m_bands_edit.GetWindowText(s);
+  int band_count = _wtoi(s);
+  if (band_count < 0)
+    band_count = 0;
+  else if (band_count > CAnalysisColorMap::max_band_count)
+    band_count = CAnalysisColorMap::max_band_count;
+  color_map.m_band_count = band_count;
+
+  if (color_map == m_color_map)
+    return;
+
+  m_updating = true;
+
+  m_color_map = color_map;
+  for (int i = 0; i < m_meshes.Count(); i++)
+  {
+    CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(m_meshes[i]));
+    if (ud)
+      ud->m_color_map = color_map;
+  }
+
+  CreateHueBar();
+  m_huebar_button.Invalidate();
+
+  const int changed_count = CAnalysisUserData::UpdateColors(m_meshes, true);
+
+  CRhinoDoc* doc = RhinoApp().ActiveDoc();
+  if (doc)
+  {
+    if (changed_count > 0)
+      doc->Regen();
+    else
+      doc->Redraw();
+  }
+
+  m_updating = false;
+}
+
+bool& CAnalysisDialog::TimerOn(EditTimers timer_id)
+{
+  if (range1_timer == timer_id)
+    return m_range1_timer_on;
+  if (range2_timer == timer_id)
+    return m_range2_timer_on;
+  return m_bands_timer_on;
+}
+
 void CAnalysisDialog::OnEnChange(EditTimers timer_id)
 {
-  bool& on = (timer_id == range1_timer ? m_range1_timer_on : m_range2_timer_on);
+  bool& on = TimerOn(timer_id);
   if (on)
     KillTimer(timer_id);
 
@@ -277,6 +278,8 @@ void CAnalysisDialog::OnEnChange(EditTimers timer_id)
 
   if (SetTimer(timer_id, 650, 0))
     on = true;
+  else if (bands_timer == timer_id)
+    UpdateColorMap();
   else
     UpdateRange(timer_id);
 }
@@ -297,6 +300,22 @@ void CAnalysisDialog::OnEnChangeRange2Edit()
   OnEnChange(range2_timer);
 }
 
+void CAnalysisDialog::OnCbnSelchangeColormapCombo()
+{
+  if (m_updating)
+    return;
+
+  UpdateColorMap();
+}
+
+void CAnalysisDialog::OnEnChangeBandsEdit()
+{
+  if (m_updating)
+    return;
+
+  OnEnChange(bands_timer);
+}
+
 void CAnalysisDialog::OnTimer(UINT_PTR nIDEvent)
 {
   switch (nIDEvent)
@@ -305,12 +324,18 @@ void CAnalysisDialog::OnTimer(UINT_PTR nIDEvent)
   case range2_timer:
     UpdateRange((EditTimers)nIDEvent);
     return;
+  case bands_timer:
+    UpdateColorMap();
+    return;
   }
   CRhinoDialog::OnTimer(nIDEvent);
 }
 
 void CAnalysisDialog::OnOK()
 {
+  // Apply a band count that is still being typed
+  if (m_bands_timer_on)
+    UpdateColorMap();
   CRhinoDialog::OnOK();
 }
 
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "Resource.h"
+#include "AnalysisColorMap.h"
 #include "AnalysisDialogConduit.h"
 
 class CAnalysisDialog : public CRhinoDialog
@@ -22,11 +23,17 @@ public:
   CRhinoUiEdit m_range1_edit;
   CRhinoUiEdit m_range2_edit;
   CStatic m_midrange_static;
+  CComboBox m_colormap_combo;
+  CEdit m_bands_edit;
 
   CRhinoDib m_huebar_dib;
   double m_range1;
   double m_range2;
 
+  // The color map of the meshes. Changing the map in the dialog
+  // sets it on every mesh.
+  CAnalysisColorMap m_color_map;
+
   ON_Interval m_minmax;
   ON_SimpleArray<ON_UUID> m_objects;
   ON_SimpleArray<ON_Mesh*> m_meshes;
@@ -39,6 +46,8 @@ public:
   afx_msg void OnBnClickedAutoButton();
   afx_msg void OnEnChangeRange1Edit();
   afx_msg void OnEnChangeRange2Edit();
+  afx_msg void OnCbnSelchangeColormapCombo();
+  afx_msg void OnEnChangeBandsEdit();
   afx_msg void OnTimer(UINT_PTR nIDEvent);
 
 protected:
@@ -47,14 +56,22 @@ protected:
   {
     range1_timer = WM_USER,
     range2_timer,
+    bands_timer,
   };
 
+  bool& TimerOn(EditTimers timer_id);
   void OnEnChange(EditTimers timer_id);
   void UpdateRange(EditTimers timer_id);
+  void UpdateColorMap();
   void CreateHueBar();
 
+  // A custom map the meshes had when the dialog was opened, so it
+  // can be chosen again after trying the built in maps.
+  CAnalysisColorMap m_custom_map;
+
   bool m_range1_timer_on;
   bool m_range2_timer_on;
+  bool m_bands_timer_on;
   bool m_updating;
 
 protected:
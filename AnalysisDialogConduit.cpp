@@ -6,6 +6,7 @@
 #include "StdAfx.h"
 #include "AnalysisDialog.h"
 #include "AnalysisDialogConduit.h"
+#include "AnalysisUserData.h"
 
 CAnalysisDialogConduit::CAnalysisDialogConduit()
   : CRhinoDisplayConduit(CSupportChannels::SC_DRAWOBJECT | CSupportChannels::SC_PREDRAWOBJECTS, false),
@@ -36,10 +37,15 @@ bool CAnalysisDialogConduit::ExecConduit(CRhinoDisplayPipeline& dp, UINT nActive
       }
       else
       {
+        // Meshes with texture colors are drawn by the plug-in's
+        // CAnalysisMeshConduit
         for (int i = 0; i < m_dialog->m_meshes.Count(); i++)
         {
           ON_Mesh* mesh = m_dialog->m_meshes[i];
-          if (nullptr != mesh)
+          if (nullptr == mesh)
+            continue;
+          const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh);
+          if (nullptr == ud || !ud->HasTextureColors(mesh))
             dp.DrawShadedMesh(*mesh);
         }
       }
@@ -0,0 +1,94 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisMappedFile.cpp
+
+#include "stdafx.h"
+#include "AnalysisMappedFile.h"
+
+CAnalysisMappedFile::CAnalysisMappedFile()
+  : m_file(INVALID_HANDLE_VALUE)
+  , m_mapping(nullptr)
+  , m_data(nullptr)
+  , m_size(0)
+{
+}
+
+CAnalysisMappedFile::~CAnalysisMappedFile()
+{
+  Close();
+}
+
+bool CAnalysisMappedFile::Open(const wchar_t* filename)
+{
+  Close();
+
+  if (nullptr == filename || 0 == filename[0])
+    return false;
+
+  m_file = ::CreateFileW(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (INVALID_HANDLE_VALUE == m_file)
+    return false;
+
+  LARGE_INTEGER file_size;
+  if (!::GetFileSizeEx(m_file, &file_size) || file_size.QuadPart <= 0)
+  {
+    Close();
+    return false;
+  }
+
+  // CreateFileMapping fails on empty files, which is why they are rejected above
+  m_mapping = ::CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (nullptr == m_mapping)
+  {
+    Close();
+    return false;
+  }
+
+  m_data = static_cast<const char*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (nullptr == m_data)
+  {
+    Close();
+    return false;
+  }
+
+  m_size = static_cast<size_t>(file_size.QuadPart);
+
+  return true;
+}
+
+void CAnalysisMappedFile::Close()
+{
+  if (nullptr != m_data)
+    ::UnmapViewOfFile(m_data);
+  m_data = nullptr;
+  m_size = 0;
+
+  if (nullptr != m_mapping)
+    ::CloseHandle(m_mapping);
+  m_mapping = nullptr;
+
+  if (INVALID_HANDLE_VALUE != m_file)
+    ::CloseHandle(m_file);
+  m_file = INVALID_HANDLE_VALUE;
+}
+
+bool CAnalysisMappedFile::IsOpen() const
+{
+  return (nullptr != m_data);
+}
+
+const char* CAnalysisMappedFile::Begin() const
+{
+  return m_data;
+}
+
+const char* CAnalysisMappedFile::End() const
+{
+  return (nullptr != m_data) ? m_data + m_size : nullptr;
+}
+
+size_t CAnalysisMappedFile::Size() const
+{
+  return m_size;
+}
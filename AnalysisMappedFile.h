@@ -0,0 +1,53 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisMappedFile.h
+
+#pragma once
+
+// CAnalysisMappedFile
+// A read-only view of an entire file that is mapped into memory, so
+// readers can parse the file contents in place without buffered I/O.
+//
+
+class CAnalysisMappedFile
+{
+public:
+  CAnalysisMappedFile();
+  ~CAnalysisMappedFile();
+
+  /*
+  Description:
+    Maps a file into memory.
+  Parameters:
+    filename - [in] the name of the file to map.
+  Returns:
+    True if successful. False if the file could not be opened,
+    is empty, or could not be mapped.
+  */
+  bool Open(const wchar_t* filename);
+
+  /*
+  Description:
+    Unmaps the view and closes the file.
+  */
+  void Close();
+
+  bool IsOpen() const;
+
+  // The mapped bytes are in the range [Begin(), End()). The mapped
+  // view is not null terminated.
+  const char* Begin() const;
+  const char* End() const;
+  size_t Size() const;
+
+private:
+  CAnalysisMappedFile(const CAnalysisMappedFile&) = delete;
+  CAnalysisMappedFile& operator=(const CAnalysisMappedFile&) = delete;
+
+private:
+  HANDLE m_file;
+  HANDLE m_mapping;
+  const char* m_data;
+  size_t m_size;
+};
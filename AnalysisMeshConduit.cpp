@@ -0,0 +1,63 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisMeshConduit.cpp
+
+#include "StdAfx.h"
+#include "AnalysisMeshConduit.h"
+#include "AnalysisColorTable.h"
+#include "AnalysisTexture.h"
+#include "AnalysisUserData.h"
+
+CAnalysisMeshConduit::CAnalysisMeshConduit()
+  : CRhinoDisplayConduit(CSupportChannels::SC_DRAWOBJECT, false)
+{
+}
+
+bool CAnalysisMeshConduit::ExecConduit(CRhinoDisplayPipeline& dp, UINT nActiveChannel, bool& bTerminateChannel)
+{
+  if (nActiveChannel == CSupportChannels::SC_DRAWOBJECT && dp.DisplayAttrs()->m_bShadeSurface)
+  {
+    const CRhinoMeshObject* mesh_object = CRhinoMeshObject::Cast(m_pChannelAttrs->m_pObject);
+    const ON_Mesh* mesh = mesh_object ? mesh_object->Mesh() : nullptr;
+
+    CDisplayPipelineMaterial material;
+    if (SetupMaterial(mesh, material))
+    {
+      dp.DrawShadedMesh(*mesh, &material);
+      m_pChannelAttrs->m_bDrawObject = false;
+    }
+  }
+
+  return true;
+}
+
+bool CAnalysisMeshConduit::SetupMaterial(const ON_Mesh* mesh, CDisplayPipelineMaterial& material)
+{
+  const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh);
+  if (nullptr == ud || !ud->HasTextureColors(mesh))
+    return false;
+
+  ON_wString filename;
+  if (!CAnalysisTexture::GetBitmapFile(CAnalysisColorTable::Get(ud->m_color_map), filename))
+    return false;
+
+  // Nearest filtering keeps neighboring colors, such as bands, from
+  // blending, and clamping gives values outside of the range the
+  // colors at the ends of the map.
+  ON_Texture texture;
+  texture.m_image_file_reference = ON_FileReference::CreateFromFullPath(filename, false, false);
+  texture.m_type = ON_Texture::TYPE::bitmap_texture;
+  texture.m_mode = ON_Texture::MODE::decal_texture;
+  texture.m_minfilter = ON_Texture::FILTER::nearest_filter;
+  texture.m_magfilter = ON_Texture::FILTER::nearest_filter;
+  texture.m_wrapu = ON_Texture::WRAP::clamp_wrap;
+  texture.m_wrapv = ON_Texture::WRAP::clamp_wrap;
+  texture.m_uvw = CAnalysisTexture::TextureTransform(ud->m_texture_minmax, ud->m_redblue);
+
+  material.m_FrontMaterial.SetDiffuse(ON_Color(255, 255, 255));
+  material.m_FrontMaterial.m_textures.Append(texture);
+  material.m_BackMaterial = material.m_FrontMaterial;
+
+  return true;
+}
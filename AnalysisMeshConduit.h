@@ -0,0 +1,32 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisMeshConduit.h
+
+#pragma once
+
+// CAnalysisMeshConduit
+// Draws the shaded analysis meshes that have texture colors, see
+// CAnalysisUserData::SetTextureColors(), with a texture of their color
+// table. Other objects are drawn by Rhino.
+//
+
+class CAnalysisMeshConduit : public CRhinoDisplayConduit
+{
+public:
+  CAnalysisMeshConduit();
+  bool ExecConduit(CRhinoDisplayPipeline&, UINT, bool&) override;
+
+  /*
+  Description:
+    Sets up the material that draws a mesh with texture colors.
+  Parameters:
+    mesh     - [in] the mesh.
+    material - [out] a white material with the bitmap of the mesh's
+                     color table as a clamped, nearest filtered
+                     texture, transformed to the display range.
+  Returns:
+    True if the mesh has texture colors and the material was set up.
+  */
+  static bool SetupMaterial(const ON_Mesh* mesh, CDisplayPipelineMaterial& material);
+};
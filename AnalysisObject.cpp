@@ -13,6 +13,11 @@
 IMPLEMENT_DYNAMIC(CAnalysisObject, CCmdTarget)
 
 CAnalysisObject::CAnalysisObject()
+  : m_update_depth(0)
+  , m_bRegen(false)
+  , m_update_document_sn(0)
+  , m_command_depth(0)
+  , m_update_command_depth(0)
 {
   EnableAutomation();
 }
@@ -35,6 +40,18 @@ BEGIN_DISPATCH_MAP(CAnalysisObject, CCmdTarget)
   DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshData", dispidAnalysisMeshData, AnalysisMeshData, VT_VARIANT, VTS_VARIANT VTS_VARIANT)
   DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshDisplayRange", dispidAnalysisMeshDisplayRange, AnalysisMeshDisplayRange, VT_VARIANT, VTS_VARIANT VTS_VARIANT)
   DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshDataRange", dispidAnalysisMeshDataRange, AnalysisMeshDataRange, VT_VARIANT, VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshVariable", dispidAnalysisMeshVariable, AnalysisMeshVariable, VT_VARIANT, VTS_VARIANT VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshVariables", dispidAnalysisMeshVariables, AnalysisMeshVariables, VT_VARIANT, VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshFrame", dispidAnalysisMeshFrame, AnalysisMeshFrame, VT_VARIANT, VTS_VARIANT VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshFrameTimes", dispidAnalysisMeshFrameTimes, AnalysisMeshFrameTimes, VT_VARIANT, VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshColorMap", dispidAnalysisMeshColorMap, AnalysisMeshColorMap, VT_VARIANT, VTS_VARIANT VTS_VARIANT VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshTextureColors", dispidAnalysisMeshTextureColors, AnalysisMeshTextureColors, VT_VARIANT, VTS_VARIANT VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshTolerance", dispidAnalysisMeshTolerance, AnalysisMeshTolerance, VT_VARIANT, VTS_VARIANT VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "AddAnalysisMeshes", dispidAddAnalysisMeshes, AddAnalysisMeshes, VT_VARIANT, VTS_VARIANT VTS_VARIANT VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshesData", dispidAnalysisMeshesData, AnalysisMeshesData, VT_VARIANT, VTS_VARIANT VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "AnalysisMeshesDisplayRange", dispidAnalysisMeshesDisplayRange, AnalysisMeshesDisplayRange, VT_VARIANT, VTS_VARIANT VTS_VARIANT)
+  DISP_FUNCTION_ID(CAnalysisObject, "BeginUpdate", dispidBeginUpdate, BeginUpdate, VT_VARIANT, VTS_NONE)
+  DISP_FUNCTION_ID(CAnalysisObject, "EndUpdate", dispidEndUpdate, EndUpdate, VT_VARIANT, VTS_VARIANT)
 END_DISPATCH_MAP()
 
 // Note: we add support for IID_IAnalysisObject to support typesafe binding
@@ -72,87 +89,395 @@ VARIANT CAnalysisObject::IsAnalysisMesh(const VARIANT &vaObject)
   return vaResult;
 }
 
-VARIANT CAnalysisObject::AddAnalysisMesh(const VARIANT& vaVertices, const VARIANT& vaFaces, const VARIANT& vaData)
+// A one dimensional SAFEARRAY of doubles, floats or longs, locked so
+// its numbers are read in place. Arrays of variants, such as arrays of
+// points, are not number arrays and are read with ConvertVariant().
+class CNumberArray
 {
-  VARIANT vaResult;
-  VariantInit(&vaResult);
-  V_VT(&vaResult) = VT_NULL;
+public:
+  CNumberArray(const VARIANT& va)
+    : m_psa(nullptr)
+    , m_vt(VT_EMPTY)
+    , m_data(nullptr)
+    , m_count(0)
+  {
+    const VARIANT* pva = &va;
+    while (pva->vt == (VT_BYREF | VT_VARIANT))
+      pva = pva->pvarVal;
+    if (0 == (pva->vt & VT_ARRAY))
+      return;
 
-  CRhinoDoc* doc = CRhinoVariantHelpers::Document();
-  if (nullptr == doc)
-    return vaResult;
+    SAFEARRAY* psa = (pva->vt & VT_BYREF) ? *pva->pparray : pva->parray;
+    if (nullptr == psa || 1 != SafeArrayGetDim(psa) || (psa->fFeatures & FADF_VARIANT))
+      return;
 
-  ON_3fPointArray vertices;
-  if (!CRhinoVariantHelpers::ConvertVariant(vaVertices, vertices))
-    return vaResult;
+    VARTYPE vt = VT_EMPTY;
+    if (FAILED(SafeArrayGetVartype(psa, &vt)) || (VT_R8 != vt && VT_R4 != vt && VT_I4 != vt))
+      return;
 
-  ON_4fPointArray faces;
-  if (!CRhinoVariantHelpers::ConvertVariant(vaFaces, faces))
-    return vaResult;
+    long lower = 0, upper = -1;
+    if (FAILED(SafeArrayGetLBound(psa, 1, &lower)) || FAILED(SafeArrayGetUBound(psa, 1, &upper)) || upper < lower)
+      return;
 
-  ON_SimpleArray<double> data;
-  if (!CRhinoVariantHelpers::ConvertVariant(vaData, data) || data.Count() != vertices.Count())
-    return vaResult;
+    void* data = nullptr;
+    if (FAILED(SafeArrayAccessData(psa, &data)) || nullptr == data)
+      return;
+
+    m_psa = psa;
+    m_vt = vt;
+    m_data = data;
+    m_count = upper - lower + 1;
+  }
 
-  ON_Mesh* mesh = new ON_Mesh(faces.Count(), vertices.Count(), false, false);
+  ~CNumberArray()
+  {
+    if (m_psa)
+      SafeArrayUnaccessData(m_psa);
+  }
 
-  for (int i = 0; i < vertices.Count(); i++)
-    mesh->SetVertex(i, vertices[i]);
+  // True if the variant is a locked array of numbers
+  bool IsValid() const { return nullptr != m_data; }
 
-  for (int i = 0; i < faces.Count(); i++)
+  int Count() const { return m_count; }
+  VARTYPE Type() const { return m_vt; }
+
+  // Copies the numbers, converting them to the type of dst
+  template <class U>
+  void CopyTo(U* dst) const
   {
-    ON_4fPoint face = faces[i];
-    if (face.z == face.w)
-      mesh->SetTriangle(i, (int)face.x, (int)face.y, (int)face.z);
-    else
-      mesh->SetQuad(i, (int)face.x, (int)face.y, (int)face.z, (int)face.w);
+    if (VT_R8 == m_vt)
+      ConvertNumbers(static_cast<const double*>(m_data), m_count, dst);
+    else if (VT_R4 == m_vt)
+      ConvertNumbers(static_cast<const float*>(m_data), m_count, dst);
+    else if (VT_I4 == m_vt)
+      ConvertNumbers(static_cast<const long*>(m_data), m_count, dst);
   }
 
-  mesh->ComputeVertexNormals();
-  mesh->Compact();
+private:
+  CNumberArray(const CNumberArray&) = delete;
+  CNumberArray& operator=(const CNumberArray&) = delete;
 
-  if (mesh->IsValid())
+  template <class T, class U>
+  static void ConvertNumbers(const T* src, int count, U* dst)
   {
-    CAnalysisUserData* ud = new CAnalysisUserData();
-    if (ud)
-    {
-      ud->m_a = data;
-      double mn = data[0];
-      double mx = data[0];
-      for (int i = 1; i < data.Count(); i++)
-      {
-        double x = data[i];
-        if (x < mn)
-          mn = x;
-        else if (x > mx)
-          mx = x;
-      }
-      ud->m_minmax.Set(mn, mx);
-      ud->m_redblue.Set(mn, mx);
-      mesh->AttachUserData(ud);
-      CAnalysisUserData::UpdateColors(mesh);
+    for (int i = 0; i < count; i++)
+      dst[i] = (U)src[i];
+  }
 
-      CRhinoMeshObject* mesh_object = new CRhinoMeshObject();
-      if (mesh_object)
+  template <class T>
+  static void ConvertNumbers(const T* src, int count, T* dst)
+  {
+    memcpy(dst, src, sizeof(T) * count);
+  }
+
+  SAFEARRAY* m_psa;
+  VARTYPE m_vt;
+  void* m_data;
+  int m_count;
+};
+
+// A one dimensional SAFEARRAY of variants, locked so its elements are
+// read in place.
+class CVariantArray
+{
+public:
+  CVariantArray(const VARIANT& va)
+    : m_psa(nullptr)
+    , m_data(nullptr)
+    , m_count(0)
+  {
+    const VARIANT* pva = &va;
+    while (pva->vt == (VT_BYREF | VT_VARIANT))
+      pva = pva->pvarVal;
+    if (0 == (pva->vt & VT_ARRAY))
+      return;
+
+    SAFEARRAY* psa = (pva->vt & VT_BYREF) ? *pva->pparray : pva->parray;
+    if (nullptr == psa || 1 != SafeArrayGetDim(psa) || 0 == (psa->fFeatures & FADF_VARIANT))
+      return;
+
+    long lower = 0, upper = -1;
+    if (FAILED(SafeArrayGetLBound(psa, 1, &lower)) || FAILED(SafeArrayGetUBound(psa, 1, &upper)) || upper < lower)
+      return;
+
+    VARIANT* data = nullptr;
+    if (FAILED(SafeArrayAccessData(psa, (void HUGEP**)&data)) || nullptr == data)
+      return;
+
+    m_psa = psa;
+    m_data = data;
+    m_count = upper - lower + 1;
+  }
+
+  ~CVariantArray()
+  {
+    if (m_psa)
+      SafeArrayUnaccessData(m_psa);
+  }
+
+  int Count() const { return m_count; }
+  const VARIANT& operator[](int i) const { return m_data[i]; }
+
+private:
+  CVariantArray(const CVariantArray&) = delete;
+  CVariantArray& operator=(const CVariantArray&) = delete;
+
+  SAFEARRAY* m_psa;
+  const VARIANT* m_data;
+  int m_count;
+};
+
+/*
+Description:
+  Converts faces that are not a flat array of numbers: an array of
+  faces, each an array of three or four vertex indices, or an array of
+  variants with four indices for each face. Indices are converted to
+  integers, so they are exact for any number of vertices.
+Parameters:
+  bQuiet - [in] if true, faces that cannot be converted do not throw
+                a dispatch exception.
+Returns:
+  The number of faces, or 0 if a face is not valid.
+*/
+static int ConvertFaces(const VARIANT& va, ON_SimpleArray<ON_MeshFace>& faces, bool bQuiet)
+{
+  faces.Empty();
+
+  if (va.vt == VT_ERROR && va.scode == DISP_E_PARAMNOTFOUND)
+    return 0;
+
+  const VARIANT* pva = &va;
+  while (pva->vt == (VT_BYREF | VT_VARIANT))
+    pva = pva->pvarVal;
+
+  SAFEARRAY* psa = nullptr;
+  if (pva->vt & VT_ARRAY)
+    psa = (pva->vt & VT_BYREF) ? *pva->pparray : pva->parray;
+
+  long lower = 0, upper = -1;
+  VARIANT* pvData = nullptr;
+  if (nullptr == psa)
+  {
+    if (false == bQuiet)
+      CRhinoVariantHelpers::ThrowOleDispatchException(CRhinoVariantHelpers::err_array_required);
+    return 0;
+  }
+  if (1 != SafeArrayGetDim(psa))
+  {
+    if (false == bQuiet)
+      CRhinoVariantHelpers::ThrowOleDispatchException(CRhinoVariantHelpers::err_array_one_dim_required);
+    return 0;
+  }
+  if (0 == (psa->fFeatures & FADF_VARIANT)
+    || FAILED(SafeArrayGetLBound(psa, 1, &lower)) || FAILED(SafeArrayGetUBound(psa, 1, &upper)) || upper < lower
+    || FAILED(SafeArrayAccessData(psa, (void HUGEP**)&pvData)) || nullptr == pvData)
+  {
+    if (false == bQuiet)
+      CRhinoVariantHelpers::ThrowOleDispatchException(CRhinoVariantHelpers::err_integer_array_required);
+    return 0;
+  }
+
+  // The conversions are quiet, so the array is never left locked
+  const int count = upper - lower + 1;
+  if (CRhinoVariantHelpers::IsVariantNumber(pvData[0]))
+  {
+    if (0 == count % 4)
+    {
+      faces.SetCapacity(count / 4);
+      faces.SetCount(count / 4);
+      int* indices = faces.Array()->vi;
+      for (int i = 0; i < count; i++)
       {
-        mesh_object->SetMesh(mesh);
-        if (doc->AddObject(mesh_object))
+        if (!CRhinoVariantHelpers::ConvertVariant(pvData[i], indices[i], true))
         {
-          CString str = CRhinoVariantHelpers::StringFromUuid(mesh_object->ModelObjectId());
-          V_VT(&vaResult) = VT_BSTR;
-          vaResult.bstrVal = str.AllocSysString();
-          doc->Regen();
+          faces.Empty();
+          break;
         }
-        else
-          delete mesh_object;
       }
-      else
-        delete mesh;
+    }
+  }
+  else
+  {
+    faces.SetCapacity(count);
+    ON_SimpleArray<int> vi(4);
+    for (int i = 0; i < count; i++)
+    {
+      const int n = CRhinoVariantHelpers::ConvertVariant(pvData[i], vi, true);
+      if (3 != n && 4 != n)
+      {
+        faces.Empty();
+        break;
+      }
+
+      // A triangle's fourth index is the same as its third
+      ON_MeshFace& face = faces.AppendNew();
+      face.vi[0] = vi[0];
+      face.vi[1] = vi[1];
+      face.vi[2] = vi[2];
+      face.vi[3] = vi[n - 1];
+    }
+  }
+
+  SafeArrayUnaccessData(psa);
+
+  // Thrown once the array is unlocked
+  if (0 == faces.Count() && false == bQuiet)
+    CRhinoVariantHelpers::ThrowOleDispatchException(CRhinoVariantHelpers::err_integer_array_required);
+
+  return faces.Count();
+}
+
+/*
+Description:
+  Checks mesh face indices. The loop has no branches, so the compiler
+  vectorizes it.
+Parameters:
+  indices      - [in] the vertex indices.
+  count        - [in] number of indices.
+  vertex_count - [in] number of mesh vertices.
+Returns:
+  True if every index is a vertex index.
+*/
+static bool ValidVertexIndices(const int* indices, size_t count, int vertex_count)
+{
+  // Negative indices are large unsigned numbers
+  const unsigned int limit = (unsigned int)vertex_count;
+  unsigned int bad = 0;
+  for (size_t i = 0; i < count; i++)
+    bad |= ((unsigned int)indices[i] >= limit) ? 1 : 0;
+  return 0 == bad;
+}
+
+// Flat arrays of numbers are copied straight into the mesh. Other
+// arrays are converted with ConvertVariant() and ConvertFaces() first.
+// Every index is checked before the mesh is used.
+ON_Mesh* CAnalysisObject::CreateAnalysisMesh(const VARIANT& vaVertices, const VARIANT& vaFaces, const VARIANT& vaData, bool bQuiet)
+{
+  const CNumberArray vertex_numbers(vaVertices);
+  const CNumberArray face_numbers(vaFaces);
+  const CNumberArray data_numbers(vaData);
+
+  ON_3fPointArray vertices;
+  int vertex_count = 0;
+  if (vertex_numbers.IsValid())
+    vertex_count = (0 == vertex_numbers.Count() % 3) ? vertex_numbers.Count() / 3 : 0;
+  else
+    vertex_count = CRhinoVariantHelpers::ConvertVariant(vaVertices, vertices, bQuiet);
+  if (0 == vertex_count)
+    return nullptr;
+
+  ON_SimpleArray<ON_MeshFace> faces;
+  int face_count = 0;
+  if (face_numbers.IsValid())
+    face_count = (0 == face_numbers.Count() % 4) ? face_numbers.Count() / 4 : 0;
+  else
+    face_count = ConvertFaces(vaFaces, faces, bQuiet);
+  if (0 == face_count)
+    return nullptr;
+
+  ON_SimpleArray<double> data;
+  int data_count = 0;
+  if (data_numbers.IsValid())
+    data_count = data_numbers.Count();
+  else
+    data_count = CRhinoVariantHelpers::ConvertVariant(vaData, data, bQuiet);
+  if (data_count != vertex_count)
+    return nullptr;
+
+  ON_Mesh* mesh = new ON_Mesh(face_count, vertex_count, false, false);
+
+  if (vertex_numbers.IsValid())
+  {
+    mesh->m_V.SetCount(vertex_count);
+    vertex_numbers.CopyTo(&mesh->m_V.Array()->x);
+  }
+  else
+  {
+    for (int i = 0; i < vertex_count; i++)
+      mesh->SetVertex(i, vertices[i]);
+  }
+
+  // A triangle's fourth index is the same as its third, as in ON_MeshFace
+  if (face_numbers.IsValid())
+  {
+    mesh->m_F.SetCount(face_count);
+    face_numbers.CopyTo(mesh->m_F.Array()->vi);
+  }
+  else
+  {
+    mesh->m_F = faces;
+  }
+
+  // Normals are computed from the faces, so bad indices are caught first
+  if (!ValidVertexIndices(mesh->m_F.Array()->vi, 4 * (size_t)face_count, vertex_count))
+  {
+    delete mesh;
+    return nullptr;
+  }
+
+  mesh->ComputeVertexNormals();
+  mesh->Compact();
+
+  if (!mesh->IsValid())
+  {
+    delete mesh;
+    return nullptr;
+  }
+
+  CAnalysisUserData* ud = new CAnalysisUserData();
+  if (data_numbers.IsValid())
+  {
+    // Single precision values stay single precision
+    if (VT_R4 == data_numbers.Type())
+    {
+      ud->m_a.SetPrecision(CAnalysisValues::single_precision);
+      ud->m_a.SetCount(data_count);
+      data_numbers.CopyTo(ud->m_a.FloatArray());
     }
     else
-      delete mesh;
+    {
+      ud->m_a.SetCount(data_count);
+      data_numbers.CopyTo(ud->m_a.DoubleArray());
+    }
+  }
+  else
+  {
+    ud->m_a.SetValues(data.Array(), data.Count());
   }
 
+  ud->ComputeRange(true);
+  mesh->AttachUserData(ud);
+  CAnalysisUserData::UpdateColors(mesh);
+
+  return mesh;
+}
+
+VARIANT CAnalysisObject::AddAnalysisMesh(const VARIANT& vaVertices, const VARIANT& vaFaces, const VARIANT& vaData)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  CRhinoDoc* doc = CRhinoVariantHelpers::Document();
+  if (nullptr == doc)
+    return vaResult;
+
+  ON_Mesh* mesh = CreateAnalysisMesh(vaVertices, vaFaces, vaData);
+  if (nullptr == mesh)
+    return vaResult;
+
+  CRhinoMeshObject* mesh_object = new CRhinoMeshObject();
+  mesh_object->SetMesh(mesh);
+  if (doc->AddObject(mesh_object))
+  {
+    CString str = CRhinoVariantHelpers::StringFromUuid(mesh_object->ModelObjectId());
+    V_VT(&vaResult) = VT_BSTR;
+    vaResult.bstrVal = str.AllocSysString();
+    Regen();
+  }
+  else
+    delete mesh_object;
+
   return vaResult;
 }
 
@@ -173,7 +498,7 @@ VARIANT CAnalysisObject::AnalysisMeshData(const VARIANT& vaObject, const VARIANT
   ON_SimpleArray<double> old_data;
   CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
   if (nullptr != ud)
-    old_data = ud->m_a;
+    ud->m_a.GetValues(old_data);
 
   ON_SimpleArray<double> new_data;
   if (CRhinoVariantHelpers::ConvertVariant(vaData, new_data) && new_data.Count() == mesh->VertexCount())
@@ -187,26 +512,13 @@ VARIANT CAnalysisObject::AnalysisMeshData(const VARIANT& vaObject, const VARIANT
 
     if (ud)
     {
-      ud->m_a = new_data;
-      double mn = new_data[0];
-      double mx = new_data[0];
-      for (int i = 1; i < new_data.Count(); i++)
-      {
-        double x = new_data[i];
-        if (x < mn)
-          mn = x;
-        else if (x > mx)
-          mx = x;
-      }
-      ud->m_minmax.Set(mn, mx);
-      ud->m_redblue.Set(mn, mx);
+      ud->m_a.SetValues(new_data.Array(), new_data.Count());
+      ud->ComputeRange(true);
 
       if (bAttach)
         mesh->AttachUserData(ud);
 
-      CAnalysisUserData::UpdateColors(mesh);
-
-      CRhinoVariantHelpers::RegenDocument();
+      MeshChanged(mesh, object_ref.ObjectUuid());
     }
   }
 
@@ -244,8 +556,7 @@ VARIANT CAnalysisObject::AnalysisMeshDisplayRange(const VARIANT& vaObject, const
   if (CRhinoVariantHelpers::ConvertVariant(vaRange, new_range) && new_range != old_range)
   {
     ud->m_redblue.Set(new_range.x, new_range.y);
-    CAnalysisUserData::UpdateColors(mesh);
-    CRhinoVariantHelpers::RegenDocument();
+    MeshChanged(mesh, object_ref.ObjectUuid());
   }
 
   COleSafeArray sa;
@@ -279,3 +590,662 @@ VARIANT CAnalysisObject::AnalysisMeshDataRange(const VARIANT& vaObject)
 
   return sa.Detach();
 }
+
+VARIANT CAnalysisObject::AnalysisMeshVariable(const VARIANT& vaObject, const VARIANT& vaVariable)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  CRhinoObjRef object_ref;
+  if (!CRhinoVariantHelpers::ConvertVariant(vaObject, object_ref))
+    return vaResult;
+
+  ON_Mesh* mesh = const_cast<ON_Mesh*>(object_ref.Mesh());
+  if (nullptr == mesh)
+    return vaResult;
+
+  CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
+  if (nullptr == ud || 0 == ud->ChannelCount())
+    return vaResult;
+
+  CString old_name(ud->ChannelName(ud->m_active_channel));
+
+  ON_wString new_name;
+  if (CRhinoVariantHelpers::ConvertVariant(vaVariable, new_name, true))
+  {
+    const int channel = ud->FindChannel(new_name);
+    if (channel < 0)
+      return vaResult;
+
+    if (channel != ud->m_active_channel && ud->SetActiveChannel(channel))
+      MeshChanged(mesh, object_ref.ObjectUuid());
+  }
+
+  V_VT(&vaResult) = VT_BSTR;
+  vaResult.bstrVal = old_name.AllocSysString();
+
+  return vaResult;
+}
+
+VARIANT CAnalysisObject::AnalysisMeshVariables(const VARIANT& vaObject)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  CRhinoObjRef object_ref;
+  if (!CRhinoVariantHelpers::ConvertVariant(vaObject, object_ref))
+    return vaResult;
+
+  const ON_Mesh* mesh = object_ref.Mesh();
+  if (nullptr == mesh)
+    return vaResult;
+
+  const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh);
+  if (nullptr == ud || 0 == ud->ChannelCount())
+    return vaResult;
+
+  COleSafeArray sa;
+  if (CRhinoVariantHelpers::CreateSafeArray(ud->m_channel_names, sa))
+    return sa.Detach();
+
+  return vaResult;
+}
+
+VARIANT CAnalysisObject::AnalysisMeshFrame(const VARIANT& vaObject, const VARIANT& vaFrame)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  CRhinoObjRef object_ref;
+  if (!CRhinoVariantHelpers::ConvertVariant(vaObject, object_ref))
+    return vaResult;
+
+  ON_Mesh* mesh = const_cast<ON_Mesh*>(object_ref.Mesh());
+  if (nullptr == mesh)
+    return vaResult;
+
+  CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
+  if (nullptr == ud || 0 == ud->m_frames.FrameCount())
+    return vaResult;
+
+  const int old_frame = ud->m_frames.m_current_frame;
+
+  int new_frame = 0;
+  if (CRhinoVariantHelpers::ConvertVariant(vaFrame, new_frame, true))
+  {
+    if (new_frame < 0 || new_frame >= ud->m_frames.FrameCount())
+      return vaResult;
+
+    if (new_frame != old_frame)
+    {
+      if (!ud->SetFrame(new_frame))
+        return vaResult;
+      MeshChanged(mesh, object_ref.ObjectUuid());
+    }
+  }
+
+  V_VT(&vaResult) = VT_I4;
+  vaResult.lVal = old_frame;
+
+  return vaResult;
+}
+
+VARIANT CAnalysisObject::AnalysisMeshFrameTimes(const VARIANT& vaObject)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  CRhinoObjRef object_ref;
+  if (!CRhinoVariantHelpers::ConvertVariant(vaObject, object_ref))
+    return vaResult;
+
+  const ON_Mesh* mesh = object_ref.Mesh();
+  if (nullptr == mesh)
+    return vaResult;
+
+  const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh);
+  if (nullptr == ud || 0 == ud->m_frames.FrameCount())
+    return vaResult;
+
+  COleSafeArray sa;
+  if (CRhinoVariantHelpers::CreateSafeArray(ud->m_frames.m_times, sa))
+    return sa.Detach();
+
+  return vaResult;
+}
+
+VARIANT CAnalysisObject::AnalysisMeshColorMap(const VARIANT& vaObject, const VARIANT& vaColorMap, const VARIANT& vaBands)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  CRhinoObjRef object_ref;
+  if (!CRhinoVariantHelpers::ConvertVariant(vaObject, object_ref))
+    return vaResult;
+
+  ON_Mesh* mesh = const_cast<ON_Mesh*>(object_ref.Mesh());
+  if (nullptr == mesh)
+    return vaResult;
+
+  CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
+  if (nullptr == ud)
+    return vaResult;
+
+  CString old_name(CAnalysisColorMap::TypeName(ud->m_color_map.m_type));
+
+  // The map is either the name of a built in map or an array of
+  // RGB colors, which makes a custom map.
+  CAnalysisColorMap new_map = ud->m_color_map;
+  ON_wString name;
+  ON_SimpleArray<double> values;
+  if (CRhinoVariantHelpers::ConvertVariant(vaColorMap, name, true))
+  {
+    const int type = CAnalysisColorMap::FindType(name);
+    if (type < 0 || CAnalysisColorMap::custom == type)
+      return vaResult;
+    new_map.m_type = (CAnalysisColorMap::map_type)type;
+    new_map.m_colors.Destroy();
+  }
+  else if (CRhinoVariantHelpers::ConvertVariant(vaColorMap, values))
+  {
+    ON_SimpleArray<ON_Color> colors(values.Count());
+    for (int i = 0; i < values.Count(); i++)
+      colors.Append(ON_Color((unsigned int)values[i] & 0xFFFFFF));
+    if (!new_map.SetCustomColors(colors.Array(), colors.Count()))
+      return vaResult;
+  }
+
+  int band_count = 0;
+  if (CRhinoVariantHelpers::ConvertVariant(vaBands, band_count, true))
+  {
+    if (band_count < 0 || band_count > CAnalysisColorMap::max_band_count)
+      return vaResult;
+    new_map.m_band_count = band_count;
+  }
+
+  if (new_map != ud->m_color_map)
+  {
+    ud->m_color_map = new_map;
+    MeshChanged(mesh, object_ref.ObjectUuid());
+  }
+
+  V_VT(&vaResult) = VT_BSTR;
+  vaResult.bstrVal = old_name.AllocSysString();
+
+  return vaResult;
+}
+
+VARIANT CAnalysisObject::AnalysisMeshTextureColors(const VARIANT& vaObject, const VARIANT& vaEnable)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  CRhinoObjRef object_ref;
+  if (!CRhinoVariantHelpers::ConvertVariant(vaObject, object_ref))
+    return vaResult;
+
+  ON_Mesh* mesh = const_cast<ON_Mesh*>(object_ref.Mesh());
+  if (nullptr == mesh)
+    return vaResult;
+
+  const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh);
+  if (nullptr == ud)
+    return vaResult;
+
+  const bool bOldTextureColors = ud->m_bTextureColors;
+
+  bool bTextureColors = false;
+  if (CRhinoVariantHelpers::ConvertVariant(vaEnable, bTextureColors, true) && bTextureColors != bOldTextureColors)
+  {
+    if (!CAnalysisUserData::SetTextureColors(mesh, bTextureColors))
+      return vaResult;
+    Regen();
+  }
+
+  V_VT(&vaResult) = VT_BOOL;
+  vaResult.boolVal = bOldTextureColors ? VARIANT_TRUE : VARIANT_FALSE;
+
+  return vaResult;
+}
+
+VARIANT CAnalysisObject::AnalysisMeshTolerance(const VARIANT& vaObject, const VARIANT& vaTolerance)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  CRhinoObjRef object_ref;
+  if (!CRhinoVariantHelpers::ConvertVariant(vaObject, object_ref))
+    return vaResult;
+
+  const ON_Mesh* mesh = object_ref.Mesh();
+  if (nullptr == mesh)
+    return vaResult;
+
+  CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
+  if (nullptr == ud)
+    return vaResult;
+
+  const double old_tolerance = ud->m_tolerance;
+
+  // The tolerance is applied when the mesh is saved
+  double tolerance = 0.0;
+  if (CRhinoVariantHelpers::ConvertVariant(vaTolerance, tolerance, true))
+  {
+    if (!ON_IsValid(tolerance) || tolerance < 0.0)
+      return vaResult;
+    ud->m_tolerance = tolerance;
+  }
+
+  V_VT(&vaResult) = VT_R8;
+  vaResult.dblVal = old_tolerance;
+
+  return vaResult;
+}
+
+VARIANT CAnalysisObject::AddAnalysisMeshes(const VARIANT& vaVertices, const VARIANT& vaFaces, const VARIANT& vaData)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  CRhinoDoc* doc = CRhinoVariantHelpers::Document();
+  if (nullptr == doc)
+    return vaResult;
+
+  // One array of vertices, faces and values for each mesh, as
+  // AddAnalysisMesh() takes them
+  const CVariantArray vertices(vaVertices);
+  const CVariantArray faces(vaFaces);
+  const CVariantArray data(vaData);
+  const int count = vertices.Count();
+  if (0 == count || count != faces.Count() || count != data.Count())
+    return vaResult;
+
+  // The meshes are built in parallel. The conversions are quiet, so no
+  // task throws, and a mesh that cannot be built is skipped.
+  ON_SimpleArray<ON_Mesh*> meshes(count);
+  meshes.SetCount(count);
+  concurrency::parallel_for(0, count, [&](int i)
+  {
+    meshes[i] = CreateAnalysisMesh(vertices[i], faces[i], data[i], true);
+  });
+
+  // All of the meshes are added as one undoable step, and the views
+  // are redrawn once. Meshes that were skipped have no id.
+  ON_ClassArray<ON_wString> ids(count);
+  const unsigned int undo_record_sn = doc->BeginUndoRecord(RHSTR(L"Add analysis meshes"));
+  for (int i = 0; i < count; i++)
+  {
+    ON_wString& id = ids.AppendNew();
+    if (nullptr == meshes[i])
+      continue;
+
+    CRhinoMeshObject* mesh_object = new CRhinoMeshObject();
+    mesh_object->SetMesh(meshes[i]);
+    if (doc->AddObject(mesh_object))
+      CRhinoVariantHelpers::StringFromUuid(mesh_object->ModelObjectId(), id);
+    else
+      delete mesh_object;
+  }
+  if (undo_record_sn)
+    doc->EndUndoRecord(undo_record_sn);
+  Regen();
+
+  // Meshes that were skipped come back as Null
+  COleSafeArray sa;
+  if (CRhinoVariantHelpers::CreateSafeArray(ids, sa, false))
+    return sa.Detach();
+
+  return vaResult;
+}
+
+/*
+Description:
+  Finds the meshes of an array of object ids. The document is looked
+  up once, and each id is converted straight to a uuid.
+Parameters:
+  vaObjects - [in] an array of object ids.
+  meshes    - [out] one mesh for each id, or nullptr if the id is not
+                    a mesh. If an id is in the array more than once,
+                    only its last position has the mesh, so no mesh
+                    is changed twice.
+  uuids     - [out] the ids, converted to uuids.
+Returns:
+  The number of ids.
+*/
+static int MeshesFromIds(const VARIANT& vaObjects, ON_SimpleArray<ON_Mesh*>& meshes, ON_SimpleArray<ON_UUID>& uuids)
+{
+  meshes.Empty();
+  uuids.Empty();
+
+  CRhinoDoc* doc = CRhinoVariantHelpers::Document();
+  const CVariantArray ids(vaObjects);
+  const int count = ids.Count();
+  if (nullptr == doc || 0 == count)
+    return 0;
+
+  meshes.SetCapacity(count);
+  uuids.SetCapacity(count);
+  for (int i = 0; i < count; i++)
+  {
+    ON_Mesh* mesh = nullptr;
+    ON_UUID uuid = ON_nil_uuid;
+    if (CRhinoVariantHelpers::ConvertVariant(ids[i], uuid, true))
+    {
+      const CRhinoMeshObject* mesh_object = CRhinoMeshObject::Cast(CRhinoObject::FromId(doc->RuntimeSerialNumber(), uuid));
+      if (mesh_object)
+        mesh = const_cast<ON_Mesh*>(mesh_object->Mesh());
+    }
+    meshes.Append(mesh);
+    uuids.Append(uuid);
+  }
+
+  ON_SimpleArray<int> order(count);
+  order.SetCount(count);
+  for (int i = 0; i < count; i++)
+    order[i] = i;
+  concurrency::parallel_sort(order.Array(), order.Array() + count, [&meshes](int i, int j)
+  {
+    return (meshes[i] == meshes[j]) ? i < j : meshes[i] < meshes[j];
+  });
+  for (int i = 0; i + 1 < count; i++)
+  {
+    if (meshes[order[i]] == meshes[order[i + 1]])
+      meshes[order[i]] = nullptr;
+  }
+
+  return count;
+}
+
+/*
+Description:
+  Sets the analysis values of a mesh from a script array, keeping the
+  precision they are stored in, and computes their range.
+Parameters:
+  mesh   - [in] the mesh.
+  vaData - [in] one value for each mesh vertex.
+  new_ud - [out] if the mesh has no analysis data, new data that the
+                 caller attaches.
+Returns:
+  True if successful.
+*/
+static bool SetMeshValues(ON_Mesh* mesh, const VARIANT& vaData, CAnalysisUserData*& new_ud)
+{
+  new_ud = nullptr;
+  if (nullptr == mesh)
+    return false;
+
+  const int vertex_count = mesh->VertexCount();
+  const CNumberArray numbers(vaData);
+  ON_SimpleArray<double> values;
+  if (numbers.IsValid() ? numbers.Count() != vertex_count : CRhinoVariantHelpers::ConvertVariant(vaData, values, true) != vertex_count)
+    return false;
+
+  CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
+  if (nullptr == ud)
+    ud = new_ud = new CAnalysisUserData();
+
+  if (numbers.IsValid())
+  {
+    ud->m_a.Destroy();
+    ud->m_a.SetCount(vertex_count);
+    if (ud->m_a.FloatArray())
+      numbers.CopyTo(ud->m_a.FloatArray());
+    else
+      numbers.CopyTo(ud->m_a.DoubleArray());
+  }
+  else
+  {
+    ud->m_a.SetValues(values.Array(), values.Count());
+  }
+
+  ud->ComputeRange(true);
+  return true;
+}
+
+VARIANT CAnalysisObject::AnalysisMeshesData(const VARIANT& vaObjects, const VARIANT& vaData)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  ON_SimpleArray<ON_Mesh*> meshes;
+  ON_SimpleArray<ON_UUID> uuids;
+  const int count = MeshesFromIds(vaObjects, meshes, uuids);
+  const CVariantArray data(vaData);
+  if (0 == count || count != data.Count())
+    return vaResult;
+
+  // The values of the meshes are set in parallel. Meshes whose values
+  // are not valid are skipped.
+  ON_SimpleArray<CAnalysisUserData*> new_uds(count);
+  new_uds.SetCount(count);
+  concurrency::parallel_for(0, count, [&](int i)
+  {
+    if (!SetMeshValues(meshes[i], data[i], new_uds[i]))
+      meshes[i] = nullptr;
+  });
+
+  ON_SimpleArray<ON_Mesh*> updated(count);
+  ON_SimpleArray<ON_UUID> updated_ids(count);
+  for (int i = 0; i < count; i++)
+  {
+    if (new_uds[i])
+      meshes[i]->AttachUserData(new_uds[i]);
+    if (meshes[i])
+    {
+      updated.Append(meshes[i]);
+      updated_ids.Append(uuids[i]);
+    }
+  }
+
+  MeshesChanged(updated, updated_ids);
+
+  V_VT(&vaResult) = VT_I4;
+  vaResult.lVal = updated.Count();
+
+  return vaResult;
+}
+
+VARIANT CAnalysisObject::AnalysisMeshesDisplayRange(const VARIANT& vaObjects, const VARIANT& vaRange)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  ON_SimpleArray<ON_Mesh*> meshes;
+  ON_SimpleArray<ON_UUID> uuids;
+  const int count = MeshesFromIds(vaObjects, meshes, uuids);
+  if (0 == count)
+    return vaResult;
+
+  // One range for every mesh, or an array of ranges, one for each mesh
+  ON_2dPoint range(0.0, 0.0);
+  const bool bOneRange = CRhinoVariantHelpers::ConvertVariant(vaRange, range, true);
+  const CVariantArray ranges(vaRange);
+  if (!bOneRange && count != ranges.Count())
+    return vaResult;
+
+  ON_SimpleArray<ON_Mesh*> updated(count);
+  ON_SimpleArray<ON_UUID> updated_ids(count);
+  for (int i = 0; i < count; i++)
+  {
+    CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(meshes[i]));
+    if (nullptr == ud)
+      continue;
+
+    ON_2dPoint new_range = range;
+    if (!bOneRange && !CRhinoVariantHelpers::ConvertVariant(ranges[i], new_range, true))
+      continue;
+
+    if (new_range != ON_2dPoint(ud->m_redblue[0], ud->m_redblue[1]))
+    {
+      ud->m_redblue.Set(new_range.x, new_range.y);
+      updated.Append(meshes[i]);
+      updated_ids.Append(uuids[i]);
+    }
+  }
+
+  MeshesChanged(updated, updated_ids);
+
+  V_VT(&vaResult) = VT_I4;
+  vaResult.lVal = updated.Count();
+
+  return vaResult;
+}
+
+void CAnalysisObject::MeshChanged(ON_Mesh* mesh, const ON_UUID& object_id)
+{
+  if (IsUpdating())
+  {
+    m_changed_ids.AddUuid(object_id, true);
+    return;
+  }
+
+  CAnalysisUserData::UpdateColors(mesh);
+  CRhinoVariantHelpers::RegenDocument();
+}
+
+void CAnalysisObject::MeshesChanged(const ON_SimpleArray<ON_Mesh*>& meshes, const ON_SimpleArray<ON_UUID>& object_ids)
+{
+  if (IsUpdating())
+  {
+    for (int i = 0; i < object_ids.Count(); i++)
+      m_changed_ids.AddUuid(object_ids[i], true);
+    return;
+  }
+
+  // Every mesh is recolored concurrently, then the views are redrawn once
+  const int changed_count = CAnalysisUserData::UpdateColors(meshes);
+  if (changed_count > 0)
+    CRhinoVariantHelpers::RegenDocument();
+  else if (meshes.Count() > 0)
+    CRhinoVariantHelpers::RedrawDocument();
+}
+
+void CAnalysisObject::Regen()
+{
+  if (IsUpdating())
+    m_bRegen = true;
+  else
+    CRhinoVariantHelpers::RegenDocument();
+}
+
+bool CAnalysisObject::IsUpdating() const
+{
+  if (m_update_depth <= 0)
+    return false;
+  const CRhinoDoc* doc = CRhinoVariantHelpers::Document();
+  return nullptr != doc && doc->RuntimeSerialNumber() == m_update_document_sn;
+}
+
+VARIANT CAnalysisObject::BeginUpdate()
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+
+  // The outermost BeginUpdate() records where the update started
+  if (0 == m_update_depth)
+  {
+    const CRhinoDoc* doc = CRhinoVariantHelpers::Document();
+    m_update_document_sn = doc ? doc->RuntimeSerialNumber() : 0;
+    m_update_command_depth = m_command_depth;
+  }
+  m_update_depth++;
+
+  V_VT(&vaResult) = VT_I4;
+  vaResult.lVal = m_update_depth;
+
+  return vaResult;
+}
+
+VARIANT CAnalysisObject::EndUpdate(const VARIANT& vaForce)
+{
+  VARIANT vaResult;
+  VariantInit(&vaResult);
+  V_VT(&vaResult) = VT_NULL;
+
+  if (m_update_depth <= 0)
+    return vaResult;
+
+  // Forcing ends every BeginUpdate() at once, for a script that
+  // recovers from an error in a script that did not end its update
+  bool bForce = false;
+  CRhinoVariantHelpers::ConvertVariant(vaForce, bForce, true);
+
+  V_VT(&vaResult) = VT_I4;
+  vaResult.lVal = 0;
+  m_update_depth = bForce ? 0 : m_update_depth - 1;
+  if (m_update_depth > 0)
+    return vaResult;
+
+  vaResult.lVal = FinishUpdate();
+
+  return vaResult;
+}
+
+int CAnalysisObject::FinishUpdate()
+{
+  // The meshes that changed are found again, since a script can delete
+  // or replace objects during the update. The document is found by its
+  // serial number, since another document may be active by now.
+  ON_SimpleArray<ON_Mesh*> meshes(m_changed_ids.Count());
+  CRhinoDoc* doc = CRhinoDoc::FromRuntimeSerialNumber(m_update_document_sn);
+  if (doc)
+  {
+    const ON_UUID* ids = m_changed_ids.Array();
+    for (int i = 0; i < m_changed_ids.Count(); i++)
+    {
+      const CRhinoMeshObject* mesh_object = CRhinoMeshObject::Cast(CRhinoObject::FromId(m_update_document_sn, ids[i]));
+      if (mesh_object)
+        meshes.Append(const_cast<ON_Mesh*>(mesh_object->Mesh()));
+    }
+
+    // Every mesh is recolored concurrently, then the views are redrawn once
+    const int changed_count = CAnalysisUserData::UpdateColors(meshes);
+    if (changed_count > 0 || m_bRegen)
+      doc->Regen();
+    else if (meshes.Count() > 0)
+      doc->Redraw();
+  }
+
+  CancelUpdate();
+  return meshes.Count();
+}
+
+void CAnalysisObject::CommandStarted()
+{
+  m_command_depth++;
+}
+
+void CAnalysisObject::CommandEnded()
+{
+  if (m_command_depth > 0)
+    m_command_depth--;
+
+  // The script command that started the update ended without ending it
+  if (m_update_depth > 0 && m_command_depth < m_update_command_depth)
+    FinishUpdate();
+}
+
+void CAnalysisObject::DocumentClosed(unsigned int document_sn)
+{
+  if (m_update_depth > 0 && document_sn == m_update_document_sn)
+    CancelUpdate();
+}
+
+void CAnalysisObject::CancelUpdate()
+{
+  m_update_depth = 0;
+  m_changed_ids.Empty();
+  m_bRegen = false;
+  m_update_document_sn = 0;
+  m_update_command_depth = 0;
+}
@@ -15,6 +15,43 @@ public:
 
   virtual void OnFinalRelease();
 
+  /*
+  Description:
+    Creates an analysis mesh from script arrays, as AddAnalysisMesh()
+    does, without adding it to a document. Flat arrays of doubles,
+    floats or longs, with three numbers for each vertex, four vertex
+    indices for each face and one value for each vertex, are read
+    without a conversion. Other arrays, such as arrays of points, are
+    converted one element at a time. Float indices are exact up to
+    16,777,216; integer indices are exact for any mesh.
+  Parameters:
+    vaVertices - [in] the vertices.
+    vaFaces    - [in] the faces.
+    vaData     - [in] one value for each vertex.
+    bQuiet     - [in] if true, arrays that cannot be converted do not
+                      throw a dispatch exception.
+  Returns:
+    The mesh, with its analysis data attached and colored, or nullptr
+    if the arrays are not valid. The caller is responsible for
+    deleting it.
+  */
+  static ON_Mesh* CreateAnalysisMesh(const VARIANT& vaVertices, const VARIANT& vaFaces, const VARIANT& vaData, bool bQuiet = false);
+
+  /*
+  Description:
+    Called by CAnalysisUpdateWatcher. An update that a script started
+    with BeginUpdate() inside a command is ended, as EndUpdate() ends
+    it, when that command ends. An update is dropped without
+    recoloring when its document is closed or a new document is
+    started.
+  Parameters:
+    document_sn - [in] the runtime serial number of the document.
+  */
+  void CommandStarted();
+  void CommandEnded();
+  void DocumentClosed(unsigned int document_sn);
+  void CancelUpdate();
+
 protected:
   DECLARE_MESSAGE_MAP()
   DECLARE_DISPATCH_MAP()
@@ -25,6 +62,18 @@ protected:
   VARIANT AnalysisMeshData(const VARIANT& vaObject, const VARIANT& vaData);
   VARIANT AnalysisMeshDisplayRange(const VARIANT& vaObject, const VARIANT& vaRange);
   VARIANT AnalysisMeshDataRange(const VARIANT& vaObject);
+  VARIANT AnalysisMeshVariable(const VARIANT& vaObject, const VARIANT& vaVariable);
+  VARIANT AnalysisMeshVariables(const VARIANT& vaObject);
+  VARIANT AnalysisMeshFrame(const VARIANT& vaObject, const VARIANT& vaFrame);
+  VARIANT AnalysisMeshFrameTimes(const VARIANT& vaObject);
+  VARIANT AnalysisMeshColorMap(const VARIANT& vaObject, const VARIANT& vaColorMap, const VARIANT& vaBands);
+  VARIANT AnalysisMeshTextureColors(const VARIANT& vaObject, const VARIANT& vaEnable);
+  VARIANT AnalysisMeshTolerance(const VARIANT& vaObject, const VARIANT& vaTolerance);
+  VARIANT AddAnalysisMeshes(const VARIANT& vaVertices, const VARIANT& vaFaces, const VARIANT& vaData);
+  VARIANT AnalysisMeshesData(const VARIANT& vaObjects, const VARIANT& vaData);
+  VARIANT AnalysisMeshesDisplayRange(const VARIANT& vaObjects, const VARIANT& vaRange);
+  VARIANT BeginUpdate();
+  VARIANT EndUpdate(const VARIANT& vaForce);
 
   enum
   {
@@ -33,7 +82,59 @@ protected:
     dispidAnalysisMeshData,
     dispidAnalysisMeshDisplayRange,
     dispidAnalysisMeshDataRange,
+    dispidAnalysisMeshVariable,
+    dispidAnalysisMeshVariables,
+    dispidAnalysisMeshFrame,
+    dispidAnalysisMeshFrameTimes,
+    dispidAnalysisMeshColorMap,
+    dispidAnalysisMeshTextureColors,
+    dispidAnalysisMeshTolerance,
+    dispidAddAnalysisMeshes,
+    dispidAnalysisMeshesData,
+    dispidAnalysisMeshesDisplayRange,
+    dispidBeginUpdate,
+    dispidEndUpdate,
   };
+
+private:
+  /*
+  Description:
+    Recolors meshes whose values, range or color map changed, and
+    regenerates the document. Between BeginUpdate() and EndUpdate()
+    the meshes are only recorded, and EndUpdate() recolors them all
+    at once.
+  Parameters:
+    mesh      - [in] the mesh.
+    object_id - [in] the id of the mesh object.
+  */
+  void MeshChanged(ON_Mesh* mesh, const ON_UUID& object_id);
+  void MeshesChanged(const ON_SimpleArray<ON_Mesh*>& meshes, const ON_SimpleArray<ON_UUID>& object_ids);
+
+  // Regenerates the document, or, during an update, has EndUpdate() do it.
+  void Regen();
+
+  // True if changes are recorded for EndUpdate(). Changes to another
+  // document than the one the update started in are made right away.
+  bool IsUpdating() const;
+
+  // Recolors the meshes recorded during an update, regenerates their
+  // document and ends the update. Returns the number of meshes.
+  int FinishUpdate();
+
+  // Number of BeginUpdate() calls without an EndUpdate()
+  int m_update_depth;
+
+  // The meshes to recolor, and whether to regenerate, at EndUpdate()
+  ON_UuidList m_changed_ids;
+  bool m_bRegen;
+
+  // The runtime serial number of the document the update started in
+  unsigned int m_update_document_sn;
+
+  // Number of running commands, and the number that were running
+  // when the update started
+  int m_command_depth;
+  int m_update_command_depth;
 };
 
 
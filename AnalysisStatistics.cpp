@@ -0,0 +1,302 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisStatistics.cpp
+
+#include "stdafx.h"
+#include "AnalysisStatistics.h"
+#include <float.h>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#define ANALYSIS_STATISTICS_SIMD
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// Running sums of one pass. The sums are of the values minus a shift,
+// the first finite value, so the variance does not lose precision
+// when the values are large compared to their spread.
+class CStatisticsSums
+{
+public:
+  CStatisticsSums()
+    : m_min(DBL_MAX)
+    , m_max(-DBL_MAX)
+    , m_sum(0.0)
+    , m_sum2(0.0)
+    , m_finite(0.0)
+    , m_nan(0.0)
+  {
+  }
+  double m_min;
+  double m_max;
+  double m_sum;
+  double m_sum2;
+  double m_finite;
+  double m_nan;
+};
+
+// x - x is 0 for finite values and NaN for infinite and NaN values
+template <class T>
+static void AccumulateScalar(const T* values, size_t count, double shift, CStatisticsSums& sums)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    const double x = values[i];
+    if (x != x)
+      sums.m_nan += 1.0;
+    else if (0.0 == x - x)
+    {
+      if (x < sums.m_min)
+        sums.m_min = x;
+      if (x > sums.m_max)
+        sums.m_max = x;
+      const double d = x - shift;
+      sums.m_sum += d;
+      sums.m_sum2 += d * d;
+      sums.m_finite += 1.0;
+    }
+  }
+}
+
+#if defined(ANALYSIS_STATISTICS_SIMD)
+
+// True if the processor has AVX and the operating system saves the
+// AVX registers.
+static bool HasAVX()
+{
+  int info[4] = { 0 };
+  __cpuid(info, 1);
+  const bool bOSXSAVE = (0 != (info[2] & (1 << 27)));
+  const bool bAVX = (0 != (info[2] & (1 << 28)));
+  if (!bOSXSAVE || !bAVX)
+    return false;
+  return (6 == (_xgetbv(0) & 6));
+}
+
+// Loads two or four values as doubles. Single precision values are
+// converted, so the sums are always double precision.
+static __m128d Load2(const double* p)
+{
+  return _mm_loadu_pd(p);
+}
+
+static __m128d Load2(const float* p)
+{
+  return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)p)));
+}
+
+static __m256d Load4(const double* p)
+{
+  return _mm256_loadu_pd(p);
+}
+
+static __m256d Load4(const float* p)
+{
+  return _mm256_cvtps_pd(_mm_loadu_ps(p));
+}
+
+// Each lane is masked to the finite values, so there are no branches.
+// Returns the number of values that were processed; the caller
+// processes the rest.
+template <class T>
+static size_t AccumulateSSE2(const T* values, size_t count, double shift, CStatisticsSums& sums)
+{
+  const size_t n = count & ~(size_t)1;
+  if (0 == n)
+    return 0;
+
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d k = _mm_set1_pd(shift);
+  const __m128d big = _mm_set1_pd(DBL_MAX);
+  const __m128d small = _mm_set1_pd(-DBL_MAX);
+  __m128d mn = big, mx = small, sum = zero, sum2 = zero, finite = zero, nan = zero;
+
+  for (size_t i = 0; i < n; i += 2)
+  {
+    const __m128d x = Load2(values + i);
+    const __m128d is_nan = _mm_cmpunord_pd(x, x);
+    const __m128d is_finite = _mm_cmpeq_pd(_mm_sub_pd(x, x), zero);
+    const __m128d d = _mm_and_pd(_mm_sub_pd(x, k), is_finite);
+    sum = _mm_add_pd(sum, d);
+    sum2 = _mm_add_pd(sum2, _mm_mul_pd(d, d));
+    finite = _mm_add_pd(finite, _mm_and_pd(is_finite, one));
+    nan = _mm_add_pd(nan, _mm_and_pd(is_nan, one));
+    mn = _mm_min_pd(mn, _mm_or_pd(_mm_and_pd(is_finite, x), _mm_andnot_pd(is_finite, big)));
+    mx = _mm_max_pd(mx, _mm_or_pd(_mm_and_pd(is_finite, x), _mm_andnot_pd(is_finite, small)));
+  }
+
+  double lanes[6][2];
+  _mm_storeu_pd(lanes[0], mn);
+  _mm_storeu_pd(lanes[1], mx);
+  _mm_storeu_pd(lanes[2], sum);
+  _mm_storeu_pd(lanes[3], sum2);
+  _mm_storeu_pd(lanes[4], finite);
+  _mm_storeu_pd(lanes[5], nan);
+  for (int j = 0; j < 2; j++)
+  {
+    if (lanes[0][j] < sums.m_min)
+      sums.m_min = lanes[0][j];
+    if (lanes[1][j] > sums.m_max)
+      sums.m_max = lanes[1][j];
+    sums.m_sum += lanes[2][j];
+    sums.m_sum2 += lanes[3][j];
+    sums.m_finite += lanes[4][j];
+    sums.m_nan += lanes[5][j];
+  }
+
+  return n;
+}
+
+// The same as AccumulateSSE2(), four values at a time
+template <class T>
+static size_t AccumulateAVX(const T* values, size_t count, double shift, CStatisticsSums& sums)
+{
+  const size_t n = count & ~(size_t)3;
+  if (0 == n)
+    return 0;
+
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d k = _mm256_set1_pd(shift);
+  const __m256d big = _mm256_set1_pd(DBL_MAX);
+  const __m256d small = _mm256_set1_pd(-DBL_MAX);
+  __m256d mn = big, mx = small, sum = zero, sum2 = zero, finite = zero, nan = zero;
+
+  for (size_t i = 0; i < n; i += 4)
+  {
+    const __m256d x = Load4(values + i);
+    const __m256d is_nan = _mm256_cmp_pd(x, x, _CMP_UNORD_Q);
+    const __m256d is_finite = _mm256_cmp_pd(_mm256_sub_pd(x, x), zero, _CMP_EQ_OQ);
+    const __m256d d = _mm256_and_pd(_mm256_sub_pd(x, k), is_finite);
+    sum = _mm256_add_pd(sum, d);
+    sum2 = _mm256_add_pd(sum2, _mm256_mul_pd(d, d));
+    finite = _mm256_add_pd(finite, _mm256_and_pd(is_finite, one));
+    nan = _mm256_add_pd(nan, _mm256_and_pd(is_nan, one));
+    mn = _mm256_min_pd(mn, _mm256_blendv_pd(big, x, is_finite));
+    mx = _mm256_max_pd(mx, _mm256_blendv_pd(small, x, is_finite));
+  }
+
+  double lanes[6][4];
+  _mm256_storeu_pd(lanes[0], mn);
+  _mm256_storeu_pd(lanes[1], mx);
+  _mm256_storeu_pd(lanes[2], sum);
+  _mm256_storeu_pd(lanes[3], sum2);
+  _mm256_storeu_pd(lanes[4], finite);
+  _mm256_storeu_pd(lanes[5], nan);
+  _mm256_zeroupper();
+  for (int j = 0; j < 4; j++)
+  {
+    if (lanes[0][j] < sums.m_min)
+      sums.m_min = lanes[0][j];
+    if (lanes[1][j] > sums.m_max)
+      sums.m_max = lanes[1][j];
+    sums.m_sum += lanes[2][j];
+    sums.m_sum2 += lanes[3][j];
+    sums.m_finite += lanes[4][j];
+    sums.m_nan += lanes[5][j];
+  }
+
+  return n;
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+
+CAnalysisStatistics::CAnalysisStatistics()
+  : m_count(0)
+  , m_finite_count(0)
+  , m_nan_count(0)
+  , m_infinite_count(0)
+  , m_min(ON_UNSET_VALUE)
+  , m_max(ON_UNSET_VALUE)
+  , m_mean(ON_UNSET_VALUE)
+  , m_variance(ON_UNSET_VALUE)
+{
+}
+
+bool CAnalysisStatistics::IsKernelAvailable(kernel_type kernel)
+{
+  switch (kernel)
+  {
+  case best_kernel:
+  case scalar_kernel:
+    return true;
+#if defined(ANALYSIS_STATISTICS_SIMD)
+  case sse2_kernel:
+    return true;
+  case avx_kernel:
+  {
+    static const bool bAVX = HasAVX();
+    return bAVX;
+  }
+#endif
+  default:
+    break;
+  }
+  return false;
+}
+
+template <class T>
+bool CAnalysisStatistics::Compute(const T* values, int count, kernel_type kernel)
+{
+  *this = CAnalysisStatistics();
+  if (nullptr == values || count <= 0 || !IsKernelAvailable(kernel))
+    return false;
+
+  m_count = count;
+
+  // The shift is the first finite value
+  double shift = 0.0;
+  for (int i = 0; i < count; i++)
+  {
+    if (0.0 == values[i] - values[i])
+    {
+      shift = values[i];
+      break;
+    }
+  }
+
+  CStatisticsSums sums;
+  size_t done = 0;
+
+#if defined(ANALYSIS_STATISTICS_SIMD)
+  if (best_kernel == kernel)
+    kernel = IsKernelAvailable(avx_kernel) ? avx_kernel : sse2_kernel;
+  if (avx_kernel == kernel)
+    done = AccumulateAVX(values, count, shift, sums);
+  else if (sse2_kernel == kernel)
+    done = AccumulateSSE2(values, count, shift, sums);
+#endif
+
+  AccumulateScalar(values + done, count - done, shift, sums);
+
+  m_finite_count = (int)sums.m_finite;
+  m_nan_count = (int)sums.m_nan;
+  m_infinite_count = m_count - m_finite_count - m_nan_count;
+  if (0 == m_finite_count)
+    return false;
+
+  const double n = sums.m_finite;
+  const double mean = sums.m_sum / n;
+  m_min = sums.m_min;
+  m_max = sums.m_max;
+  m_mean = shift + mean;
+  m_variance = sums.m_sum2 / n - mean * mean;
+  if (m_variance < 0.0)
+    m_variance = 0.0;
+
+  return true;
+}
+
+template bool CAnalysisStatistics::Compute<double>(const double*, int, kernel_type);
+template bool CAnalysisStatistics::Compute<float>(const float*, int, kernel_type);
+
+ON_Interval CAnalysisStatistics::Range() const
+{
+  if (0 == m_finite_count)
+    return ON_Interval::EmptyInterval;
+  return ON_Interval(m_min, m_max);
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisStatistics.h
+
+#pragma once
+
+// CAnalysisStatistics
+// The range, mean and variance of an array of analysis values, found
+// in a single pass. NaN and infinite values are counted but otherwise
+// ignored. The pass uses AVX when the processor and operating system
+// support it, SSE2 otherwise. Single precision values are summed in
+// double precision.
+//
+
+class CAnalysisStatistics
+{
+public:
+  // The code that makes the pass
+  enum kernel_type : int
+  {
+    best_kernel = 0,    // the fastest kernel the processor supports
+    scalar_kernel = 1,  // one value at a time, without SIMD
+    sse2_kernel = 2,    // two values at a time
+    avx_kernel = 3      // four values at a time
+  };
+
+  CAnalysisStatistics();
+
+  // True if the processor supports a kernel.
+  static bool IsKernelAvailable(kernel_type kernel);
+
+  /*
+  Description:
+    Computes the statistics of an array of values.
+  Parameters:
+    values - [in] the values, doubles or floats.
+    count  - [in] number of values.
+    kernel - [in] the kernel that makes the pass. Every kernel gives
+                  the same counts and range; the mean and variance
+                  differ only by rounding. Tests and benchmarks compare
+                  kernels; other callers use the best one.
+  Returns:
+    True if at least one value is finite. Otherwise, or if the kernel
+    is not available, the range, mean and variance are ON_UNSET_VALUE.
+  */
+  template <class T>
+  bool Compute(const T* values, int count, kernel_type kernel = best_kernel);
+
+  // The range of the finite values, or an unset interval if there are none.
+  ON_Interval Range() const;
+
+  // Number of values, and how many of them are finite, NaN or infinite
+  int m_count;
+  int m_finite_count;
+  int m_nan_count;
+  int m_infinite_count;
+
+  // Minimum, maximum, mean and population variance of the finite values
+  double m_min;
+  double m_max;
+  double m_mean;
+  double m_variance;
+};
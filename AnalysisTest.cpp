@@ -0,0 +1,183 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisTest.cpp
+
+#include "stdafx.h"
+#include "AnalysisTest.h"
+#include <chrono>
+#include <psapi.h>
+
+CAnalysisTest::CAnalysisTest(const wchar_t* name, test_type type)
+  : m_name(name)
+  , m_type(type)
+  , m_next(First())
+  , m_log(nullptr)
+  , m_failure_count(0)
+{
+  First() = this;
+}
+
+const wchar_t* CAnalysisTest::Name() const
+{
+  return m_name;
+}
+
+CAnalysisTest::test_type CAnalysisTest::Type() const
+{
+  return m_type;
+}
+
+CAnalysisTest*& CAnalysisTest::First()
+{
+  // A function static, since the tests are constructed
+  // during static initialization in no particular order
+  static CAnalysisTest* first = nullptr;
+  return first;
+}
+
+int CAnalysisTest::RunTests(int type, ON_TextLog& log)
+{
+  // The registry is in reverse order
+  ON_SimpleArray<CAnalysisTest*> tests;
+  for (CAnalysisTest* test = First(); test; test = test->m_next)
+  {
+    if (type < 0 || type == (int)test->m_type)
+      tests.Insert(0, test);
+  }
+
+  int failure_count = 0;
+  for (int i = 0; i < tests.Count(); i++)
+  {
+    CAnalysisTest* test = tests[i];
+    test->m_log = &log;
+    test->m_failure_count = 0;
+
+    log.Print(L"%ls\n", test->m_name);
+    const double start = Seconds();
+    test->Run();
+    const double seconds = Seconds() - start;
+
+    if (check_test == test->m_type)
+      log.Print(L"  %ls (%.3f seconds)\n", test->m_failure_count ? L"FAILED" : L"passed", seconds);
+
+    failure_count += test->m_failure_count;
+    test->m_log = nullptr;
+  }
+
+  log.Print(L"%d tests run, %d checks failed.\n", tests.Count(), failure_count);
+  return failure_count;
+}
+
+bool CAnalysisTest::Check(bool bPassed, const wchar_t* description)
+{
+  if (!bPassed)
+  {
+    m_failure_count++;
+    if (m_log)
+      m_log->Print(L"  Failed: %ls\n", description);
+  }
+  return bPassed;
+}
+
+void CAnalysisTest::Print(const wchar_t* format, ...)
+{
+  if (nullptr == m_log || nullptr == format)
+    return;
+
+  ON_wString s;
+  va_list args;
+  va_start(args, format);
+  s.FormatVargs(format, args);
+  va_end(args);
+
+  m_log->Print(L"  %ls\n", static_cast<const wchar_t*>(s));
+}
+
+double CAnalysisTest::Seconds()
+{
+  const auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(now).count();
+}
+
+size_t CAnalysisTest::MemoryUsage()
+{
+  PROCESS_MEMORY_COUNTERS_EX counters;
+  memset(&counters, 0, sizeof(counters));
+  counters.cb = sizeof(counters);
+  if (!::GetProcessMemoryInfo(::GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters)))
+    return 0;
+  return counters.PrivateUsage;
+}
+
+ON_wString CAnalysisTest::TempFileName(const wchar_t* name)
+{
+  ON_wString filename;
+  wchar_t path[MAX_PATH + 1] = { 0 };
+  const DWORD length = ::GetTempPathW(MAX_PATH, path);
+  if (0 == length || length > MAX_PATH || nullptr == name)
+    return filename;
+
+  // The process id keeps Rhino sessions from sharing files
+  filename.Format(L"%sAnalysisTools_%u_%s", path, (unsigned int)::GetCurrentProcessId(), name);
+  return filename;
+}
+
+void CAnalysisTest::AppendText(ON_SimpleArray<char>& text, const char* format, ...)
+{
+  char buffer[512];
+  va_list args;
+  va_start(args, format);
+  const int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+
+  if (length > 0)
+    text.Append(length < (int)sizeof(buffer) ? length : (int)sizeof(buffer) - 1, buffer);
+}
+
+bool CAnalysisTest::WriteFile(const wchar_t* filename, const void* buffer, size_t size)
+{
+  FILE* fp = ON::OpenFile(filename, L"wb");
+  if (nullptr == fp)
+    return false;
+
+  const bool rc = (0 == size || size == fwrite(buffer, 1, size, fp));
+  ON::CloseFile(fp);
+  return rc;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+CAnalysisMemoryPeak::CAnalysisMemoryPeak()
+  : m_start(0)
+  , m_peak(0)
+  , m_bStop(false)
+{
+  m_start = CAnalysisTest::MemoryUsage();
+  m_peak = m_start;
+  m_thread = std::thread([this]()
+  {
+    while (!m_bStop)
+    {
+      const size_t usage = CAnalysisTest::MemoryUsage();
+      if (usage > m_peak)
+        m_peak = usage;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+}
+
+CAnalysisMemoryPeak::~CAnalysisMemoryPeak()
+{
+  Stop();
+}
+
+size_t CAnalysisMemoryPeak::Stop()
+{
+  if (m_thread.joinable())
+  {
+    m_bStop = true;
+    m_thread.join();
+  }
+  return m_peak > m_start ? m_peak - m_start : 0;
+}
@@ -0,0 +1,121 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisTest.h
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+// CAnalysisTest
+// A check or benchmark of the readers, value storage and color code,
+// which runs without a document. Every test file defines one static
+// instance of a class derived from CAnalysisTest, which registers
+// itself. The TestAnalysisTools command runs the registered tests.
+//
+
+class CAnalysisTest
+{
+public:
+  enum test_type : int
+  {
+    check_test = 0,     // verifies results, and fails if they are wrong
+    benchmark_test = 1  // measures and prints times and memory
+  };
+
+  CAnalysisTest(const wchar_t* name, test_type type);
+  virtual ~CAnalysisTest() = default;
+
+  const wchar_t* Name() const;
+  test_type Type() const;
+
+  /*
+  Description:
+    Runs the registered tests of a type.
+  Parameters:
+    type - [in] the type of tests to run, or -1 to run every test.
+    log  - [in] where the results are printed.
+  Returns:
+    The number of checks that failed.
+  */
+  static int RunTests(int type, ON_TextLog& log);
+
+  // A monotonic time in seconds, for timing parts of a test
+  static double Seconds();
+
+  // The private memory of the process in bytes
+  static size_t MemoryUsage();
+
+  // Gets the full path of a file in the temporary folder
+  static ON_wString TempFileName(const wchar_t* name);
+
+  // Appends formatted text, without a terminating null, to a buffer
+  static void AppendText(ON_SimpleArray<char>& text, const char* format, ...);
+
+  // Writes a file. Returns true if successful.
+  static bool WriteFile(const wchar_t* filename, const void* buffer, size_t size);
+
+protected:
+  /*
+  Description:
+    Runs the test. Call Check() to verify results and Print()
+    to report measurements.
+  */
+  virtual void Run() = 0;
+
+  /*
+  Description:
+    Records the result of a check. Failures are printed.
+  Parameters:
+    bPassed     - [in] the result of the check.
+    description - [in] what was checked.
+  Returns:
+    bPassed.
+  */
+  bool Check(bool bPassed, const wchar_t* description);
+
+  // Prints a line of the test's output
+  void Print(const wchar_t* format, ...);
+
+private:
+  CAnalysisTest(const CAnalysisTest&) = delete;
+  CAnalysisTest& operator=(const CAnalysisTest&) = delete;
+
+  // The registered tests, in reverse order of construction
+  static CAnalysisTest*& First();
+
+private:
+  const wchar_t* m_name;
+  test_type m_type;
+  CAnalysisTest* m_next;
+  ON_TextLog* m_log;
+  int m_failure_count;
+};
+
+// CAnalysisMemoryPeak
+// Samples the private memory of the process on a worker thread, so a
+// benchmark can report the peak memory used by the code it times.
+//
+
+class CAnalysisMemoryPeak
+{
+public:
+  // Starts sampling
+  CAnalysisMemoryPeak();
+  ~CAnalysisMemoryPeak();
+
+  // Stops sampling and returns the peak, in bytes, above the memory
+  // in use when sampling started.
+  size_t Stop();
+
+private:
+  CAnalysisMemoryPeak(const CAnalysisMemoryPeak&) = delete;
+  CAnalysisMemoryPeak& operator=(const CAnalysisMemoryPeak&) = delete;
+
+private:
+  size_t m_start;
+  std::atomic<size_t> m_peak;
+  std::atomic<bool> m_bStop;
+  std::thread m_thread;
+};
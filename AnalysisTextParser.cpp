@@ -0,0 +1,349 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisTextParser.cpp
+
+#include "stdafx.h"
+#include "AnalysisTextParser.h"
+
+// Longest number ParseDouble() will accept. Matches the scratch buffer
+// size used by the original wide character parser.
+static const int MAX_NUMBER_LENGTH = 512;
+
+// Smallest chunk of text SplitLines() will hand to a worker thread.
+static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+// Exactly representable powers of ten used by the ParseDouble() fast path.
+static const double POWERS_OF_TEN[] =
+{
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+bool CAnalysisTextParser::IsDigit(char c)
+{
+  return (c >= '0' && c <= '9');
+}
+
+bool CAnalysisTextParser::IsNumeric(char c)
+{
+  bool rc = false;
+  switch (c)
+  {
+  case '.':
+  case '+':
+  case '-':
+  case 'e':
+  case 'E':
+  case 'd':
+  case 'D':
+    rc = true;
+    break;
+  default:
+    if (c >= '0' && c <= '9')
+      rc = true;
+    break;
+  }
+
+  return rc;
+}
+
+bool CAnalysisTextParser::IsAlpha(char c)
+{
+  return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'));
+}
+
+bool CAnalysisTextParser::IsAlphaNumeric(char c)
+{
+  return (IsAlpha(c) || IsNumeric(c));
+}
+
+bool CAnalysisTextParser::GetLine(const char*& cursor, const char* end, const char*& line, const char*& line_end)
+{
+  if (nullptr == cursor || cursor >= end)
+    return false;
+
+  line = cursor;
+  const char* eol = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+  if (nullptr == eol)
+  {
+    line_end = end;
+    cursor = end;
+  }
+  else
+  {
+    line_end = eol;
+    cursor = eol + 1;
+  }
+
+  if (line_end > line && '\r' == line_end[-1])
+    line_end--;
+
+  return true;
+}
+
+int CAnalysisTextParser::LineCount(const char* begin, const char* end)
+{
+  if (nullptr == begin || begin >= end)
+    return 0;
+
+  int count = 0;
+  const char* s = begin;
+  for (;;)
+  {
+    s = static_cast<const char*>(memchr(s, '\n', end - s));
+    if (nullptr == s)
+      break;
+    count++;
+    s++;
+  }
+
+  if ('\n' != end[-1])
+    count++;
+
+  return count;
+}
+
+int CAnalysisTextParser::SplitLines(const char* begin, const char* end, ON_SimpleArray<const char*>& bounds)
+{
+  bounds.SetCount(0);
+  if (nullptr == begin || begin >= end)
+    return 0;
+
+  // A few chunks per processor so faster threads can pick up the slack
+  const size_t size = (size_t)(end - begin);
+  const size_t max_chunk_count = 4 * (size_t)concurrency::GetProcessorCount();
+  size_t chunk_count = size / MIN_CHUNK_SIZE;
+  if (chunk_count < 1)
+    chunk_count = 1;
+  else if (chunk_count > max_chunk_count)
+    chunk_count = max_chunk_count;
+
+  bounds.Reserve((int)chunk_count + 1);
+  bounds.Append(begin);
+  for (size_t i = 1; i < chunk_count; i++)
+  {
+    const char* s = begin + (size * i) / chunk_count;
+    if (s <= bounds[bounds.Count() - 1])
+      continue;
+    s = static_cast<const char*>(memchr(s, '\n', end - s));
+    if (nullptr == s || s + 1 >= end)
+      break;
+    bounds.Append(s + 1);
+  }
+  bounds.Append(end);
+
+  return bounds.Count() - 1;
+}
+
+const char* CAnalysisTextParser::SkipWhiteSpace(const char* s, const char* end)
+{
+  if (s)
+  {
+    while (s < end && (' ' == *s || '\t' == *s || '\r' == *s || '\n' == *s || ',' == *s))
+      s++;
+  }
+  return s;
+}
+
+const char* CAnalysisTextParser::SkipJunk(const char* s, const char* end)
+{
+  if (s)
+  {
+    while (s < end && !IsAlphaNumeric(*s))
+      s++;
+  }
+  return s;
+}
+
+const char* CAnalysisTextParser::SkipAlphaJunk(const char* s, const char* end)
+{
+  if (s)
+  {
+    while (s < end && *s != '+' && *s != '-' && *s != '.' && !IsDigit(*s))
+      s++;
+  }
+  return s;
+}
+
+const char* CAnalysisTextParser::ParseInt(const char* s, const char* end, int& i)
+{
+  if (s)
+  {
+    int value = 0;
+    int sgn = 1;
+    if (s < end && '+' == *s)
+      s++;
+    else if (s < end && '-' == *s)
+    {
+      sgn = -1;
+      s++;
+    }
+
+    if (s >= end || !IsDigit(*s))
+      s = nullptr;
+    else
+    {
+      while (s < end && IsDigit(*s))
+      {
+        value = value * 10 + ((int)(*s - '0'));
+        s++;
+      }
+      i = value * sgn;
+    }
+  }
+
+  return s;
+}
+
+const char* CAnalysisTextParser::ParseDouble(const char* s, const char* end, double& x)
+{
+  if (nullptr == s)
+    return nullptr;
+
+  const char* start = s;
+  bool bNegative = false;
+  bool bHaveDecimal = false;
+
+  if (s < end && ('+' == *s || '-' == *s))
+    bNegative = ('-' == *s++);
+
+  // 14-Aug-2013 Dale Fugier
+  // Deal with "-.0001" formatted values
+  if (s < end && '.' == *s)
+  {
+    bHaveDecimal = true;
+    s++;
+  }
+
+  if (s >= end || !IsDigit(*s))
+    return nullptr;
+
+  // Accumulate up to 19 significant digits, which always fit in 64 bits.
+  // Leading zeros are not significant; digits past the 19th are dropped
+  // and force the strtod fallback below.
+  ON__UINT64 mantissa = 0;
+  int digit_count = 0;
+  int exponent = 0;
+  bool bExact = true;
+
+  for (;;)
+  {
+    while (s < end && IsDigit(*s))
+    {
+      const int digit = *s++ - '0';
+      if (0 == digit_count && 0 == digit)
+      {
+        if (bHaveDecimal)
+          exponent--;
+      }
+      else if (digit_count < 19)
+      {
+        mantissa = mantissa * 10 + digit;
+        digit_count++;
+        if (bHaveDecimal)
+          exponent--;
+      }
+      else
+      {
+        bExact = false;
+        if (!bHaveDecimal)
+          exponent++;
+      }
+    }
+
+    if (s < end && '.' == *s)
+    {
+      if (bHaveDecimal)
+        return nullptr;
+      bHaveDecimal = true;
+      s++;
+      continue;
+    }
+
+    break;
+  }
+
+  if (s < end && ('e' == *s || 'E' == *s))
+  {
+    s++;
+
+    bool bNegativeExponent = false;
+    if (s < end && ('-' == *s || '+' == *s))
+      bNegativeExponent = ('-' == *s++);
+
+    if (s >= end || !IsDigit(*s))
+      return nullptr;
+
+    int e = 0;
+    while (s < end && IsDigit(*s))
+    {
+      if (e < 100000)
+        e = e * 10 + (*s - '0');
+      s++;
+    }
+    exponent += (bNegativeExponent ? -e : e);
+  }
+
+  if ((s - start) >= MAX_NUMBER_LENGTH || (s < end && IsNumeric(*s)))
+    return nullptr;
+
+  double v = 0.0;
+  if (0 == mantissa)
+  {
+    v = 0.0;
+  }
+  else if (bExact && mantissa <= (((ON__UINT64)1) << 53) && exponent >= -22 && exponent <= 22)
+  {
+    // Both operands are exact, so the single IEEE multiply or divide
+    // yields the correctly rounded result.
+    v = (double)mantissa;
+    if (exponent < 0)
+      v /= POWERS_OF_TEN[-exponent];
+    else
+      v *= POWERS_OF_TEN[exponent];
+  }
+  else
+  {
+    char buffer[MAX_NUMBER_LENGTH];
+    const size_t length = (size_t)(s - start);
+    memcpy(buffer, start, length);
+    buffer[length] = 0;
+    char* stop = nullptr;
+    v = strtod(buffer, &stop);
+    if (stop != buffer + length)
+      return nullptr;
+    x = v;
+    return s;
+  }
+
+  x = bNegative ? -v : v;
+
+  return s;
+}
+
+const char* CAnalysisTextParser::ParseCount(const char* line, const char* end, const char* string, int& count)
+{
+  count = 0;
+  if (nullptr == line || nullptr == string)
+    return nullptr;
+
+  const size_t string_length = strlen(string);
+  if (string_length <= 0)
+    return nullptr;
+
+  const char* s = SkipJunk(line, end);
+  if (nullptr == s || (size_t)(end - s) < string_length)
+    return nullptr;
+
+  if (_strnicmp(string, s, string_length))
+    return nullptr;
+
+  s = SkipJunk(s + string_length, end);
+  s = ParseInt(s, end, count);
+  if (nullptr == s)
+    count = 0;
+
+  return s;
+}
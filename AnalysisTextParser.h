@@ -0,0 +1,86 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisTextParser.h
+
+#pragma once
+
+// CAnalysisTextParser
+// Narrow-character parsing helpers used by the file readers. All of the
+// parsing functions work on a [s, end) range of ASCII bytes, such as a
+// line in a memory-mapped file, and never read past end. Functions that
+// return a pointer return nullptr on failure, and accept nullptr as input
+// so calls can be chained.
+//
+
+class CAnalysisTextParser
+{
+public:
+  static bool IsDigit(char c);
+  static bool IsNumeric(char c);
+  static bool IsAlpha(char c);
+  static bool IsAlphaNumeric(char c);
+
+  /*
+  Description:
+    Gets the next line of text.
+  Parameters:
+    cursor   - [in/out] the current position, advanced past the line terminator.
+    end      - [in] the end of the text.
+    line     - [out] the start of the line.
+    line_end - [out] the end of the line, excluding any "\r\n" or "\n".
+  Returns:
+    True if a line was found. False if cursor is at the end of the text.
+  */
+  static bool GetLine(const char*& cursor, const char* end, const char*& line, const char*& line_end);
+
+  /*
+  Description:
+    Counts the lines in a range of text. A last line that is not
+    terminated by a line feed is counted.
+  */
+  static int LineCount(const char* begin, const char* end);
+
+  /*
+  Description:
+    Splits a range of text into chunks that can be parsed concurrently.
+    Every chunk, except possibly the last, ends just after a line feed,
+    so no line is split between two chunks.
+  Parameters:
+    begin  - [in] the start of the text.
+    end    - [in] the end of the text.
+    bounds - [out] chunk i is the range [bounds[i], bounds[i+1]).
+  Returns:
+    The number of chunks, which is bounds.Count() - 1.
+  */
+  static int SplitLines(const char* begin, const char* end, ON_SimpleArray<const char*>& bounds);
+
+  // Skips spaces, tabs, line terminators and commas.
+  static const char* SkipWhiteSpace(const char* s, const char* end);
+
+  // Skips characters that are not letters or numeric characters.
+  static const char* SkipJunk(const char* s, const char* end);
+
+  // Skips characters that cannot start a number.
+  static const char* SkipAlphaJunk(const char* s, const char* end);
+
+  // Parses an optionally signed decimal integer.
+  static const char* ParseInt(const char* s, const char* end, int& i);
+
+  /*
+  Description:
+    Parses a decimal floating point number such as "-1.5", ".25" or
+    "2.729049E-001". Values with up to 19 significant digits and small
+    exponents are converted exactly without calling the C runtime;
+    everything else falls back to strtod, so the result is always the
+    correctly rounded double.
+  */
+  static const char* ParseDouble(const char* s, const char* end, double& x);
+
+  /*
+  Description:
+    Parses a "string count" pair, such as "vertexcount 12" or "I=33".
+    The string comparison is case insensitive.
+  */
+  static const char* ParseCount(const char* line, const char* end, const char* string, int& count);
+};
@@ -0,0 +1,191 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisTexture.cpp
+
+#include "stdafx.h"
+#include "AnalysisTexture.h"
+#include "AnalysisColorTable.h"
+
+// Texture coordinate of NaN values, and the limit of the others
+static const double g_far_coordinate = 1.0e6;
+
+template <class T>
+bool CAnalysisTexture::SetTextureCoordinates(ON_Mesh* mesh, const T* values, int count, const ON_Interval& minmax)
+{
+  if (nullptr == mesh || nullptr == values || count != mesh->m_V.Count())
+    return false;
+
+  const double length = minmax.Length();
+  const double scale = (length > 0.0) ? 1.0 / length : 0.0;
+  const double offset = minmax[0];
+
+  mesh->m_T.SetCapacity(count);
+  mesh->m_T.SetCount(count);
+  ON_2fPoint* t = mesh->m_T.Array();
+  for (int i = 0; i < count; i++)
+  {
+    double u = (values[i] - offset) * scale;
+    u = (u >= -g_far_coordinate) ? u : -g_far_coordinate;    // also NaN
+    u = (u <= g_far_coordinate) ? u : g_far_coordinate;
+    t[i].x = (float)u;
+    t[i].y = 0.5f;
+  }
+
+  return true;
+}
+
+template bool CAnalysisTexture::SetTextureCoordinates<double>(ON_Mesh*, const double*, int, const ON_Interval&);
+template bool CAnalysisTexture::SetTextureCoordinates<float>(ON_Mesh*, const float*, int, const ON_Interval&);
+
+ON_Xform CAnalysisTexture::TextureTransform(const ON_Interval& minmax, const ON_Interval& redblue)
+{
+  // The table parameter of a value a is p = (a - redblue[0]) / length.
+  // With a = minmax[0] + u * minmax.Length(), p = u * k + c.
+  double length = redblue[1] - redblue[0];
+  if (0.0 == length)
+    length = ON_EPSILON * (fabs(redblue[0]) + 1.0);
+  const double k = minmax.Length() / length;
+  const double c = (minmax[0] - redblue[0]) / length;
+
+  // MapValues() uses the color at index floor(p * (n - 1) + 0.5). The
+  // texel a nearest filtered texture coordinate s hits is floor(s * n),
+  // so s = (p * (n - 1) + 0.5) / n hits the same color.
+  const double n = (double)CAnalysisColorTable::color_count;
+  ON_Xform xform(ON_Xform::IdentityTransformation);
+  xform.m_xform[0][0] = k * (n - 1.0) / n;
+  xform.m_xform[0][3] = (c * (n - 1.0) + 0.5) / n;
+  return xform;
+}
+
+// Little endian values for the bitmap headers
+static unsigned char* PutBytes(unsigned char* p, unsigned int value, int size)
+{
+  for (int i = 0; i < size; i++, value >>= 8)
+    *p++ = (unsigned char)(value & 0xFF);
+  return p;
+}
+
+bool CAnalysisTexture::WriteBitmap(const CAnalysisColorTable& table, const wchar_t* filename)
+{
+  if (nullptr == filename || 0 == filename[0])
+    return false;
+
+  // BITMAPFILEHEADER and BITMAPINFOHEADER, then one row of BGR pixels.
+  // The row is a multiple of four bytes, so it needs no padding.
+  const int width = CAnalysisColorTable::color_count;
+  const unsigned int header_size = 14 + 40;
+  const unsigned int pixel_size = 3 * width;
+
+  ON_SimpleArray<unsigned char> bytes(header_size + pixel_size);
+  bytes.SetCount(header_size + pixel_size);
+  unsigned char* p = bytes.Array();
+  p = PutBytes(p, 'B' | ('M' << 8), 2);
+  p = PutBytes(p, header_size + pixel_size, 4);
+  p = PutBytes(p, 0, 4);
+  p = PutBytes(p, header_size, 4);
+  p = PutBytes(p, 40, 4);
+  p = PutBytes(p, width, 4);
+  p = PutBytes(p, 1, 4);
+  p = PutBytes(p, 1, 2);
+  p = PutBytes(p, 24, 2);
+  p = PutBytes(p, 0, 4);
+  p = PutBytes(p, pixel_size, 4);
+  p = PutBytes(p, 2835, 4);
+  p = PutBytes(p, 2835, 4);
+  p = PutBytes(p, 0, 4);
+  p = PutBytes(p, 0, 4);
+
+  const ON_Color* colors = table.Colors();
+  for (int i = 0; i < width; i++)
+  {
+    *p++ = (unsigned char)colors[i].Blue();
+    *p++ = (unsigned char)colors[i].Green();
+    *p++ = (unsigned char)colors[i].Red();
+  }
+
+  FILE* fp = ON::OpenFile(filename, L"wb");
+  if (nullptr == fp)
+    return false;
+  const bool rc = (1 == fwrite(bytes.Array(), bytes.Count(), 1, fp));
+  if (0 != ON::CloseFile(fp))
+    return false;
+  return rc;
+}
+
+// The bitmaps that have been written, one for each table. A table's
+// bitmap is deleted with the table, so a table's address identifies
+// it.
+class CAnalysisTextureCache
+{
+public:
+  CAnalysisTextureCache()
+    : m_file_count(0)
+  {
+  }
+
+  ~CAnalysisTextureCache()
+  {
+    for (int i = 0; i < m_filenames.Count(); i++)
+      ::DeleteFileW(m_filenames[i]);
+  }
+
+  static CAnalysisTextureCache& Get()
+  {
+    static CAnalysisTextureCache cache;
+    return cache;
+  }
+
+  concurrency::critical_section m_lock;
+  ON_SimpleArray<const CAnalysisColorTable*> m_tables;
+  ON_ClassArray<ON_wString> m_filenames;
+
+  // Number of bitmaps written, which numbers the files
+  int m_file_count;
+};
+
+bool CAnalysisTexture::GetBitmapFile(const CAnalysisColorTable& table, ON_wString& filename)
+{
+  CAnalysisTextureCache& cache = CAnalysisTextureCache::Get();
+
+  concurrency::critical_section::scoped_lock lock(cache.m_lock);
+  for (int i = 0; i < cache.m_tables.Count(); i++)
+  {
+    if (cache.m_tables[i] == &table)
+    {
+      filename = cache.m_filenames[i];
+      return true;
+    }
+  }
+
+  wchar_t path[MAX_PATH + 1] = { 0 };
+  const DWORD length = ::GetTempPathW(MAX_PATH, path);
+  if (0 == length || length > MAX_PATH)
+    return false;
+
+  // The process id keeps Rhino sessions from sharing files
+  filename.Format(L"%sAnalysisTools_%u_%d.bmp", path, (unsigned int)::GetCurrentProcessId(), cache.m_file_count++);
+  if (!WriteBitmap(table, filename))
+    return false;
+
+  cache.m_tables.Append(&table);
+  cache.m_filenames.Append(filename);
+  return true;
+}
+
+void CAnalysisTexture::DeleteBitmapFile(const CAnalysisColorTable& table)
+{
+  CAnalysisTextureCache& cache = CAnalysisTextureCache::Get();
+
+  concurrency::critical_section::scoped_lock lock(cache.m_lock);
+  for (int i = 0; i < cache.m_tables.Count(); i++)
+  {
+    if (cache.m_tables[i] == &table)
+    {
+      ::DeleteFileW(cache.m_filenames[i]);
+      cache.m_tables.Remove(i);
+      cache.m_filenames.Remove(i);
+      return;
+    }
+  }
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisTexture.h
+
+#pragma once
+
+class CAnalysisColorTable;
+
+// CAnalysisTexture
+// Colors analysis meshes on the graphics card. The values are
+// normalized once into the mesh's m_T[] texture coordinates, and the
+// colors come from a one pixel high bitmap of a color table. A change
+// of the display range is a change of the texture transform, and a
+// change of the color map is a change of the bitmap, so neither one
+// touches a vertex. With nearest filtering, every vertex gets the
+// color CAnalysisColorTable::MapValues() gives it, apart from single
+// precision rounding at the boundaries between colors.
+//
+
+class CAnalysisTexture
+{
+public:
+  /*
+  Description:
+    Sets the texture coordinates of a mesh from analysis values.
+  Parameters:
+    mesh   - [in/out] m_T[] is set to (u, 0.5) for each vertex, where
+                      u is 0.0 at minmax[0] and 1.0 at minmax[1].
+    values - [in] analysis values, doubles or floats, one for each
+                  mesh vertex.
+    count  - [in] number of values.
+    minmax - [in] the range the values are normalized to, usually
+                  CAnalysisUserData::m_minmax.
+  Returns:
+    True if successful.
+  Remarks:
+    NaN values are placed far below the range, so they have the start
+    color, as MapValues() gives them, unless the range is reversed.
+  */
+  template <class T>
+  static bool SetTextureCoordinates(ON_Mesh* mesh, const T* values, int count, const ON_Interval& minmax);
+
+  /*
+  Description:
+    Gets the texture transform that maps the coordinates set by
+    SetTextureCoordinates() to the texels of a color table bitmap.
+  Parameters:
+    minmax  - [in] the range the coordinates were normalized to.
+    redblue - [in] the display range, as in MapValues(). If it is
+                   empty, values below it have the start color and
+                   values above it the end color.
+  Returns:
+    A transform that scales and offsets u. The texture must clamp
+    and use nearest filtering.
+  */
+  static ON_Xform TextureTransform(const ON_Interval& minmax, const ON_Interval& redblue);
+
+  /*
+  Description:
+    Writes the colors of a table as a 24 bit, color_count by 1 pixel
+    bitmap.
+  Parameters:
+    table    - [in] the color table.
+    filename - [in] the bitmap file.
+  Returns:
+    True if successful.
+  */
+  static bool WriteBitmap(const CAnalysisColorTable& table, const wchar_t* filename);
+
+  /*
+  Description:
+    Gets the bitmap of a color table. The bitmap is written to the
+    temporary folder the first time the table is used and deleted
+    when the table is deleted or the plug-in is unloaded. Every table
+    has its own file, so textures cached by the display never show an
+    old color map.
+    Safe to call from any thread.
+  Parameters:
+    table    - [in] the color table.
+    filename - [out] the full path of the bitmap.
+  Returns:
+    True if successful.
+  */
+  static bool GetBitmapFile(const CAnalysisColorTable& table, ON_wString& filename);
+
+  /*
+  Description:
+    Deletes the bitmap of a color table, if it has one. Called when
+    the table is deleted. Safe to call from any thread.
+  */
+  static void DeleteBitmapFile(const CAnalysisColorTable& table);
+};
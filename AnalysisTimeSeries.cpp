@@ -0,0 +1,283 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisTimeSeries.cpp
+
+#include "stdafx.h"
+#include "AnalysisTimeSeries.h"
+#include "TecplotReader.h"
+#include "TecplotBinaryReader.h"
+
+// Number of decoded frames kept for each mesh
+static const int FRAME_CACHE_SIZE = 4;
+
+CAnalysisTimeSeries::CAnalysisTimeSeries()
+  : m_file_type(tecplot_ascii)
+  , m_file_size(0)
+  , m_point_count(0)
+  , m_variable_count(0)
+  , m_current_frame(0)
+{
+}
+
+CAnalysisTimeSeries::CAnalysisTimeSeries(const CAnalysisTimeSeries& src)
+  : m_filename(src.m_filename)
+  , m_file_type(src.m_file_type)
+  , m_file_size(src.m_file_size)
+  , m_point_count(src.m_point_count)
+  , m_variable_count(src.m_variable_count)
+  , m_current_frame(src.m_current_frame)
+  , m_times(src.m_times)
+  , m_offsets(src.m_offsets)
+  , m_formats(src.m_formats)
+  , m_node_index(src.m_node_index)
+{
+}
+
+CAnalysisTimeSeries& CAnalysisTimeSeries::operator=(const CAnalysisTimeSeries& src)
+{
+  if (this != &src)
+  {
+    m_filename = src.m_filename;
+    m_file_type = src.m_file_type;
+    m_file_size = src.m_file_size;
+    m_point_count = src.m_point_count;
+    m_variable_count = src.m_variable_count;
+    m_current_frame = src.m_current_frame;
+    m_times = src.m_times;
+    m_offsets = src.m_offsets;
+    m_formats = src.m_formats;
+    m_node_index = src.m_node_index;
+    m_cache.Empty();
+  }
+  return *this;
+}
+
+int CAnalysisTimeSeries::FrameCount() const
+{
+  return m_times.Count();
+}
+
+int CAnalysisTimeSeries::ChannelCount() const
+{
+  // Files without variable names have one analysis value
+  return (m_variable_count > 4) ? m_variable_count - 3 : 1;
+}
+
+void CAnalysisTimeSeries::Empty()
+{
+  m_filename.Empty();
+  m_file_type = tecplot_ascii;
+  m_file_size = 0;
+  m_point_count = 0;
+  m_variable_count = 0;
+  m_current_frame = 0;
+  m_times.Empty();
+  m_offsets.Empty();
+  m_formats.Empty();
+  m_node_index.Empty();
+  m_cache.Empty();
+}
+
+bool CAnalysisTimeSeries::ReadFrame(int frame, ON_SimpleArray<double>& node_values) const
+{
+  const int channel_count = ChannelCount();
+  node_values.SetCapacity(channel_count * m_point_count);
+  node_values.SetCount(channel_count * m_point_count);
+
+  if (tecplot_binary == m_file_type)
+  {
+    if (m_offsets.Count() != FrameCount() * channel_count || m_formats.Count() != m_offsets.Count())
+      return false;
+    const int first = frame * channel_count;
+    return CTecplotBinaryReader::ReadValues(m_filename, m_file_size, m_offsets.Array() + first, m_formats.Array() + first, channel_count, m_point_count, node_values.Array());
+  }
+
+  if (m_offsets.Count() != FrameCount())
+    return false;
+
+  CTecplotReader reader;
+  if (!reader.Open(m_filename) || reader.FileSize() != m_file_size)
+    return false;
+  return reader.ReadZoneValues(m_offsets[frame], m_point_count, m_variable_count, node_values.Array());
+}
+
+bool CAnalysisTimeSeries::GetFrameValues(int frame, int vertex_count, ON_SimpleArray<double>& values)
+{
+  if (frame < 0 || frame >= FrameCount() || vertex_count <= 0)
+    return false;
+
+  const int channel_count = ChannelCount();
+  const int value_count = channel_count * vertex_count;
+
+  int i;
+  for (i = 0; i < m_cache.Count(); i++)
+  {
+    if (m_cache[i].m_frame == frame && m_cache[i].m_values.Count() == value_count)
+      break;
+  }
+
+  if (i < m_cache.Count())
+  {
+    // Move the frame to the most recently used end
+    CCachedFrame cached = m_cache[i];
+    m_cache.Remove(i);
+    m_cache.Append(cached);
+  }
+  else
+  {
+    ON_SimpleArray<double> node_values;
+    if (!ReadFrame(frame, node_values))
+      return false;
+
+    if (m_cache.Count() >= FRAME_CACHE_SIZE)
+      m_cache.Remove(0);
+    CCachedFrame& cached = m_cache.AppendNew();
+    cached.m_frame = frame;
+
+    // The mesh vertices are the nodes in m_node_index[], or all of them
+    if (0 == m_node_index.Count())
+    {
+      if (vertex_count != m_point_count)
+      {
+        m_cache.Remove();
+        return false;
+      }
+      cached.m_values = node_values;
+    }
+    else
+    {
+      if (vertex_count != m_node_index.Count())
+      {
+        m_cache.Remove();
+        return false;
+      }
+      cached.m_values.SetCapacity(value_count);
+      cached.m_values.SetCount(value_count);
+      for (int c = 0; c < channel_count; c++)
+      {
+        const double* src = node_values.Array() + (size_t)c * m_point_count;
+        double* dst = cached.m_values.Array() + (size_t)c * vertex_count;
+        for (int v = 0; v < vertex_count; v++)
+          dst[v] = src[m_node_index[v]];
+      }
+    }
+  }
+
+  values = m_cache[m_cache.Count() - 1].m_values;
+
+  return true;
+}
+
+bool CAnalysisTimeSeries::Write(ON_BinaryArchive& archive) const
+{
+  bool rc = archive.BeginWrite3dmChunk(TCODE_ANONYMOUS_CHUNK, 1, 0);
+  if (!rc)
+    return false;
+
+  for (;;)
+  {
+    rc = archive.WriteString(m_filename);
+    if (!rc) break;
+
+    rc = archive.WriteInt((int)m_file_type);
+    if (!rc) break;
+
+    rc = archive.WriteBigInt(m_file_size);
+    if (!rc) break;
+
+    rc = archive.WriteInt(m_point_count);
+    if (!rc) break;
+
+    rc = archive.WriteInt(m_variable_count);
+    if (!rc) break;
+
+    rc = archive.WriteInt(m_current_frame);
+    if (!rc) break;
+
+    rc = archive.WriteArray(m_times);
+    if (!rc) break;
+
+    rc = archive.WriteInt(m_offsets.Count());
+    if (!rc) break;
+
+    for (int i = 0; i < m_offsets.Count() && rc; i++)
+      rc = archive.WriteBigInt(m_offsets[i]);
+    if (!rc) break;
+
+    rc = archive.WriteArray(m_formats);
+    if (!rc) break;
+
+    rc = archive.WriteArray(m_node_index);
+    if (!rc) break;
+
+    break;
+  }
+
+  if (!archive.EndWrite3dmChunk())
+    rc = false;
+
+  return rc;
+}
+
+bool CAnalysisTimeSeries::Read(ON_BinaryArchive& archive)
+{
+  Empty();
+
+  int major_version = 0;
+  int minor_version = 0;
+  bool rc = archive.BeginRead3dmChunk(TCODE_ANONYMOUS_CHUNK, &major_version, &minor_version);
+  if (!rc)
+    return false;
+
+  for (;;)
+  {
+    rc = (1 == major_version);
+    if (!rc) break;
+
+    rc = archive.ReadString(m_filename);
+    if (!rc) break;
+
+    int file_type = 0;
+    rc = archive.ReadInt(&file_type);
+    if (!rc) break;
+    m_file_type = (tecplot_binary == file_type) ? tecplot_binary : tecplot_ascii;
+
+    rc = archive.ReadBigInt(&m_file_size);
+    if (!rc) break;
+
+    rc = archive.ReadInt(&m_point_count);
+    if (!rc) break;
+
+    rc = archive.ReadInt(&m_variable_count);
+    if (!rc) break;
+
+    rc = archive.ReadInt(&m_current_frame);
+    if (!rc) break;
+
+    rc = archive.ReadArray(m_times);
+    if (!rc) break;
+
+    int offset_count = 0;
+    rc = archive.ReadInt(&offset_count);
+    if (!rc) break;
+
+    m_offsets.Reserve(offset_count);
+    for (int i = 0; i < offset_count && rc; i++)
+      rc = archive.ReadBigInt(&m_offsets.AppendNew());
+    if (!rc) break;
+
+    rc = archive.ReadArray(m_formats);
+    if (!rc) break;
+
+    rc = archive.ReadArray(m_node_index);
+    if (!rc) break;
+
+    break;
+  }
+
+  if (!archive.EndRead3dmChunk())
+    rc = false;
+
+  return rc;
+}
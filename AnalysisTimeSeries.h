@@ -0,0 +1,96 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisTimeSeries.h
+
+#pragma once
+
+// CAnalysisTimeSeries
+// The frames of a transient result whose geometry does not change.
+// The mesh is built from the first frame. The values of the other
+// frames are found by their position in the result file and are only
+// read when the frame is shown. The most recently shown frames are
+// cached, so stepping back and forth does not read the file again.
+//
+
+class CAnalysisTimeSeries
+{
+public:
+  // The format of the result file
+  enum file_type : int
+  {
+    tecplot_ascii = 0,
+    tecplot_binary = 1
+  };
+
+  CAnalysisTimeSeries();
+  ~CAnalysisTimeSeries() = default;
+
+  // The frame cache is not copied
+  CAnalysisTimeSeries(const CAnalysisTimeSeries& src);
+  CAnalysisTimeSeries& operator=(const CAnalysisTimeSeries& src);
+
+  // Number of frames, or 0 if the mesh is not a time series.
+  int FrameCount() const;
+
+  // Number of analysis channels in each frame.
+  int ChannelCount() const;
+
+  void Empty();
+
+  /*
+  Description:
+    Gets the values of every channel of a frame.
+  Parameters:
+    frame        - [in] zero based frame index.
+    vertex_count - [in] number of mesh vertices.
+    values       - [out] ChannelCount() columns of vertex_count values,
+                         in channel order.
+  Returns:
+    True if successful. False if the frame index is not valid or the
+    result file is missing or has changed since it was imported.
+  */
+  bool GetFrameValues(int frame, int vertex_count, ON_SimpleArray<double>& values);
+
+  bool Write(ON_BinaryArchive& archive) const;
+  bool Read(ON_BinaryArchive& archive);
+
+  // The result file, and its size when it was imported
+  ON_wString m_filename;
+  file_type m_file_type;
+  ON__UINT64 m_file_size;
+
+  // Number of nodes and variables in each frame's zone
+  int m_point_count;
+  int m_variable_count;
+
+  // The frame whose values are on the mesh
+  int m_current_frame;
+
+  // Solution time of each frame
+  ON_SimpleArray<double> m_times;
+
+  // For ASCII files, the offset of each frame's ZONE record. For
+  // binary files, the offset and data format of the values of each
+  // variable after x, y and z, for each frame. Passive variables
+  // have an offset of -1.
+  ON_SimpleArray<ON__INT64> m_offsets;
+  ON_SimpleArray<int> m_formats;
+
+  // The node number of each mesh vertex, or empty if the mesh
+  // has a vertex for every node.
+  ON_SimpleArray<int> m_node_index;
+
+private:
+  bool ReadFrame(int frame, ON_SimpleArray<double>& node_values) const;
+
+  // Frame values for the mesh vertices, most recently used last
+  class CCachedFrame
+  {
+  public:
+    CCachedFrame() : m_frame(-1) {}
+    int m_frame;
+    ON_SimpleArray<double> m_values;
+  };
+  ON_ClassArray<CCachedFrame> m_cache;
+};
@@ -7,6 +7,10 @@
 #include "rhinoSdkPlugInDeclare.h"
 #include "AnalysisToolsPlugIn.h"
 #include "AnalysisUserData.h"
+#include "AnalysisMappedFile.h"
+#include "AnalysisTextParser.h"
+#include "TecplotReader.h"
+#include "TecplotBinaryReader.h"
 #include "Resource.h"
 
 #pragma warning(push)
@@ -52,6 +56,7 @@ CAnalysisToolsPlugIn& AnalysisToolsPlugIn()
 }
 
 CAnalysisToolsPlugIn::CAnalysisToolsPlugIn()
+  : m_update_watcher(m_object)
 {
 	m_plugin_version = RhinoPlugInVersion();
 }
@@ -79,11 +84,19 @@ GUID CAnalysisToolsPlugIn::PlugInID() const
 
 BOOL CAnalysisToolsPlugIn::OnLoadPlugIn()
 {
+	// Draws the meshes that have texture colors
+	m_conduit.Enable();
+
+	// Ends or drops updates that scripts leave open
+	m_update_watcher.Register();
+	m_update_watcher.Enable(TRUE);
 	return TRUE;
 }
 
 void CAnalysisToolsPlugIn::OnUnloadPlugIn()
 {
+	m_conduit.Disable();
+	m_update_watcher.Enable(FALSE);
 }
 
 LPUNKNOWN CAnalysisToolsPlugIn::GetPlugInObjectInterface(const ON_UUID& iid)
@@ -102,6 +115,16 @@ LPUNKNOWN CAnalysisToolsPlugIn::GetPlugInObjectInterface(const ON_UUID& iid)
   return lpUnknown;
 }
 
+void CAnalysisToolsPlugIn::LoadProfile(LPCTSTR lpszSection, CRhinoProfileContext& pc)
+{
+  m_tecplot_options.LoadProfile(lpszSection, pc);
+}
+
+void CAnalysisToolsPlugIn::SaveProfile(LPCTSTR lpszSection, CRhinoProfileContext& pc)
+{
+  m_tecplot_options.SaveProfile(lpszSection, pc);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // File import overrides
 
@@ -114,206 +137,23 @@ void CAnalysisToolsPlugIn::AddFileType(ON_ClassArray<CRhinoFileType>& extensions
   m_tecplot_index = extensions.Count();
   CRhinoFileType ft2(PlugInID(), RHSTR(L"Tecplot Files (*.tp)"), L"tp");
   extensions.Append(ft2);
-}
-
-static bool IsNumeric(wchar_t c)
-{
-  bool rc = false;
-  switch (c)
-  {
-  case '.':
-  case '+':
-  case '-':
-  case 'e':
-  case 'E':
-  case 'd':
-  case 'D':
-    rc = true;
-    break;
-  default:
-    if (c >= '0' && c <= '9')
-      rc = true;
-    break;
-  }
-
-  return rc;
-}
-
-static bool IsAlpha(wchar_t c)
-{
-  return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'));
-}
-
-static bool IsAlphaNumeric(wchar_t c)
-{
-  return (IsAlpha(c) || IsNumeric(c));
-}
-
-static const wchar_t* SkipJunk(const wchar_t* s)
-{
-  if (s)
-  {
-    while (*s && !IsAlphaNumeric(*s))
-      s++;
-  }
-  return s;
-}
-
-static const wchar_t* SkipAlphaJunk(const wchar_t* s)
-{
-  if (s)
-  {
-    while (*s != 0 && *s != '+' && *s != '-' && *s != '.' && (*s < '0' || *s > '9'))
-      s++;
-  }
-  return s;
-}
-
-static const wchar_t* ParseInt(const wchar_t* s, int& i)
-{
-  if (s)
-  {
-    int value = 0;
-    int sgn = 1;
-    if ('+' == *s)
-      s++;
-    else if ('-' == *s)
-    {
-      sgn = -1;
-      s++;
-    }
-
-    if (*s < '0' || *s > '9')
-      s = nullptr;
-    else
-    {
-      while (*s >= '0' && *s <= '9')
-      {
-        value = value * 10 + ((int)(*s - '0'));
-        s++;
-      }
-      i = value * sgn;
-    }
-  }
-
-  return s;
-}
-
-static const wchar_t* ParseDouble(const wchar_t* s, double& x)
-{
-  if (s)
-  {
-    wchar_t buffer[512];
-    wmemset(buffer, 0, 512);
-
-    int buffer_length = 0;
-    bool bHaveDecimal = false;
-    bool bHaveMantissa = false;
-
-    if ('+' == *s || '-' == *s)
-      buffer[buffer_length++] = *s++;
-
-    // 14-Aug-2013 Dale Fugier
-    // Deal with "-.0001" formatted values
-    if ('.' == *s)
-    {
-      bHaveDecimal = true;
-      buffer[buffer_length++] = *s++;
-    }
-
-    if ((*s < '0' || *s > '9'))
-      s = nullptr;
-    else
-    {
-      while (*s >= '0' && *s <= '9' && buffer_length < 512)
-      {
-        bHaveMantissa = true;
-        buffer[buffer_length++] = *s++;
-      }
-
-      if ('.' == *s  && buffer_length < 512)
-      {
-        if (bHaveDecimal)
-          return nullptr;
-
-        bHaveDecimal = true;
-        buffer[buffer_length++] = *s++;
-
-        while (*s >= '0' && *s <= '9' && buffer_length < 512)
-        {
-          bHaveMantissa = true;
-          buffer[buffer_length++] = *s++;
-        }
-      }
-
-      if (('e' == *s || 'E' == *s) && buffer_length < 512)
-      {
-        if (0 == buffer_length)
-          buffer[buffer_length++] = '1';
-        buffer[buffer_length++] = *s++;
-
-        if (('-' == *s || '+' == *s) && buffer_length < 512)
-          buffer[buffer_length++] = *s++;
-
-        if (*s < '0' || *s > '9')
-          return nullptr;
-
-        while (*s >= '0' && *s <= '9' && buffer_length < 512)
-          buffer[buffer_length++] = *s++;
-      }
-
-      if (buffer_length >= 512 || IsNumeric(*s))
-        return nullptr;
-
-      buffer[buffer_length] = 0;
-      double v = ON_UNSET_VALUE;
 
-      if (1 == swscanf(buffer, L"%lg", &v))
-        x = v;
-      else
-        s = nullptr;
-    }
-  }
-
-  return s;
+  m_tecplot_binary_index = extensions.Count();
+  CRhinoFileType ft3(PlugInID(), RHSTR(L"Tecplot Binary Files (*.plt)"), L"plt");
+  extensions.Append(ft3);
 }
 
-static const wchar_t* ParseCount(const wchar_t* line, const wchar_t* string, int& count)
-{
-  count = 0;
-  if (nullptr == line || nullptr == string)
-    return nullptr;
-
-  const size_t string_length = wcslen(string);
-  if (string_length <= 0)
-    return nullptr;
-
-  const wchar_t* s = SkipJunk(line);
-  if (nullptr == s)
-    return nullptr;
-
-  if (_wcsnicmp(string, s, string_length))
-    return nullptr;
-
-  s = SkipJunk(s + string_length);
-  s = ParseInt(s, count);
-  if (nullptr == s)
-    count = 0;
-
-  return s;
-}
-
-static const wchar_t* ParseVertex(const wchar_t* line, ON_3dPoint& v, double& c)
+static const char* ParseVertex(const char* line, const char* end, ON_3dPoint& v, double& c)
 {
   double x = ON_UNSET_VALUE, y = ON_UNSET_VALUE, z = ON_UNSET_VALUE, a = ON_UNSET_VALUE;
-  line = SkipAlphaJunk(line);
-  line = ParseDouble(line, x);
-  line = SkipAlphaJunk(line);
-  line = ParseDouble(line, y);
-  line = SkipAlphaJunk(line);
-  line = ParseDouble(line, z);
-  line = SkipAlphaJunk(line);
-  line = ParseDouble(line, a);
+  line = CAnalysisTextParser::SkipAlphaJunk(line, end);
+  line = CAnalysisTextParser::ParseDouble(line, end, x);
+  line = CAnalysisTextParser::SkipAlphaJunk(line, end);
+  line = CAnalysisTextParser::ParseDouble(line, end, y);
+  line = CAnalysisTextParser::SkipAlphaJunk(line, end);
+  line = CAnalysisTextParser::ParseDouble(line, end, z);
+  line = CAnalysisTextParser::SkipAlphaJunk(line, end);
+  line = CAnalysisTextParser::ParseDouble(line, end, a);
   if (line)
   {
     if (ON_IsValid(x) && ON_IsValid(y) && ON_IsValid(z) && ON_IsValid(a))
@@ -327,19 +167,19 @@ static const wchar_t* ParseVertex(const wchar_t* line, ON_3dPoint& v, double& c)
   return line;
 }
 
-static const wchar_t* ParseFace(const wchar_t* line, const int vcount, ON_MeshFace& f)
+static const char* ParseFace(const char* line, const char* end, const int vcount, ON_MeshFace& f)
 {
   int a = -1, b = -1, c = -1, d = -1;
-  line = SkipAlphaJunk(line);
-  line = ParseInt(line, a);
-  line = SkipAlphaJunk(line);
-  line = ParseInt(line, b);
-  line = SkipAlphaJunk(line);
-  line = ParseInt(line, c);
-  line = SkipAlphaJunk(line);
-  if (*line)
+  line = CAnalysisTextParser::SkipAlphaJunk(line, end);
+  line = CAnalysisTextParser::ParseInt(line, end, a);
+  line = CAnalysisTextParser::SkipAlphaJunk(line, end);
+  line = CAnalysisTextParser::ParseInt(line, end, b);
+  line = CAnalysisTextParser::SkipAlphaJunk(line, end);
+  line = CAnalysisTextParser::ParseInt(line, end, c);
+  line = CAnalysisTextParser::SkipAlphaJunk(line, end);
+  if (line && line < end)
   {
-    line = ParseInt(line, d);
+    line = CAnalysisTextParser::ParseInt(line, end, d);
   }
   else
     d = c;
@@ -363,241 +203,117 @@ static const wchar_t* ParseFace(const wchar_t* line, const int vcount, ON_MeshFa
   return line;
 }
 
-/////////////////////////////////////////////////////////////////////////////
-
-class TP_POINT
-{
-public:
-  int i, j, k;
-  int vindex;
-  ON_3dPoint v;
-  double a;
-};
-
-class TP_GRID
-{
-public:
-  TP_GRID(int im, int jm, int km) : IMAX(im), JMAX(jm), KMAX(km), tp(IMAX*JMAX*KMAX) {};
-  int IMAX;
-  int JMAX;
-  int KMAX;
-  ON_SimpleArray<TP_POINT> tp;
-  int Index(int i, int j, int k) { return (i + (j + k * JMAX)*IMAX); }
-  TP_POINT& Point(int i, int j, int k) { return tp[(i + (j + k * JMAX)*IMAX)]; }
-};
-
-/////////////////////////////////////////////////////////////////////////////
-
-ON_Mesh* CAnalysisToolsPlugIn::ReadStructuredTechPlotFile(FILE* fp, ON_Mesh* mesh)
+// Parses the vertex and face lines in [s, end). Lines are numbered from
+// the first vertex line; first_line is the number of the line at s.
+// Returns the number of the first line that failed to parse, or -1.
+static int ParseFalseColorMeshLines(const char* s, const char* end, int first_line, const int vcount, const int fcount, ON_3dPoint* v, double* a, ON_MeshFace* f)
 {
-  if (mesh)
-    mesh->Destroy();
-
-  wchar_t line[129];
-  wmemset(line, 0, 129);
-
-  int IMAX = 0;
-  int JMAX = 0;
-  int KMAX = 0;
-  const wchar_t* s = nullptr;
-
-  while (IMAX <= 0)
-  {
-    while (nullptr == s || *s == 0)
-    {
-      s = fgetws(line, 127, fp);
-      if (nullptr == s)
-        return nullptr;
-    }
-    s = ParseCount(s, L"I=", IMAX);
-  }
-
-  while (JMAX <= 0)
-  {
-    while (nullptr == s || *s == 0)
-    {
-      s = fgetws(line, 127, fp);
-      if (nullptr == s)
-        return nullptr;
-    }
-    s = ParseCount(s, L"J=", JMAX);
-  }
-
-  while (KMAX <= 0)
+  const char* line = nullptr;
+  const char* line_end = nullptr;
+  for (int i = first_line; i < vcount + fcount; i++)
   {
-    while (nullptr == s || *s == 0)
-    {
-      s = fgetws(line, 127, fp);
-      if (nullptr == s)
-        return nullptr;
-    }
-    s = ParseCount(s, L"K=", KMAX);
-  }
-
-  s = fgetws(line, 127, fp);
-  s = fgetws(line, 127, fp);
+    if (!CAnalysisTextParser::GetLine(s, end, line, line_end))
+      break;
 
-  TP_POINT p;
-  TP_GRID grid(IMAX, JMAX, KMAX);
-  int i, j, k;
-  for (k = 0; k < KMAX && s; k++)
-  {
-    for (j = 0; j < JMAX && s; j++)
+    if (i < vcount)
     {
-      for (i = 0; i < IMAX && s; i++)
-      {
-        s = fgetws(line, 127, fp);
-        s = SkipJunk(s);
-        s = ParseDouble(s, p.v.x);
-        s = SkipJunk(s);
-        s = ParseDouble(s, p.v.y);
-        s = SkipJunk(s);
-        s = ParseDouble(s, p.v.z);
-        s = SkipJunk(s);
-        s = ParseDouble(s, p.a);
-        if (s)
-        {
-          p.i = i; p.j = j; p.k = k; p.vindex = -1;
-          grid.tp.Append(p);
-        }
-      }
+      if (!ParseVertex(line, line_end, v[i], a[i]))
+        return i;
     }
-  }
-
-  if (grid.tp.Count() == IMAX * JMAX * KMAX)
-  {
-    if (nullptr == mesh)
-      mesh = new ON_Mesh();
-
-    CAnalysisUserData* ud = new CAnalysisUserData();
-    double mn = 1.0e300;
-    double mx = -mn;
-    TP_POINT tp00, tp01, tp10, tp11;
-    ON_MeshFace f;
-
-    for (k = 0; k < KMAX && s; k++) for (j = 0; j < JMAX && s; j++) for (i = 0; i < IMAX && s; i++)
+    else
     {
-      grid.Point(i, j, k).vindex = mesh->m_V.Count();
-      tp11 = grid.Point(i, j, k);
-      ud->m_a.Append(tp11.a);
-      mesh->m_V.Append(ON_3fPoint(tp11.v));
-      if (tp11.a < mn)
-        mn = tp11.a;
-      if (tp11.a > mx)
-        mx = tp11.a;
-      if (i > 0)
-      {
-        if (j > 0)
-        {
-          tp00 = grid.Point(i - 1, j - 1, k);
-          tp10 = grid.Point(i, j - 1, k);
-          tp01 = grid.Point(i - 1, j, k);
-          f.vi[0] = tp00.vindex;
-          f.vi[1] = tp10.vindex;
-          f.vi[2] = tp11.vindex;
-          f.vi[3] = tp01.vindex;
-          mesh->m_F.Append(f);
-          if (k > 0)
-          {
-            tp11 = grid.Point(i, j, k);
-            tp01 = grid.Point(i, j - 1, k);
-            tp00 = grid.Point(i, j - 1, k - 1);
-            tp10 = grid.Point(i, j, k - 1);
-            f.vi[0] = tp00.vindex;
-            f.vi[1] = tp10.vindex;
-            f.vi[2] = tp11.vindex;
-            f.vi[3] = tp01.vindex;
-            mesh->m_F.Append(f);
-
-            tp11 = grid.Point(i, j, k);
-            tp01 = grid.Point(i - 1, j, k);
-            tp00 = grid.Point(i - 1, j, k - 1);
-            tp10 = grid.Point(i, j, k - 1);
-            f.vi[0] = tp00.vindex;
-            f.vi[1] = tp10.vindex;
-            f.vi[2] = tp11.vindex;
-            f.vi[3] = tp01.vindex;
-            mesh->m_F.Append(f);
-
-          }
-        }
-        else if (k > 0)
-        {
-          tp00 = grid.Point(i - 1, j, k - 1);
-          tp10 = grid.Point(i, j, k - 1);
-          tp01 = grid.Point(i - 1, j, k);
-          f.vi[0] = tp00.vindex;
-          f.vi[1] = tp10.vindex;
-          f.vi[2] = tp11.vindex;
-          f.vi[3] = tp01.vindex;
-          mesh->m_F.Append(f);
-        }
-      }
-      else if (j > 0)
-      {
-        if (k > 0)
-        {
-          const TP_POINT tp00 = grid.Point(i, j - 1, k - 1);
-          const TP_POINT tp10 = grid.Point(i, j, k - 1);
-          const TP_POINT tp01 = grid.Point(i, j - 1, k);
-          f.vi[0] = tp00.vindex;
-          f.vi[1] = tp10.vindex;
-          f.vi[2] = tp11.vindex;
-          f.vi[3] = tp01.vindex;
-          mesh->m_F.Append(f);
-        }
-      }
+      if (!ParseFace(line, line_end, vcount, f[i - vcount]))
+        return i;
     }
-
-    mesh->ComputeVertexNormals();
-
-    ud->m_minmax.Set(mn, mx);
-    ud->m_redblue.Set(mn, mx);
-    mesh->AttachUserData(ud);
-    CAnalysisUserData::UpdateColors(mesh);
   }
-  else
-    mesh = nullptr;
-
-  return mesh;
+  return -1;
 }
 
-ON_Mesh* CAnalysisToolsPlugIn::ReadFalseColorMeshFile(FILE* fp, ON_Mesh* mesh)
+/////////////////////////////////////////////////////////////////////////////
+
+ON_Mesh* CAnalysisToolsPlugIn::ReadFalseColorMeshFile(const CAnalysisMappedFile& file, ON_wString& error, ON_Mesh* mesh)
 {
-  wchar_t line[129];
-  wmemset(line, 0, 129);
+  const char* cursor = file.Begin();
+  const char* end = file.End();
+  const char* line = nullptr;
+  const char* line_end = nullptr;
+  int header_lines = 0;
 
   int vcount = 0;
   int fcount = 0;
 
-  while (vcount <= 0 && fgetws(line, 127, fp))
-    ParseCount(line, L"vertexcount", vcount);
+  while (vcount <= 0 && CAnalysisTextParser::GetLine(cursor, end, line, line_end))
+  {
+    header_lines++;
+    CAnalysisTextParser::ParseCount(line, line_end, "vertexcount", vcount);
+  }
   if (vcount < 3)
+  {
+    error = RHSTR(L"Missing or invalid vertex count.");
     return nullptr;
+  }
 
-  if (fgetws(line, 127, fp))
-    ParseCount(line, L"facecount", fcount);
+  if (CAnalysisTextParser::GetLine(cursor, end, line, line_end))
+  {
+    header_lines++;
+    CAnalysisTextParser::ParseCount(line, line_end, "facecount", fcount);
+  }
   if (fcount <= 0)
+  {
+    error.Format(RHSTR(L"Missing or invalid face count on line %d."), header_lines);
     return nullptr;
+  }
 
-  ON_SimpleArray<ON_3dPoint> v(vcount);
-  ON_SimpleArray<double> a(vcount);
+  // Split the vertex and face lines into chunks and count the lines in
+  // each chunk, so every chunk knows the number of its first line.
+  ON_SimpleArray<const char*> bounds;
+  const int chunk_count = CAnalysisTextParser::SplitLines(cursor, end, bounds);
 
-  for (int i = 0; i < vcount; i++)
+  ON_SimpleArray<int> first_line(chunk_count + 1);
+  first_line.SetCount(chunk_count + 1);
+  first_line[0] = 0;
+  concurrency::parallel_for(0, chunk_count, [&](int i)
   {
-    if (!fgetws(line, 127, fp))
-      return nullptr;
-    if (!ParseVertex(line, v.AppendNew(), a.AppendNew()))
-      return nullptr;
+    first_line[i + 1] = CAnalysisTextParser::LineCount(bounds[i], bounds[i + 1]);
+  });
+  for (int i = 0; i < chunk_count; i++)
+    first_line[i + 1] += first_line[i];
+
+  if (first_line[chunk_count] < vcount + fcount)
+  {
+    error.Format(RHSTR(L"Unexpected end of file after line %d."), header_lines + first_line[chunk_count]);
+    return nullptr;
   }
 
+  // Every line has a fixed slot, so the chunks are parsed concurrently
+  // straight into their final positions.
+  ON_SimpleArray<ON_3dPoint> v(vcount);
+  v.SetCount(vcount);
+  ON_SimpleArray<double> a(vcount);
+  a.SetCount(vcount);
   ON_SimpleArray<ON_MeshFace> f(fcount);
-  for (int i = 0; i < fcount; i++)
+  f.SetCount(fcount);
+
+  ON_SimpleArray<int> bad_line(chunk_count);
+  bad_line.SetCount(chunk_count);
+  concurrency::parallel_for(0, chunk_count, [&](int i)
   {
-    if (!fgetws(line, 127, fp))
-      return nullptr;
-    if (!ParseFace(line, vcount, f.AppendNew()))
+    bad_line[i] = -1;
+    if (first_line[i] < vcount + fcount)
+      bad_line[i] = ParseFalseColorMeshLines(bounds[i], bounds[i + 1], first_line[i], vcount, fcount, v.Array(), a.Array(), f.Array());
+  });
+
+  // Chunks are in file order, so the first failure found is the first bad line
+  for (int i = 0; i < chunk_count; i++)
+  {
+    if (bad_line[i] >= 0)
+    {
+      if (bad_line[i] < vcount)
+        error.Format(RHSTR(L"Invalid vertex on line %d."), header_lines + bad_line[i] + 1);
+      else
+        error.Format(RHSTR(L"Invalid face on line %d."), header_lines + bad_line[i] + 1);
       return nullptr;
+    }
   }
 
   if (mesh)
@@ -617,22 +333,8 @@ ON_Mesh* CAnalysisToolsPlugIn::ReadFalseColorMeshFile(FILE* fp, ON_Mesh* mesh)
   mesh->ComputeVertexNormals();
 
   CAnalysisUserData* ud = new CAnalysisUserData();
-  ud->m_a = a;
-
-  double mn, mx;
-  mn = mx = a[0];
-
-  for (int i = 1; i < a.Count(); i++)
-  {
-    double x = a[i];
-    if (x < mn)
-      mn = x;
-    else if (x > mx)
-      mx = x;
-  }
-
-  ud->m_minmax.Set(mn, mx);
-  ud->m_redblue.Set(mn, mx);
+  ud->m_a.SetValues(a.Array(), a.Count());
+  ud->ComputeRange(true);
   mesh->AttachUserData(ud);
   CAnalysisUserData::UpdateColors(mesh);
 
@@ -641,15 +343,59 @@ ON_Mesh* CAnalysisToolsPlugIn::ReadFalseColorMeshFile(FILE* fp, ON_Mesh* mesh)
 
 BOOL CAnalysisToolsPlugIn::ReadFile(const wchar_t* filename, int index, CRhinoDoc& doc, const CRhinoFileReadOptions& options)
 {
-  ON_Workspace ws;
   bool rc = false;
 
   bool bBatchMode = (0 != options.Mode(CRhinoFileReadOptions::ModeFlag::BatchMode));
 
   if (filename && filename[0])
   {
-    FILE* fp = ws.OpenFile(filename, L"r");
-    if (nullptr == fp)
+    ON_SimpleArray<ON_Mesh*> meshes;
+    ON_wString error;
+    bool bOpened = false;
+    bool bReadAll = true;
+
+    // Batch imports use the options from the last interactive import
+    if ((index == m_tecplot_index || index == m_tecplot_binary_index) && !bBatchMode)
+    {
+      if (CRhinoCommand::success != m_tecplot_options.GetOptions())
+        return FALSE;
+    }
+
+    if (index == m_tecplot_index)
+    {
+      CTecplotReader reader;
+      bOpened = reader.Open(filename);
+      if (bOpened)
+        bReadAll = reader.ReadZones(meshes, &m_tecplot_options);
+    }
+    else if (index == m_tecplot_binary_index)
+    {
+      CTecplotBinaryReader reader;
+      bOpened = reader.Open(filename);
+      if (bOpened)
+        bReadAll = reader.ReadZones(meshes, &m_tecplot_options);
+    }
+    else
+    {
+      CAnalysisMappedFile file;
+      bOpened = file.Open(filename);
+      if (bOpened)
+      {
+        ON_Mesh* mesh = ReadFalseColorMeshFile(file, error);
+        if (mesh)
+          meshes.Append(mesh);
+      }
+    }
+
+    // The values are normalized into texture coordinates once, and
+    // the vertex colors set while reading are dropped
+    if ((index == m_tecplot_index || index == m_tecplot_binary_index) && m_tecplot_options.m_bTextureColors)
+    {
+      for (int i = 0; i < meshes.Count(); i++)
+        CAnalysisUserData::SetTextureColors(meshes[i], true);
+    }
+
+    if (!bOpened)
     {
       ON_wString msg;
       msg.Format(RHSTR(L"Unable to open file \"%s\""), filename);
@@ -661,16 +407,15 @@ BOOL CAnalysisToolsPlugIn::ReadFile(const wchar_t* filename, int index, CRhinoDo
     }
     else
     {
-      ON_Mesh* mesh = nullptr;
-      if (index == m_tecplot_index)
-        mesh = ReadStructuredTechPlotFile(fp);
-      else
-        mesh = ReadFalseColorMeshFile(fp);
-
-      if (nullptr == mesh)
+      if (0 == meshes.Count())
       {
         ON_wString msg;
         msg.Format(RHSTR(L"Unable to read file \"%s\""), filename);
+        if (error.IsNotEmpty())
+        {
+          msg += L"\n";
+          msg += error;
+        }
         const wchar_t* s = msg.Array();
         if (bBatchMode)
           RhinoApp().Print(L"%s\n", s);
@@ -679,9 +424,24 @@ BOOL CAnalysisToolsPlugIn::ReadFile(const wchar_t* filename, int index, CRhinoDo
       }
       else
       {
-        CRhinoMeshObject* mesh_object = new CRhinoMeshObject();
-        mesh_object->SetMesh(mesh);
-        rc = doc.AddObject(mesh_object);
+        if (!bReadAll)
+          RhinoApp().Print(RHSTR(L"Some zones in \"%s\" could not be read and were skipped.\n"), filename);
+
+        // All of the zones are added as one undoable step, and the
+        // views are redrawn once.
+        const unsigned int undo_record_sn = doc.BeginUndoRecord(RHSTR(L"Import analysis meshes"));
+        for (int i = 0; i < meshes.Count(); i++)
+        {
+          CRhinoMeshObject* mesh_object = new CRhinoMeshObject();
+          mesh_object->SetMesh(meshes[i]);
+          if (doc.AddObject(mesh_object))
+            rc = true;
+          else
+            delete mesh_object;
+        }
+        if (undo_record_sn)
+          doc.EndUndoRecord(undo_record_sn);
+        doc.Regen();
       }
     }
   }
@@ -5,7 +5,12 @@
 
 #pragma once
 
+#include "AnalysisMeshConduit.h"
 #include "AnalysisObject.h"
+#include "AnalysisUpdateWatcher.h"
+#include "TecplotImportOptions.h"
+
+class CAnalysisMappedFile;
 
 // CAnalysisToolsPlugIn
 // See AnalysisToolsPlugIn.cpp for the implementation of this class
@@ -26,20 +31,36 @@ public:
   BOOL OnLoadPlugIn() override;
   void OnUnloadPlugIn() override;
   LPUNKNOWN GetPlugInObjectInterface(const ON_UUID& iid);
+  void LoadProfile(LPCTSTR lpszSection, CRhinoProfileContext& pc) override;
+  void SaveProfile(LPCTSTR lpszSection, CRhinoProfileContext& pc) override;
 
   // File import overrides
   void AddFileType(ON_ClassArray<CRhinoFileType>& extensions, const CRhinoFileReadOptions& options) override;
   BOOL ReadFile(const wchar_t* filename, int index, CRhinoDoc& doc, const CRhinoFileReadOptions& options) override;
 
-private:
-  ON_Mesh* ReadFalseColorMeshFile(FILE* fp, ON_Mesh* mesh = nullptr);
-  ON_Mesh* ReadStructuredTechPlotFile(FILE* fp, ON_Mesh* mesh = nullptr);
+  /*
+  Description:
+    Reads a Rhino analysis mesh (.ram) file.
+  Parameters:
+    file  - [in] the mapped file.
+    error - [out] if the file cannot be read, the reason and the
+                  number of the line that failed.
+    mesh  - [in] if not null, the mesh to read into.
+  Returns:
+    The mesh with its analysis data, or nullptr if the file could
+    not be read.
+  */
+  static ON_Mesh* ReadFalseColorMeshFile(const CAnalysisMappedFile& file, ON_wString& error, ON_Mesh* mesh = nullptr);
 
 private:
   ON_wString m_plugin_version;
   int m_false_color_index;
   int m_tecplot_index;
+  int m_tecplot_binary_index;
+  CTecplotImportOptions m_tecplot_options;
   CAnalysisObject m_object;
+  CAnalysisUpdateWatcher m_update_watcher;
+  CAnalysisMeshConduit m_conduit;
 };
 
 // Return a reference to the one and only CAnalysisToolsPlugIn object
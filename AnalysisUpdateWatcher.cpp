@@ -0,0 +1,33 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisUpdateWatcher.cpp
+
+#include "StdAfx.h"
+#include "AnalysisUpdateWatcher.h"
+#include "AnalysisObject.h"
+
+CAnalysisUpdateWatcher::CAnalysisUpdateWatcher(CAnalysisObject& object)
+  : m_object(object)
+{
+}
+
+void CAnalysisUpdateWatcher::OnBeginCommand(const CRhinoCommand& command, const CRhinoCommandContext& context)
+{
+  m_object.CommandStarted();
+}
+
+void CAnalysisUpdateWatcher::OnEndCommand(const CRhinoCommand& command, const CRhinoCommandContext& context, CRhinoCommand::result rc)
+{
+  m_object.CommandEnded();
+}
+
+void CAnalysisUpdateWatcher::OnCloseDocument(CRhinoDoc& doc)
+{
+  m_object.DocumentClosed(doc.RuntimeSerialNumber());
+}
+
+void CAnalysisUpdateWatcher::OnNewDocument(CRhinoDoc& doc)
+{
+  m_object.CancelUpdate();
+}
@@ -0,0 +1,29 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisUpdateWatcher.h
+
+#pragma once
+
+class CAnalysisObject;
+
+// CAnalysisUpdateWatcher
+// Passes the command and document events that end or drop an update
+// a script started with BeginUpdate() on to the scripting object, so
+// a script that fails before EndUpdate() does not leave later scripts
+// deferring their changes.
+//
+
+class CAnalysisUpdateWatcher : public CRhinoEventWatcher
+{
+public:
+  CAnalysisUpdateWatcher(CAnalysisObject& object);
+
+  void OnBeginCommand(const CRhinoCommand& command, const CRhinoCommandContext& context) override;
+  void OnEndCommand(const CRhinoCommand& command, const CRhinoCommandContext& context, CRhinoCommand::result rc) override;
+  void OnCloseDocument(CRhinoDoc& doc) override;
+  void OnNewDocument(CRhinoDoc& doc) override;
+
+private:
+  CAnalysisObject& m_object;
+};
@@ -5,12 +5,16 @@
 
 #include "stdafx.h"
 #include "AnalysisUserData.h"
+#include "AnalysisColorTable.h"
+#include "AnalysisStatistics.h"
+#include "AnalysisTexture.h"
 #include "AnalysisToolsPlugIn.h"
 
 ON_OBJECT_IMPLEMENT(CAnalysisUserData, ON_UserData, "E661F7EE-E478-41e4-9EE1-50FA72AE123D");
 
 CAnalysisUserData::~CAnalysisUserData()
 {
+  SetColoredTable(nullptr);
 }
 
 ON_UUID CAnalysisUserData::Id()
@@ -29,70 +33,531 @@ const CAnalysisUserData* CAnalysisUserData::Get(const ON_Mesh* mesh)
 ON_Color CAnalysisUserData::Color(double a) const
 {
   ON_Color c;
-  double s = 0.0;
-  if (m_redblue[0] == m_redblue[1])
-  {
-    s = m_redblue[0];
-    if (a < s)
-      c.SetRGB(255, 0, 0);
-    else if (a > s)
-      c.SetRGB(0, 0, 255);
-    else
-      c.SetRGB(0, 255, 0);
-  }
-  else
-  {
-    s = m_redblue.NormalizedParameterAt(a);
-    if (s < 0.0)
-      s = 0.0;
-    else if (s > 1.0)
-      s = 1.0;
-    c.SetHSV(s * 4.0 * ON_PI / 3.0, 1.0, 1.0);
-  }
+  CAnalysisColorTable::Get(m_color_map).MapValues(&a, 1, m_redblue, &c);
   return c;
 }
 
+// True if the colors of the mesh were computed with the table, so a
+// range change can recolor just the vertices whose colors change.
+static bool CanRecolor(const CAnalysisUserData* ud, const ON_Mesh* mesh, const CAnalysisColorTable* table)
+{
+  const int vcount = ud->m_a.Count();
+  return table == ud->m_colored_table
+    && vcount == mesh->m_C.Count()
+    && vcount == ud->m_sorted.Count();
+}
+
+// Maps values in either precision to colors
+static void MapValues(const CAnalysisColorTable& table, const CAnalysisValues& values, int start, int count, const ON_Interval& redblue, ON_Color* colors)
+{
+  if (values.FloatArray())
+    table.MapValues(values.FloatArray() + start, count, redblue, colors);
+  else if (values.DoubleArray())
+    table.MapValues(values.DoubleArray() + start, count, redblue, colors);
+}
+
+// Recolors values in either precision
+static int RecolorValues(const CAnalysisColorTable& table, const CAnalysisValues& values, const int* sorted, const ON_Interval& old_redblue, const ON_Interval& new_redblue, ON_Color* colors)
+{
+  if (values.FloatArray())
+    return table.RecolorValues(values.FloatArray(), sorted, values.Count(), old_redblue, new_redblue, colors);
+  if (values.DoubleArray())
+    return table.RecolorValues(values.DoubleArray(), sorted, values.Count(), old_redblue, new_redblue, colors);
+  return 0;
+}
+
+// Normalizes the values of a mesh with texture colors into its
+// texture coordinates. The vertex colors are not used.
+static bool SetTextureCoordinates(CAnalysisUserData* ud, ON_Mesh* mesh)
+{
+  mesh->m_C.Destroy();
+  ud->m_texture_minmax = ud->m_minmax;
+  const CAnalysisValues& a = ud->m_a;
+  if (a.FloatArray())
+    return CAnalysisTexture::SetTextureCoordinates(mesh, a.FloatArray(), a.Count(), ud->m_minmax);
+  return CAnalysisTexture::SetTextureCoordinates(mesh, a.DoubleArray(), a.Count(), ud->m_minmax);
+}
+
 bool CAnalysisUserData::UpdateColors(ON_Mesh* mesh)
 {
   bool rc = false;
-  const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh);
+  CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
   if (ud)
   {
-    ON_Color c;
-    int i;
+    // Values that cannot be decoded are dropped, and the colors are
+    // left as they are
+    const bool bUnpacked = ud->m_a.Unpack();
     const int vcount = ud->m_a.Count();
-    if (vcount == mesh->m_V.Count())
+    if (bUnpacked && vcount == mesh->m_V.Count())
     {
       rc = true;
-      mesh->m_C.SetCount(0);
-      mesh->m_C.Reserve(vcount);
-      for (i = 0; i < vcount; i++)
+      if (ud->m_bTextureColors)
+      {
+        // The range and color map are applied when the mesh is drawn
+        if (!ud->HasTextureColors(mesh))
+          SetTextureCoordinates(ud, mesh);
+        ud->SetColoredTable(&CAnalysisColorTable::Get(ud->m_color_map));
+        return rc;
+      }
+
+      const CAnalysisColorTable& table = CAnalysisColorTable::Get(ud->m_color_map);
+      if (CanRecolor(ud, mesh, &table))
+      {
+        RecolorValues(table, ud->m_a, ud->m_sorted.Array(), ud->m_colored_redblue, ud->m_redblue, mesh->m_C.Array());
+      }
+      else
       {
-        c = ud->Color(ud->m_a[i]);
-        mesh->m_C.Append(c);
+        mesh->m_C.SetCapacity(vcount);
+        mesh->m_C.SetCount(vcount);
+        MapValues(table, ud->m_a, 0, vcount, ud->m_redblue, mesh->m_C.Array());
       }
+      ud->SetColoredTable(&table);
+      ud->m_colored_redblue = ud->m_redblue;
     }
   }
   return rc;
 }
 
+bool CAnalysisUserData::SetTextureColors(ON_Mesh* mesh, bool bTextureColors)
+{
+  CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
+  if (nullptr == ud)
+    return false;
+
+  if (ud->m_bTextureColors != bTextureColors)
+  {
+    ud->m_bTextureColors = bTextureColors;
+    ud->m_texture_minmax = ON_Interval::EmptyInterval;
+    ud->SetColoredTable(nullptr);
+    ud->m_sorted.Destroy();
+    mesh->m_T.Destroy();
+  }
+
+  return UpdateColors(mesh);
+}
+
+bool CAnalysisUserData::HasTextureColors(const ON_Mesh* mesh) const
+{
+  return m_bTextureColors
+    && nullptr != mesh
+    && m_a.Count() == mesh->m_T.Count()
+    && m_texture_minmax.IsValid();
+}
+
+bool CAnalysisUserData::ComputeRange(bool bResetRedBlue)
+{
+  ValuesChanged();
+
+  // The values are only read, so values shared with a copy stay shared
+  const CAnalysisValues& a = m_a;
+  CAnalysisStatistics stats;
+  const bool rc = a.FloatArray()
+    ? stats.Compute(a.FloatArray(), a.Count())
+    : stats.Compute(a.DoubleArray(), a.Count());
+  if (rc)
+    m_minmax.Set(stats.m_min, stats.m_max);
+  else
+    m_minmax.Set(0.0, 0.0);
+  if (bResetRedBlue)
+    m_redblue = m_minmax;
+  return rc;
+}
+
+// Sorts the indices of values in increasing order, NaN values first
+template <class T>
+static void SortIndices(const T* a, int* sorted, int count)
+{
+  concurrency::parallel_sort(sorted, sorted + count, [a](int i, int j)
+  {
+    if (a[i] != a[i])
+      return a[j] == a[j];
+    return a[i] < a[j];
+  });
+}
+
+void CAnalysisUserData::SortValues()
+{
+  const int count = m_a.Count();
+  m_sorted.SetCapacity(count);
+  m_sorted.SetCount(count);
+  for (int i = 0; i < count; i++)
+    m_sorted[i] = i;
+
+  const CAnalysisValues& a = m_a;
+  if (a.FloatArray())
+    SortIndices(a.FloatArray(), m_sorted.Array(), count);
+  else
+    SortIndices(a.DoubleArray(), m_sorted.Array(), count);
+}
+
+void CAnalysisUserData::SetColoredTable(const CAnalysisColorTable* table)
+{
+  if (table == m_colored_table)
+    return;
+  CAnalysisColorTable::AddRef(table);
+  CAnalysisColorTable::Release(m_colored_table);
+  m_colored_table = table;
+}
+
+void CAnalysisUserData::ValuesChanged()
+{
+  m_sorted.Destroy();
+  SetColoredTable(nullptr);
+  m_colored_redblue = ON_Interval::EmptyInterval;
+  m_texture_minmax = ON_Interval::EmptyInterval;
+}
+
+int CAnalysisUserData::UpdateColors(const ON_SimpleArray<ON_Mesh*>& meshes, bool bSortValues)
+{
+  // Vertices colored by one task
+  const int block_size = 65536;
+
+  // The color arrays are sized first, so the blocks can be filled
+  // in any order. Meshes whose range changed are recolored whole,
+  // by one task each.
+  class CColorBlock
+  {
+  public:
+    const CAnalysisUserData* m_ud;
+    const CAnalysisColorTable* m_table;
+    ON_Mesh* m_mesh;
+    int m_start;
+    int m_count;
+    ON_Interval m_old_redblue;
+  };
+  ON_SimpleArray<CColorBlock> blocks(meshes.Count());
+  ON_SimpleArray<CColorBlock> recolors(meshes.Count());
+  ON_SimpleArray<ON_Mesh*> textures;
+
+  int mesh_count = 0;
+  for (int i = 0; i < meshes.Count(); i++)
+  {
+    ON_Mesh* mesh = meshes[i];
+    CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
+    if (nullptr == ud)
+      continue;
+
+    // Several tasks can use one mesh's values, and copied meshes share
+    // their values, so the values are decoded first. Values that cannot
+    // be decoded are dropped, and the colors are left as they are.
+    if (!ud->m_a.Unpack())
+      continue;
+
+    const int vcount = ud->m_a.Count();
+    if (vcount != mesh->m_V.Count())
+      continue;
+
+    // Meshes with texture colors only change when their values do
+    if (ud->m_bTextureColors)
+    {
+      if (!ud->HasTextureColors(mesh))
+      {
+        textures.Append(mesh);
+        mesh_count++;
+      }
+      ud->SetColoredTable(&CAnalysisColorTable::Get(ud->m_color_map));
+      continue;
+    }
+
+    mesh_count++;
+
+    if (bSortValues && vcount != ud->m_sorted.Count())
+      ud->SortValues();
+
+    const CAnalysisColorTable* table = &CAnalysisColorTable::Get(ud->m_color_map);
+    if (CanRecolor(ud, mesh, table))
+    {
+      CColorBlock& recolor = recolors.AppendNew();
+      recolor.m_ud = ud;
+      recolor.m_table = table;
+      recolor.m_mesh = mesh;
+      recolor.m_start = 0;
+      recolor.m_count = vcount;
+      recolor.m_old_redblue = ud->m_colored_redblue;
+    }
+    else
+    {
+      mesh->m_C.SetCapacity(vcount);
+      mesh->m_C.SetCount(vcount);
+
+      for (int start = 0; start < vcount; start += block_size)
+      {
+        CColorBlock& block = blocks.AppendNew();
+        block.m_ud = ud;
+        block.m_table = table;
+        block.m_mesh = mesh;
+        block.m_start = start;
+        block.m_count = (vcount - start < block_size) ? vcount - start : block_size;
+      }
+    }
+
+    ud->SetColoredTable(table);
+    ud->m_colored_redblue = ud->m_redblue;
+  }
+
+  concurrency::parallel_for(0, blocks.Count(), [&](int i)
+  {
+    const CColorBlock& block = blocks[i];
+    MapValues(*block.m_table, block.m_ud->m_a, block.m_start, block.m_count, block.m_ud->m_redblue, block.m_mesh->m_C.Array() + block.m_start);
+  });
+
+  concurrency::parallel_for(0, recolors.Count(), [&](int i)
+  {
+    const CColorBlock& recolor = recolors[i];
+    RecolorValues(*recolor.m_table, recolor.m_ud->m_a, recolor.m_ud->m_sorted.Array(), recolor.m_old_redblue, recolor.m_ud->m_redblue, recolor.m_mesh->m_C.Array());
+  });
+
+  concurrency::parallel_for(0, textures.Count(), [&](int i)
+  {
+    ON_Mesh* mesh = textures[i];
+    SetTextureCoordinates(const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh)), mesh);
+  });
+
+  return mesh_count;
+}
+
+void CAnalysisUserData::CreateChannels(const ON_wString* names, int channel_count, int vertex_count, CAnalysisValues::precision precision)
+{
+  if (nullptr == names || channel_count < 0)
+    channel_count = 0;
+  if (vertex_count < 0)
+    vertex_count = 0;
+
+  m_channel_names.Empty();
+  m_channel_names.Reserve(channel_count);
+  for (int i = 0; i < channel_count; i++)
+    m_channel_names.Append(names[i]);
+  m_active_channel = 0;
+
+  m_a.Destroy();
+  m_a.SetPrecision(precision);
+  m_a.SetCount(vertex_count);
+
+  const int column_count = (channel_count > 1) ? channel_count - 1 : 0;
+  m_channels.Empty();
+  m_channels.Reserve(column_count);
+  for (int i = 0; i < column_count; i++)
+  {
+    CAnalysisValues& column = m_channels.AppendNew();
+    column.SetPrecision(precision);
+    column.SetCount(vertex_count);
+  }
+}
+
+int CAnalysisUserData::ChannelCount() const
+{
+  return m_channel_names.Count();
+}
+
+const wchar_t* CAnalysisUserData::ChannelName(int channel) const
+{
+  if (channel < 0 || channel >= m_channel_names.Count())
+    return nullptr;
+  return static_cast<const wchar_t*>(m_channel_names[channel]);
+}
+
+int CAnalysisUserData::FindChannel(const wchar_t* name) const
+{
+  if (nullptr == name)
+    return -1;
+  for (int i = 0; i < m_channel_names.Count(); i++)
+  {
+    if (m_channel_names[i].EqualOrdinal(name, true))
+      return i;
+  }
+  return -1;
+}
+
+// True if m_channels[] has an array of m_a.Count() values in the
+// precision of m_a[] for every channel but the active one.
+static bool ChannelsMatch(const CAnalysisUserData& ud)
+{
+  const int channel_count = ud.m_channel_names.Count();
+  if (0 == channel_count)
+    return 0 == ud.m_channels.Count();
+  if (ud.m_active_channel < 0 || ud.m_active_channel >= channel_count || ud.m_channels.Count() != channel_count - 1)
+    return false;
+  for (int i = 0; i < ud.m_channels.Count(); i++)
+  {
+    if (ud.m_channels[i].Count() != ud.m_a.Count() || ud.m_channels[i].Precision() != ud.m_a.Precision())
+      return false;
+  }
+  return true;
+}
+
+// Gets the array that holds the values of a channel, or nullptr if the
+// index is not valid.
+static const CAnalysisValues* ChannelColumn(const CAnalysisUserData& ud, int channel)
+{
+  const int channel_count = ud.m_channel_names.Count();
+  if (channel == ud.m_active_channel || (0 == channel_count && 0 == channel))
+    return &ud.m_a;
+  if (channel < 0 || channel >= channel_count || ud.m_channels.Count() != channel_count - 1)
+    return nullptr;
+
+  // The active channel has no column
+  const int column = (channel < ud.m_active_channel) ? channel : channel - 1;
+  return &ud.m_channels[column];
+}
+
+double* CAnalysisUserData::ChannelValues(int channel)
+{
+  // The non-const array, so values shared with a copy are copied
+  CAnalysisValues* values = const_cast<CAnalysisValues*>(ChannelColumn(*this, channel));
+  return (nullptr == values) ? nullptr : values->DoubleArray();
+}
+
+const double* CAnalysisUserData::ChannelValues(int channel) const
+{
+  const CAnalysisValues* values = ChannelColumn(*this, channel);
+  return (nullptr == values) ? nullptr : values->DoubleArray();
+}
+
+float* CAnalysisUserData::ChannelFloatValues(int channel)
+{
+  CAnalysisValues* values = const_cast<CAnalysisValues*>(ChannelColumn(*this, channel));
+  return (nullptr == values) ? nullptr : values->FloatArray();
+}
+
+const float* CAnalysisUserData::ChannelFloatValues(int channel) const
+{
+  const CAnalysisValues* values = ChannelColumn(*this, channel);
+  return (nullptr == values) ? nullptr : values->FloatArray();
+}
+
+bool CAnalysisUserData::GetChannelValues(int channel, double* values) const
+{
+  const CAnalysisValues* column = ChannelColumn(*this, channel);
+  if (nullptr == column || nullptr == values || column->Count() != m_a.Count())
+    return false;
+  column->GetValues(0, m_a.Count(), values);
+  return true;
+}
+
+bool CAnalysisUserData::SetChannelValues(int channel, const double* values)
+{
+  CAnalysisValues* column = const_cast<CAnalysisValues*>(ChannelColumn(*this, channel));
+  if (nullptr == column || nullptr == values || column->Count() != m_a.Count())
+    return false;
+  column->SetValues(0, m_a.Count(), values);
+  return true;
+}
+
+void CAnalysisUserData::SetPrecision(CAnalysisValues::precision precision)
+{
+  bool bChanged = (precision != m_a.Precision());
+  m_a.SetPrecision(precision);
+  for (int i = 0; i < m_channels.Count(); i++)
+  {
+    if (precision != m_channels[i].Precision())
+    {
+      m_channels[i].SetPrecision(precision);
+      bChanged = true;
+    }
+  }
+  if (bChanged)
+    ValuesChanged();
+}
+
+bool CAnalysisUserData::SetActiveChannel(int channel)
+{
+  const int channel_count = m_channel_names.Count();
+  const int count = m_a.Count();
+  if (channel < 0 || channel >= channel_count)
+    return false;
+  if (!ChannelsMatch(*this))
+    return false;
+  if (channel == m_active_channel)
+    return true;
+
+  // The columns between the old and the new active channel move over
+  // by one, and the old active channel's values take the free column.
+  // Swapping passes the arrays along without touching the values.
+  int i;
+  if (channel > m_active_channel)
+  {
+    for (i = m_active_channel; i < channel; i++)
+      m_a.Swap(m_channels[i]);
+  }
+  else
+  {
+    for (i = m_active_channel - 1; i >= channel; i--)
+      m_a.Swap(m_channels[i]);
+  }
+
+  m_active_channel = channel;
+
+  if (count > 0)
+    ComputeRange(true);
+
+  return true;
+}
+
+bool CAnalysisUserData::SetFrame(int frame)
+{
+  const int count = m_a.Count();
+  const int channel_count = (m_channel_names.Count() > 0) ? m_channel_names.Count() : 1;
+  if (m_frames.ChannelCount() != channel_count)
+    return false;
+
+  ON_SimpleArray<double> values;
+  if (!m_frames.GetFrameValues(frame, count, values))
+    return false;
+
+  for (int c = 0; c < channel_count; c++)
+  {
+    if (!SetChannelValues(c, values.Array() + (size_t)c * count))
+      return false;
+  }
+
+  m_frames.m_current_frame = frame;
+
+  if (count > 0)
+    ComputeRange(false);
+
+  return true;
+}
+
 CAnalysisUserData::CAnalysisUserData()
+  : m_active_channel(0)
+  , m_bTextureColors(false)
+  , m_tolerance(0.0)
+  , m_zone_index(-1)
+  , m_zone_type(-1)
+  , m_colored_table(nullptr)
 {
   m_userdata_uuid = CAnalysisUserData::Id();
   m_application_uuid = AnalysisToolsPlugIn().PlugInID();
 
   m_userdata_copycount = 1;
+
+  m_zone_size[0] = m_zone_size[1] = m_zone_size[2] = 0;
 }
 
 CAnalysisUserData::CAnalysisUserData(const CAnalysisUserData& src)
   : ON_UserData(src)
+  , m_colored_table(nullptr)
 {
   m_userdata_uuid = CAnalysisUserData::Id();
   m_application_uuid = AnalysisToolsPlugIn().PlugInID();
 
   m_a = src.m_a;
+  m_channel_names = src.m_channel_names;
+  m_active_channel = src.m_active_channel;
+  m_channels = src.m_channels;
   m_minmax = src.m_minmax;
   m_redblue = src.m_redblue;
+  m_color_map = src.m_color_map;
+  m_bTextureColors = src.m_bTextureColors;
+  m_texture_minmax = src.m_texture_minmax;
+  m_tolerance = src.m_tolerance;
+  m_zone_index = src.m_zone_index;
+  m_zone_type = src.m_zone_type;
+  m_zone_size[0] = src.m_zone_size[0];
+  m_zone_size[1] = src.m_zone_size[1];
+  m_zone_size[2] = src.m_zone_size[2];
+  m_zone_title = src.m_zone_title;
+  m_frames = src.m_frames;
 }
 
 CAnalysisUserData& CAnalysisUserData::operator=(const CAnalysisUserData& src)
@@ -104,8 +569,25 @@ CAnalysisUserData& CAnalysisUserData::operator=(const CAnalysisUserData& src)
     m_userdata_uuid = saved_uuid;
 
     m_a = src.m_a;
+    m_channel_names = src.m_channel_names;
+    m_active_channel = src.m_active_channel;
+    m_channels = src.m_channels;
     m_minmax = src.m_minmax;
     m_redblue = src.m_redblue;
+    m_color_map = src.m_color_map;
+    m_bTextureColors = src.m_bTextureColors;
+    m_texture_minmax = src.m_texture_minmax;
+    m_tolerance = src.m_tolerance;
+    m_zone_index = src.m_zone_index;
+    m_zone_type = src.m_zone_type;
+    m_zone_size[0] = src.m_zone_size[0];
+    m_zone_size[1] = src.m_zone_size[1];
+    m_zone_size[2] = src.m_zone_size[2];
+    m_zone_title = src.m_zone_title;
+    m_frames = src.m_frames;
+    m_sorted.Destroy();
+    SetColoredTable(nullptr);
+    m_colored_redblue = ON_Interval::EmptyInterval;
   }
   return *this;
 }
@@ -124,18 +606,23 @@ bool CAnalysisUserData::Archive() const
 bool CAnalysisUserData::Write(ON_BinaryArchive& archive) const
 {
   int major_version = 1;
-  int minor_version = 0;
+  int minor_version = 1;
 
   bool rc = archive.BeginWrite3dmChunk(TCODE_ANONYMOUS_CHUNK, major_version, minor_version);
   if (!rc)
     return false;
 
+  // The values are written compressed with the 1.1 fields. The 1.0
+  // values are left empty, so 1.0 plug-ins read a mesh without values
+  // and keep its colors.
+  const ON_SimpleArray<double> no_values;
+
   // Write class members
   for (;;)
   {
     // version 1.0 fields
 
-    rc = archive.WriteArray(m_a);
+    rc = archive.WriteArray(no_values);
     if (!rc) break;
 
     rc = archive.WriteInterval(m_minmax);
@@ -144,6 +631,55 @@ bool CAnalysisUserData::Write(ON_BinaryArchive& archive) const
     rc = archive.WriteInterval(m_redblue);
     if (!rc) break;
 
+    // version 1.1 fields
+
+    rc = archive.WriteInt(m_zone_index);
+    if (!rc) break;
+
+    rc = archive.WriteInt(m_zone_type);
+    if (!rc) break;
+
+    rc = archive.WriteInt(3, m_zone_size);
+    if (!rc) break;
+
+    rc = archive.WriteString(m_zone_title);
+    if (!rc) break;
+
+    rc = archive.WriteInt(m_active_channel);
+    if (!rc) break;
+
+    rc = archive.WriteInt(m_channel_names.Count());
+    if (!rc) break;
+
+    for (int i = 0; i < m_channel_names.Count() && rc; i++)
+      rc = archive.WriteString(m_channel_names[i]);
+    if (!rc) break;
+
+    rc = m_frames.Write(archive);
+    if (!rc) break;
+
+    rc = m_color_map.Write(archive);
+    if (!rc) break;
+
+    rc = archive.WriteBool(m_bTextureColors);
+    if (!rc) break;
+
+    rc = archive.WriteInterval(m_texture_minmax);
+    if (!rc) break;
+
+    rc = archive.WriteDouble(m_tolerance);
+    if (!rc) break;
+
+    rc = m_a.WriteCompressed(archive, m_tolerance);
+    if (!rc) break;
+
+    rc = archive.WriteInt(m_channels.Count());
+    if (!rc) break;
+
+    for (int i = 0; i < m_channels.Count() && rc; i++)
+      rc = m_channels[i].WriteCompressed(archive, m_tolerance);
+    if (!rc) break;
+
     break;
   }
 
@@ -157,9 +693,21 @@ bool CAnalysisUserData::Write(ON_BinaryArchive& archive) const
 
 bool CAnalysisUserData::Read(ON_BinaryArchive& archive)
 {
-  m_a.SetCount(0);
+  m_a = CAnalysisValues();
+  m_channel_names.Empty();
+  m_active_channel = 0;
+  m_channels.Empty();
   m_minmax.Destroy();
   m_redblue.Destroy();
+  m_color_map = CAnalysisColorMap();
+  m_bTextureColors = false;
+  m_tolerance = 0.0;
+  m_zone_index = -1;
+  m_zone_type = -1;
+  m_zone_size[0] = m_zone_size[1] = m_zone_size[2] = 0;
+  m_zone_title.Empty();
+  m_frames.Empty();
+  ValuesChanged();
 
   int major_version = 0;
   int minor_version = 0;
@@ -176,7 +724,7 @@ bool CAnalysisUserData::Read(ON_BinaryArchive& archive)
 
     // version 1.0 fields
 
-    rc = archive.ReadArray(m_a);
+    rc = m_a.ReadDoubleArray(archive);
     if (!rc) break;
 
     rc = archive.ReadInterval(m_minmax);
@@ -185,9 +733,73 @@ bool CAnalysisUserData::Read(ON_BinaryArchive& archive)
     rc = archive.ReadInterval(m_redblue);
     if (!rc) break;
 
+    if (minor_version < 1) break;
+
+    // version 1.1 fields
+
+    rc = archive.ReadInt(&m_zone_index);
+    if (!rc) break;
+
+    rc = archive.ReadInt(&m_zone_type);
+    if (!rc) break;
+
+    rc = archive.ReadInt(3, m_zone_size);
+    if (!rc) break;
+
+    rc = archive.ReadString(m_zone_title);
+    if (!rc) break;
+
+    rc = archive.ReadInt(&m_active_channel);
+    if (!rc) break;
+
+    int channel_count = 0;
+    rc = archive.ReadInt(&channel_count);
+    if (!rc) break;
+
+    m_channel_names.Reserve(channel_count);
+    for (int i = 0; i < channel_count && rc; i++)
+      rc = archive.ReadString(m_channel_names.AppendNew());
+    if (!rc) break;
+
+    rc = m_frames.Read(archive);
+    if (!rc) break;
+
+    rc = m_color_map.Read(archive);
+    if (!rc) break;
+
+    rc = archive.ReadBool(&m_bTextureColors);
+    if (!rc) break;
+
+    rc = archive.ReadInterval(m_texture_minmax);
+    if (!rc) break;
+
+    rc = archive.ReadDouble(&m_tolerance);
+    if (!rc) break;
+
+    // The values stay compressed until they are used
+    rc = m_a.ReadCompressed(archive);
+    if (!rc) break;
+
+    int column_count = 0;
+    rc = archive.ReadInt(&column_count);
+    if (!rc) break;
+
+    m_channels.Reserve(column_count);
+    for (int i = 0; i < column_count && rc; i++)
+      rc = m_channels.AppendNew().ReadCompressed(archive);
+    if (!rc) break;
+
     break;
   }
 
+  // Drop channels that do not match the values, rather than the data
+  if (!ChannelsMatch(*this))
+  {
+    m_channel_names.Empty();
+    m_active_channel = 0;
+    m_channels.Empty();
+  }
+
   // If BeginRead3dmChunk() returns true, then EndRead3dmChunk()
   // must be called, even if a read operation failed.
   if (!archive.EndRead3dmChunk())
@@ -5,6 +5,10 @@
 
 #pragma once
 
+#include "AnalysisColorMap.h"
+#include "AnalysisTimeSeries.h"
+#include "AnalysisValues.h"
+
 class CAnalysisUserData : public ON_UserData
 {
   ON_OBJECT_DECLARE(CAnalysisUserData);
@@ -42,11 +46,61 @@ public:
     True if successful.  False if the mesh doesn't have
     CAnalysisUserData user data or
     CAnalysisUserData.m_a.Count() is not equal
-    to the mesh's vertex count.
+    to the mesh's vertex count, or the saved values
+    could not be decoded. m_C[] does not change then.
+  Remarks:
+    If only m_redblue changed since the colors were last set and the
+    values have been sorted, see SortValues(), only the vertices
+    whose colors change are recolored. If m_bTextureColors is true,
+    m_C[] is emptied and mesh->m_T[] is set instead, but only when
+    the values changed; see SetTextureColors().
   */
   static
     bool UpdateColors(ON_Mesh*);
 
+  /*
+  Description:
+    Sets the colors of many meshes concurrently. Large meshes are
+    split into blocks of vertices, so the work is spread evenly over
+    the processors. Returns when every mesh is done.
+  Parameters:
+    meshes      - [in] the meshes. Meshes that UpdateColors(ON_Mesh*)
+                       would fail on are skipped.
+    bSortValues - [in] if true, the values of meshes that have not
+                       been sorted are sorted, so later range changes
+                       only recolor the vertices whose colors change.
+                       Use when the range is changed interactively.
+  Returns:
+    The number of meshes whose m_C[] or m_T[] changed, which need a
+    regen. Meshes with texture colors whose values did not change
+    only need a redraw, and are not counted.
+  */
+  static
+    int UpdateColors(const ON_SimpleArray<ON_Mesh*>& meshes, bool bSortValues = false);
+
+  /*
+  Description:
+    Switches a mesh between vertex colors and texture colors. With
+    texture colors, the values are normalized into mesh->m_T[] once,
+    m_C[] is emptied, and the plug-in's display conduit draws the
+    mesh with a texture of the color table, so changes of m_redblue
+    and m_color_map need no work per vertex. See CAnalysisTexture.
+  Parameters:
+    mesh           - [in/out] a mesh with CAnalysisUserData.
+    bTextureColors - [in] true for texture colors, false for m_C[].
+  Returns:
+    True if successful.
+  */
+  static
+    bool SetTextureColors(ON_Mesh* mesh, bool bTextureColors);
+
+  /*
+  Description:
+    True if the mesh is drawn with texture colors, that is
+    m_bTextureColors is true and mesh->m_T[] is current.
+  */
+  bool HasTextureColors(const ON_Mesh* mesh) const;
+
   /*
   Description:
     Calculates the color that corresponds to an analysis parameter.
@@ -57,6 +111,126 @@ public:
   */
   ON_Color Color(double a) const;
 
+  /*
+  Description:
+    Sets m_minmax to the range of the finite values in m_a[]. Call
+    after changing m_a[]; it also calls ValuesChanged().
+  Parameters:
+    bResetRedBlue - [in] if true, m_redblue is set to the range too.
+  Returns:
+    True if successful. False if m_a[] has no finite values, in which
+    case the range is set to 0.
+  */
+  bool ComputeRange(bool bResetRedBlue);
+
+  /*
+  Description:
+    Sorts the vertex indices by value into m_sorted[]. Sorting takes
+    longer than coloring every vertex once, but afterwards a change
+    of m_redblue only recolors the vertices whose colors change.
+  */
+  void SortValues();
+
+  /*
+  Description:
+    Discards m_sorted[] and the record of how the mesh's colors were
+    computed, so the next UpdateColors() recolors every vertex.
+  */
+  void ValuesChanged();
+
+  /*
+  Description:
+    Sets the channel names and sizes m_a[] and m_channels[] to hold
+    one value per vertex for every channel. Channel 0 is active.
+  Parameters:
+    names         - [in] channel names.
+    channel_count - [in] number of channels. If 0, m_a[] is sized and
+                         the mesh has a single, unnamed channel.
+    vertex_count  - [in] number of mesh vertices.
+    precision     - [in] the precision the values are stored in, so
+                         readers can write them without converting.
+  */
+  void CreateChannels(const ON_wString* names, int channel_count, int vertex_count, CAnalysisValues::precision precision = CAnalysisValues::double_precision);
+
+  // Number of named channels, or 0 if m_a[] is the only channel.
+  int ChannelCount() const;
+
+  // Name of a channel, or nullptr if the index is not valid.
+  const wchar_t* ChannelName(int channel) const;
+
+  // Index of the channel with a name, ignoring case, or -1.
+  int FindChannel(const wchar_t* name) const;
+
+  /*
+  Description:
+    Gets the values of a channel, one for each mesh vertex.
+  Parameters:
+    channel - [in] zero based channel index.
+  Returns:
+    m_a[] for the active channel, the channel's array in m_channels[]
+    for the others, or nullptr if the index is not valid or the values
+    are single precision. GetChannelValues() and SetChannelValues()
+    work in either precision.
+  */
+  double* ChannelValues(int channel);
+  const double* ChannelValues(int channel) const;
+
+  // The same as ChannelValues(), for single precision values.
+  float* ChannelFloatValues(int channel);
+  const float* ChannelFloatValues(int channel) const;
+
+  /*
+  Description:
+    Copies the values of a channel out of or into the mesh, converting
+    them to or from the precision they are stored in.
+  Parameters:
+    channel - [in] zero based channel index.
+    values  - [out] or [in] one value for each mesh vertex.
+  Returns:
+    True if successful.
+  */
+  bool GetChannelValues(int channel, double* values) const;
+  bool SetChannelValues(int channel, const double* values);
+
+  /*
+  Description:
+    Sets the precision of the values of every channel, converting
+    them. Single precision halves the memory and saved size of the
+    values, and loses nothing when the values were single precision
+    to begin with. Call ComputeRange() and UpdateColors() afterwards.
+  Parameters:
+    precision - [in] the new precision.
+  */
+  void SetPrecision(CAnalysisValues::precision precision);
+
+  /*
+  Description:
+    Makes a channel the one that drives the colors. The channel's
+    values are swapped into m_a[], and m_minmax and m_redblue are
+    set to their range. Only the arrays are swapped, so values
+    shared with a copy of the mesh stay shared, and values that are
+    still compressed are not decoded. Call UpdateColors() afterwards.
+  Parameters:
+    channel - [in] zero based channel index.
+  Returns:
+    True if successful.
+  */
+  bool SetActiveChannel(int channel);
+
+  /*
+  Description:
+    Shows a frame of a time series. The frame's values replace the
+    values of every channel and m_minmax is set to the range of the
+    active channel. m_redblue is not changed, so the colors of
+    different frames can be compared. Call UpdateColors() afterwards.
+  Parameters:
+    frame - [in] zero based frame index.
+  Returns:
+    True if successful. False if the mesh is not a time series, the
+    index is not valid, or the frame could not be read.
+  */
+  bool SetFrame(int frame);
+
   CAnalysisUserData();
   ~CAnalysisUserData();
   CAnalysisUserData(const CAnalysisUserData&);
@@ -67,15 +241,76 @@ public:
   bool Write(ON_BinaryArchive& archive) const override;
   bool Read(ON_BinaryArchive& archive) override;
 
-  // analysis parameters - one for each mesh vertex
-  ON_SimpleArray<double> m_a;
+  // analysis parameters - one for each mesh vertex.
+  // These are the values of the active channel.
+  // m_a and m_channels always have the same precision.
+  CAnalysisValues m_a;
+
+  // Channel names, such as the Tecplot variables that follow x, y
+  // and z. Empty if m_a[] is the only channel.
+  ON_ClassArray<ON_wString> m_channel_names;
+
+  // Index of the channel whose values are in m_a[].
+  int m_active_channel;
+
+  // The values of the other channels, in channel order, with
+  // m_a.Count() values for each channel. Each channel has its own
+  // array, so channels are swapped in and out of m_a[] without
+  // copying values.
+  ON_ClassArray<CAnalysisValues> m_channels;
 
   // minimum and maximum values in the m_a[] array.
   ON_Interval m_minmax;
 
   // m_redblue[0] is the analysis value that corresponds to red.
   // m_redblue[1] is the analysis value that corresponds to blue.
-  // See the code for CAnalysisUserData::Color()
+  // With other color maps, they correspond to the start and the
+  // end of the map. See the code for CAnalysisUserData::Color()
   // for more details.
   ON_Interval m_redblue;
+
+  // The colors used between m_redblue[0] and m_redblue[1].
+  CAnalysisColorMap m_color_map;
+
+  // If true, the mesh is colored with a texture rather than m_C[].
+  // m_texture_minmax is the range the mesh's m_T[] coordinates were
+  // normalized to, or empty if they are not current.
+  bool m_bTextureColors;
+  ON_Interval m_texture_minmax;
+
+  // The largest error allowed in the values when the mesh is saved.
+  // 0.0 saves them exactly. See CAnalysisValues::WriteCompressed().
+  double m_tolerance;
+
+  // The Tecplot zone the mesh was imported from, so zones can
+  // be filtered after import. m_zone_index is the zero based
+  // zone number in the file, or -1 if the mesh did not come
+  // from a Tecplot zone. m_zone_type is a CTecplotZone::zone_type.
+  // m_zone_size[] is IMAX, JMAX and KMAX for ordered zones, or
+  // the node and element counts for finite element zones.
+  int m_zone_index;
+  int m_zone_type;
+  int m_zone_size[3];
+  ON_wString m_zone_title;
+
+  // The frames of a time series, or empty if the mesh has one set
+  // of values.
+  CAnalysisTimeSeries m_frames;
+
+  // The vertex indices in order of increasing m_a[] value, NaN values
+  // first, or empty if the values have not been sorted. Not saved or
+  // copied; a copy sorts its values again if it needs them sorted.
+  ON_SimpleArray<int> m_sorted;
+
+  // The table the mesh is colored with, and the range its m_C[]
+  // colors were computed with, or nullptr if they are not known. The
+  // table is referenced, so it is kept while the mesh uses it. Not
+  // saved or copied.
+  const class CAnalysisColorTable* m_colored_table;
+  ON_Interval m_colored_redblue;
+
+private:
+  // Sets m_colored_table, referencing the new table and releasing
+  // the old one.
+  void SetColoredTable(const class CAnalysisColorTable* table);
 };
\ No newline at end of file
@@ -0,0 +1,680 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisValues.cpp
+
+#include "stdafx.h"
+#include "AnalysisValues.h"
+
+// How compressed values are coded
+enum value_coding : int
+{
+  exact_coding = 0,    // the bits of each value xor the bits of the one before
+  rounded_coding = 1   // the change in the multiple of the step from the value before,
+                       // with the values that could not be rounded escaped
+};
+
+// Compressed values, as they are read from an archive
+class CAnalysisValues::CPackedValues
+{
+public:
+  CPackedValues()
+    : m_count(0)
+    , m_coding(exact_coding)
+    , m_width(0)
+    , m_step(0.0)
+  {
+  }
+
+  // Number of values, the value_coding, the bytes of each coded value
+  // that are kept, and for rounded values, the step they are rounded to.
+  int m_count;
+  int m_coding;
+  int m_width;
+  double m_step;
+
+  // The shuffled bytes of the coded values, followed for rounded
+  // values by the exact bits of the values that were escaped, deflated
+  ON_CompressedBuffer m_buffer;
+};
+
+// Values shared by copies. Copies are made and destroyed on any
+// thread, so the reference count is interlocked.
+class CAnalysisValues::CValueBuffer
+{
+public:
+  CValueBuffer()
+    : m_ref_count(1)
+    , m_packed(nullptr)
+  {
+  }
+
+  ~CValueBuffer()
+  {
+    delete m_packed;
+  }
+
+  volatile long m_ref_count;
+
+  // Decoding values that are still compressed fills in the arrays
+  CPackedValues* m_packed;
+  ON_SimpleArray<double> m_doubles;
+  ON_SimpleArray<float> m_floats;
+};
+
+CAnalysisValues::CAnalysisValues()
+  : m_precision(double_precision)
+  , m_buffer(nullptr)
+{
+}
+
+CAnalysisValues::~CAnalysisValues()
+{
+  Release();
+}
+
+CAnalysisValues::CAnalysisValues(const CAnalysisValues& src)
+  : m_precision(src.m_precision)
+  , m_buffer(src.m_buffer)
+{
+  if (m_buffer)
+    InterlockedIncrement(&m_buffer->m_ref_count);
+}
+
+CAnalysisValues& CAnalysisValues::operator=(const CAnalysisValues& src)
+{
+  if (m_buffer != src.m_buffer)
+  {
+    if (src.m_buffer)
+      InterlockedIncrement(&src.m_buffer->m_ref_count);
+    Release();
+    m_buffer = src.m_buffer;
+  }
+  m_precision = src.m_precision;
+  return *this;
+}
+
+void CAnalysisValues::Swap(CAnalysisValues& other)
+{
+  CValueBuffer* buffer = m_buffer;
+  m_buffer = other.m_buffer;
+  other.m_buffer = buffer;
+
+  const precision p = m_precision;
+  m_precision = other.m_precision;
+  other.m_precision = p;
+}
+
+void CAnalysisValues::Release()
+{
+  if (m_buffer && 0 == InterlockedDecrement(&m_buffer->m_ref_count))
+    delete m_buffer;
+  m_buffer = nullptr;
+}
+
+CAnalysisValues::CValueBuffer& CAnalysisValues::Edit()
+{
+  Unpack();
+  if (nullptr == m_buffer)
+  {
+    m_buffer = new CValueBuffer();
+  }
+  else if (m_buffer->m_ref_count > 1)
+  {
+    // Another copy uses these values, so they are copied
+    CValueBuffer* buffer = new CValueBuffer();
+    buffer->m_doubles = m_buffer->m_doubles;
+    buffer->m_floats = m_buffer->m_floats;
+    Release();
+    m_buffer = buffer;
+  }
+  return *m_buffer;
+}
+
+CAnalysisValues::precision CAnalysisValues::Precision() const
+{
+  return m_precision;
+}
+
+int CAnalysisValues::Count() const
+{
+  if (nullptr == m_buffer)
+    return 0;
+  if (m_buffer->m_packed)
+    return m_buffer->m_packed->m_count;
+  return (single_precision == m_precision) ? m_buffer->m_floats.Count() : m_buffer->m_doubles.Count();
+}
+
+size_t CAnalysisValues::ValueSize() const
+{
+  return (single_precision == m_precision) ? sizeof(float) : sizeof(double);
+}
+
+void CAnalysisValues::SetPrecision(precision precision)
+{
+  if (precision == m_precision)
+    return;
+
+  if (nullptr == m_buffer)
+  {
+    m_precision = precision;
+    return;
+  }
+
+  CValueBuffer& buffer = Edit();
+  const int count = Count();
+  if (single_precision == precision)
+  {
+    buffer.m_floats.SetCapacity(count);
+    buffer.m_floats.SetCount(count);
+    for (int i = 0; i < count; i++)
+      buffer.m_floats[i] = (float)buffer.m_doubles[i];
+    buffer.m_doubles.Destroy();
+  }
+  else
+  {
+    buffer.m_doubles.SetCapacity(count);
+    buffer.m_doubles.SetCount(count);
+    for (int i = 0; i < count; i++)
+      buffer.m_doubles[i] = buffer.m_floats[i];
+    buffer.m_floats.Destroy();
+  }
+
+  m_precision = precision;
+}
+
+void CAnalysisValues::SetCount(int count)
+{
+  CValueBuffer& buffer = Edit();
+  if (count < 0)
+    count = 0;
+  if (single_precision == m_precision)
+  {
+    buffer.m_floats.Reserve(count);
+    buffer.m_floats.SetCount(count);
+  }
+  else
+  {
+    buffer.m_doubles.Reserve(count);
+    buffer.m_doubles.SetCount(count);
+  }
+}
+
+void CAnalysisValues::Shrink()
+{
+  // Shared values are left as they are
+  if (m_buffer && 1 == m_buffer->m_ref_count)
+  {
+    m_buffer->m_doubles.Shrink();
+    m_buffer->m_floats.Shrink();
+  }
+}
+
+void CAnalysisValues::Destroy()
+{
+  Release();
+}
+
+bool CAnalysisValues::IsPacked() const
+{
+  return m_buffer && m_buffer->m_packed;
+}
+
+bool CAnalysisValues::IsShared() const
+{
+  return m_buffer && m_buffer->m_ref_count > 1;
+}
+
+double CAnalysisValues::operator[](int i) const
+{
+  Unpack();
+  return (single_precision == m_precision) ? (double)m_buffer->m_floats[i] : m_buffer->m_doubles[i];
+}
+
+double* CAnalysisValues::DoubleArray()
+{
+  if (double_precision != m_precision || 0 == Count())
+    return nullptr;
+  return Edit().m_doubles.Array();
+}
+
+const double* CAnalysisValues::DoubleArray() const
+{
+  if (double_precision != m_precision || nullptr == m_buffer)
+    return nullptr;
+  Unpack();
+  return m_buffer->m_doubles.Array();
+}
+
+float* CAnalysisValues::FloatArray()
+{
+  if (single_precision != m_precision || 0 == Count())
+    return nullptr;
+  return Edit().m_floats.Array();
+}
+
+const float* CAnalysisValues::FloatArray() const
+{
+  if (single_precision != m_precision || nullptr == m_buffer)
+    return nullptr;
+  Unpack();
+  return m_buffer->m_floats.Array();
+}
+
+void* CAnalysisValues::Array()
+{
+  if (single_precision == m_precision)
+    return FloatArray();
+  return DoubleArray();
+}
+
+const void* CAnalysisValues::Array() const
+{
+  if (single_precision == m_precision)
+    return FloatArray();
+  return DoubleArray();
+}
+
+void CAnalysisValues::SetValues(const double* values, int count)
+{
+  if (nullptr == values || count < 0)
+    count = 0;
+  Destroy();
+  SetCount(count);
+  SetValues(0, count, values);
+}
+
+void CAnalysisValues::GetValues(int start, int count, double* values) const
+{
+  if (nullptr == values || start < 0 || count <= 0 || start + count > Count())
+    return;
+  Unpack();
+  if (single_precision == m_precision)
+  {
+    const float* src = m_buffer->m_floats.Array() + start;
+    for (int i = 0; i < count; i++)
+      values[i] = src[i];
+  }
+  else
+  {
+    memcpy(values, m_buffer->m_doubles.Array() + start, sizeof(double) * count);
+  }
+}
+
+void CAnalysisValues::SetValues(int start, int count, const double* values)
+{
+  if (nullptr == values || start < 0 || count <= 0 || start + count > Count())
+    return;
+  CValueBuffer& buffer = Edit();
+  if (single_precision == m_precision)
+  {
+    float* dst = buffer.m_floats.Array() + start;
+    for (int i = 0; i < count; i++)
+      dst[i] = (float)values[i];
+  }
+  else
+  {
+    memcpy(buffer.m_doubles.Array() + start, values, sizeof(double) * count);
+  }
+}
+
+void CAnalysisValues::GetValues(ON_SimpleArray<double>& values) const
+{
+  const int count = Count();
+  values.SetCapacity(count);
+  values.SetCount(count);
+  GetValues(0, count, values.Array());
+}
+
+bool CAnalysisValues::ReadDoubleArray(ON_BinaryArchive& archive)
+{
+  Destroy();
+  m_precision = double_precision;
+  return archive.ReadArray(Edit().m_doubles);
+}
+
+// Largest multiple of the step that rounded values are coded with.
+// Doubles hold every integer up to 2^53 exactly.
+static const double max_multiple = 4503599627370496.0; // 2^52
+
+/*
+Description:
+  Codes values exactly. Neighboring analysis values are close, so the
+  sign, exponent and high mantissa bits of a value mostly match those
+  of the value before, and the xor of the two is mostly zeros.
+Parameters:
+  words - [out] count coded values.
+*/
+template <class T, class U>
+static void CodeExact(const T* values, int count, ON__UINT64* words)
+{
+  U previous = 0;
+  for (int i = 0; i < count; i++)
+  {
+    U bits;
+    memcpy(&bits, values + i, sizeof(bits));
+    words[i] = bits ^ previous;
+    previous = bits;
+  }
+}
+
+template <class T, class U>
+static void DecodeExact(const ON__UINT64* words, int count, T* values)
+{
+  U previous = 0;
+  for (int i = 0; i < count; i++)
+  {
+    previous ^= (U)words[i];
+    memcpy(values + i, &previous, sizeof(previous));
+  }
+}
+
+// The coded word of a rounded value that is escaped, all ones in the
+// bytes that are kept. Changes in the multiple are less than 2^53, so
+// with 8 bytes no change codes to it, and with 4 bytes Pack() makes
+// sure none does.
+static ON__UINT64 EscapeWord(int width)
+{
+  return (4 == width) ? 0xFFFFFFFF : ~(ON__UINT64)0;
+}
+
+/*
+Description:
+  Codes values rounded to multiples of a step. Each value is coded as
+  the change in its multiple from the value before, zigzag coded so
+  small changes of either sign have only low bits. Values that are
+  not finite, or too large to round, are escaped: their word is all
+  ones and their exact bits are kept separately, and the next value
+  is coded from the last one that was not escaped.
+Parameters:
+  words    - [out] count coded values.
+  escapes  - [out] the values that were escaped, in order.
+  max_word - [out] the largest coded value that was not escaped.
+*/
+template <class T>
+static void CodeRounded(const T* values, int count, double step, ON__UINT64* words, ON_SimpleArray<T>& escapes, ON__UINT64& max_word)
+{
+  max_word = 0;
+  ON__INT64 previous = 0;
+  for (int i = 0; i < count; i++)
+  {
+    const double multiple = floor((double)values[i] / step + 0.5);
+    if (!(fabs(multiple) <= max_multiple))
+    {
+      words[i] = EscapeWord(8);
+      escapes.Append(values[i]);
+      continue;
+    }
+    const ON__INT64 m = (ON__INT64)multiple;
+    const ON__INT64 delta = m - previous;
+    previous = m;
+    words[i] = ((ON__UINT64)delta << 1) ^ (ON__UINT64)(delta >> 63);
+    if (words[i] > max_word)
+      max_word = words[i];
+  }
+}
+
+/*
+Description:
+  Decodes values coded by CodeRounded().
+Parameters:
+  width        - [in] bytes of each word that were kept.
+  escapes      - [in] the exact bits of the escaped values.
+  escape_count - [in] number of escaped values. If 0, no value was
+                      escaped, as in values written before escapes.
+Returns:
+  False if the number of escaped words is not escape_count.
+*/
+template <class T>
+static bool DecodeRounded(const ON__UINT64* words, int count, int width, double step, const unsigned char* escapes, int escape_count, T* values)
+{
+  const ON__UINT64 escape_word = EscapeWord(width);
+  int escape_index = 0;
+  ON__INT64 previous = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (escape_count > 0 && escape_word == words[i])
+    {
+      if (escape_index >= escape_count)
+        return false;
+      memcpy(values + i, escapes + sizeof(T) * escape_index++, sizeof(T));
+      continue;
+    }
+    const ON__INT64 delta = (ON__INT64)(words[i] >> 1) ^ -(ON__INT64)(words[i] & 1);
+    previous += delta;
+    values[i] = (T)((double)previous * step);
+  }
+  return escape_index == escape_count;
+}
+
+/*
+Description:
+  Groups the bytes of coded values by significance: the lowest byte
+  of every value, then the next byte of every value, and so on. The
+  high bytes of coded values are mostly zero, and grouped together
+  they deflate to almost nothing.
+Parameters:
+  width  - [in] bytes of each value that are kept, 4 or 8.
+  buffer - [out] width * count bytes.
+*/
+static void ShuffleBytes(const ON__UINT64* words, int count, int width, unsigned char* buffer)
+{
+  for (int b = 0; b < width; b++)
+  {
+    unsigned char* dst = buffer + (size_t)b * count;
+    const int shift = 8 * b;
+    for (int i = 0; i < count; i++)
+      dst[i] = (unsigned char)(words[i] >> shift);
+  }
+}
+
+static void UnshuffleBytes(const unsigned char* buffer, int count, int width, ON__UINT64* words)
+{
+  memset(words, 0, sizeof(ON__UINT64) * count);
+  for (int b = 0; b < width; b++)
+  {
+    const unsigned char* src = buffer + (size_t)b * count;
+    const int shift = 8 * b;
+    for (int i = 0; i < count; i++)
+      words[i] |= (ON__UINT64)src[i] << shift;
+  }
+}
+
+void CAnalysisValues::Pack(double tolerance, CPackedValues& packed, ON_SimpleArray<unsigned char>& buffer) const
+{
+  const int count = Count();
+  ON_SimpleArray<ON__UINT64> words(count);
+  words.SetCount(count);
+
+  packed.m_count = count;
+  packed.m_coding = exact_coding;
+  packed.m_width = (int)ValueSize();
+  packed.m_step = 0.0;
+
+  // Rounded values are coded unless more than half of them would be
+  // escaped, which makes them larger than exact values.
+  ON_SimpleArray<float> float_escapes;
+  ON_SimpleArray<double> double_escapes;
+  const double step = 2.0 * tolerance;
+  if (step > 0.0 && ON_IsValid(step))
+  {
+    ON__UINT64 max_word = 0;
+    if (single_precision == m_precision)
+      CodeRounded(FloatArray(), count, step, words.Array(), float_escapes, max_word);
+    else
+      CodeRounded(DoubleArray(), count, step, words.Array(), double_escapes, max_word);
+    if (2 * (float_escapes.Count() + double_escapes.Count()) <= count)
+    {
+      packed.m_coding = rounded_coding;
+      packed.m_width = (max_word < EscapeWord(4)) ? 4 : 8;
+      packed.m_step = step;
+    }
+    else
+    {
+      float_escapes.Empty();
+      double_escapes.Empty();
+    }
+  }
+
+  if (exact_coding == packed.m_coding)
+  {
+    if (single_precision == m_precision)
+      CodeExact<float, ON__UINT32>(FloatArray(), count, words.Array());
+    else
+      CodeExact<double, ON__UINT64>(DoubleArray(), count, words.Array());
+  }
+
+  // The escaped values follow the coded values
+  const int word_size = packed.m_width * count;
+  const int escape_size = (int)(sizeof(float) * float_escapes.Count() + sizeof(double) * double_escapes.Count());
+  buffer.SetCapacity(word_size + escape_size);
+  buffer.SetCount(word_size + escape_size);
+  ShuffleBytes(words.Array(), count, packed.m_width, buffer.Array());
+  if (float_escapes.Count() > 0)
+    memcpy(buffer.Array() + word_size, float_escapes.Array(), escape_size);
+  else if (double_escapes.Count() > 0)
+    memcpy(buffer.Array() + word_size, double_escapes.Array(), escape_size);
+}
+
+bool CAnalysisValues::Decode(const CPackedValues& packed, const unsigned char* buffer, size_t size) const
+{
+  const int count = packed.m_count;
+  const size_t word_size = (size_t)packed.m_width * count;
+  if (size < word_size || 0 != (size - word_size) % ValueSize() || (exact_coding == packed.m_coding && size != word_size))
+    return false;
+  const int escape_count = (int)((size - word_size) / ValueSize());
+
+  ON_SimpleArray<ON__UINT64> words(count);
+  words.SetCount(count);
+  UnshuffleBytes(buffer, count, packed.m_width, words.Array());
+
+  // The values go in the buffer, which copies that share it also use
+  ON_SimpleArray<double>& doubles = m_buffer->m_doubles;
+  ON_SimpleArray<float>& floats = m_buffer->m_floats;
+  if (single_precision == m_precision)
+  {
+    floats.SetCapacity(count);
+    floats.SetCount(count);
+  }
+  else
+  {
+    doubles.SetCapacity(count);
+    doubles.SetCount(count);
+  }
+
+  bool rc = true;
+  if (rounded_coding == packed.m_coding)
+  {
+    const unsigned char* escapes = buffer + word_size;
+    rc = (single_precision == m_precision)
+      ? DecodeRounded(words.Array(), count, packed.m_width, packed.m_step, escapes, escape_count, floats.Array())
+      : DecodeRounded(words.Array(), count, packed.m_width, packed.m_step, escapes, escape_count, doubles.Array());
+  }
+  else
+  {
+    if (single_precision == m_precision)
+      DecodeExact<float, ON__UINT32>(words.Array(), count, floats.Array());
+    else
+      DecodeExact<double, ON__UINT64>(words.Array(), count, doubles.Array());
+  }
+
+  if (!rc)
+  {
+    floats.Destroy();
+    doubles.Destroy();
+  }
+  return rc;
+}
+
+bool CAnalysisValues::Unpack() const
+{
+  if (nullptr == m_buffer || nullptr == m_buffer->m_packed)
+    return true;
+
+  CPackedValues* packed = m_buffer->m_packed;
+  m_buffer->m_packed = nullptr;
+
+  // Values that fail their CRC check are dropped, rather than the mesh
+  const size_t size = packed->m_buffer.m_sizeof_uncompressed;
+  ON_SimpleArray<unsigned char> buffer((int)size);
+  buffer.SetCount((int)size);
+  int bFailedCRC = false;
+  bool rc = packed->m_buffer.Uncompress(buffer.Array(), &bFailedCRC) && !bFailedCRC;
+  if (rc)
+    rc = Decode(*packed, buffer.Array(), size);
+
+  delete packed;
+  return rc;
+}
+
+bool CAnalysisValues::WriteCompressed(ON_BinaryArchive& archive, double tolerance) const
+{
+  // Values that have not been used are written as they were read,
+  // unless they were rounded to a different tolerance.
+  CPackedValues new_packed;
+  ON_SimpleArray<unsigned char> buffer;
+  const CPackedValues* packed = m_buffer ? m_buffer->m_packed : nullptr;
+  const double step = (tolerance > 0.0) ? 2.0 * tolerance : 0.0;
+  if (nullptr == packed || packed->m_step != step)
+  {
+    Unpack();
+    Pack(tolerance, new_packed, buffer);
+    new_packed.m_buffer.Compress(buffer.Count(), buffer.Array(), 1);
+    buffer.Destroy();
+    packed = &new_packed;
+  }
+
+  bool rc = archive.WriteInt((int)m_precision);
+  if (rc)
+    rc = archive.WriteInt(packed->m_count);
+  if (rc)
+    rc = archive.WriteInt(packed->m_coding);
+  if (rc)
+    rc = archive.WriteInt(packed->m_width);
+  if (rc && rounded_coding == packed->m_coding)
+    rc = archive.WriteDouble(packed->m_step);
+  if (rc)
+    rc = packed->m_buffer.Write(archive);
+  return rc;
+}
+
+bool CAnalysisValues::ReadCompressed(ON_BinaryArchive& archive)
+{
+  Destroy();
+  m_precision = double_precision;
+
+  CValueBuffer& values = Edit();
+  CPackedValues* packed = new CPackedValues();
+  int precision = double_precision;
+  bool rc = archive.ReadInt(&precision);
+  if (rc)
+    rc = archive.ReadInt(&packed->m_count);
+  if (rc)
+    rc = archive.ReadInt(&packed->m_coding);
+  if (rc)
+    rc = archive.ReadInt(&packed->m_width);
+  if (rc && rounded_coding == packed->m_coding)
+    rc = archive.ReadDouble(&packed->m_step);
+
+  m_precision = (single_precision == precision) ? single_precision : double_precision;
+  const int count = packed->m_count;
+  const int width = packed->m_width;
+  const bool bValid = count >= 0
+    && (exact_coding == packed->m_coding ? width == (int)ValueSize() : (rounded_coding == packed->m_coding && (4 == width || 8 == width)));
+
+  // Rounded values may be followed by escaped values
+  const size_t size = (size_t)width * count;
+  const bool bRounded = (rounded_coding == packed->m_coding);
+
+  if (rc)
+    rc = packed->m_buffer.Read(archive);
+
+  // Values that cannot be decoded are skipped, rather than the data
+  const size_t sizeof_uncompressed = packed->m_buffer.m_sizeof_uncompressed;
+  if (rc && bValid && (bRounded ? sizeof_uncompressed >= size : sizeof_uncompressed == size))
+    values.m_packed = packed;
+  else
+    delete packed;
+
+  return rc;
+}
@@ -0,0 +1,178 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// AnalysisValues.h
+
+#pragma once
+
+// CAnalysisValues
+// An array of analysis values, stored in double or single precision.
+// Most solver output is single precision, and storing it that way
+// halves the memory and the saved size of an analysis mesh. Values
+// are set and read as doubles; code that visits every value, such as
+// the color and statistics code, works on DoubleArray() or
+// FloatArray() directly.
+//
+// Values read from an archive stay compressed until they are used, so
+// opening a model does not decode the values of meshes that are never
+// analyzed, and saving it again writes them as they were read. Count()
+// and Precision() do not decode the values.
+//
+// Copies share their values until one of them changes them, so
+// duplicating an analysis mesh does not duplicate its values. The
+// functions that give mutable access, such as the non-const
+// DoubleArray(), first copy values that are shared.
+//
+
+class CAnalysisValues
+{
+public:
+  enum precision : int
+  {
+    double_precision = 0,
+    single_precision = 1
+  };
+
+  CAnalysisValues();
+  ~CAnalysisValues();
+  CAnalysisValues(const CAnalysisValues& src);
+  CAnalysisValues& operator=(const CAnalysisValues& src);
+
+  // Exchanges the values of two arrays without copying or decoding
+  // them, and without changing whether they are shared.
+  void Swap(CAnalysisValues& other);
+
+  precision Precision() const;
+
+  // Number of values
+  int Count() const;
+
+  // Size of one value in bytes, 8 or 4.
+  size_t ValueSize() const;
+
+  /*
+  Description:
+    Changes the precision, converting the values.
+  Parameters:
+    precision - [in] the new precision.
+  */
+  void SetPrecision(precision precision);
+
+  /*
+  Description:
+    Sets the number of values. Values that are added are not
+    initialized. The precision does not change.
+  */
+  void SetCount(int count);
+
+  void Shrink();
+  void Destroy();
+
+  /*
+  Description:
+    Decodes values that are still compressed. Every function that
+    uses the values does this first. Values are not safe to decode
+    from several threads at once, and copies decode the values they
+    share, so code that uses values from several threads calls
+    Unpack() before it starts them.
+  Returns:
+    False if the values were compressed and could not be decoded.
+    Those values are dropped, so Count() is zero afterwards.
+  */
+  bool Unpack() const;
+
+  // True if the values are still compressed.
+  bool IsPacked() const;
+
+  // True if the values are shared with a copy.
+  bool IsShared() const;
+
+  // The value at an index, which must be valid.
+  double operator[](int i) const;
+
+  /*
+  Description:
+    The values, or nullptr if they are stored in the other precision.
+  */
+  double* DoubleArray();
+  const double* DoubleArray() const;
+  float* FloatArray();
+  const float* FloatArray() const;
+
+  // The values, in the stored precision, for moving them as bytes.
+  void* Array();
+  const void* Array() const;
+
+  /*
+  Description:
+    Replaces the values. The precision does not change.
+  Parameters:
+    values - [in] the new values.
+    count  - [in] number of values.
+  */
+  void SetValues(const double* values, int count);
+
+  /*
+  Description:
+    Copies values in or out of the array, converting them to or from
+    the stored precision.
+  Parameters:
+    start  - [in] index of the first value.
+    count  - [in] number of values. start + count must not be more
+                  than Count().
+    values - [out] or [in] count values.
+  */
+  void GetValues(int start, int count, double* values) const;
+  void SetValues(int start, int count, const double* values);
+
+  // Gets every value as a double.
+  void GetValues(ON_SimpleArray<double>& values) const;
+
+  /*
+  Description:
+    Reads an uncompressed array of doubles, the way values were saved
+    before they were compressed, and sets the precision to match.
+  */
+  bool ReadDoubleArray(ON_BinaryArchive& archive);
+
+  /*
+  Description:
+    Writes the values and their precision compressed. Each value is
+    predicted by the one before it, so smooth data leaves mostly zero
+    bits, and the bytes are grouped by significance before they are
+    deflated, so those zero bits compress.
+  Parameters:
+    archive   - [in] the archive.
+    tolerance - [in] 0.0 writes the values exactly. Otherwise values
+                     are rounded to multiples of 2 * tolerance, so each
+                     one reads back within tolerance, apart from single
+                     precision rounding. Each value that is not finite,
+                     or too large to round, is escaped and written
+                     exactly, and the others are still rounded. If
+                     more than half of the values would be escaped,
+                     every value is written exactly.
+  Returns:
+    True if successful.
+  */
+  bool WriteCompressed(ON_BinaryArchive& archive, double tolerance) const;
+
+  /*
+  Description:
+    Reads values written by WriteCompressed() and sets the precision
+    to match. The values are decoded when they are first used.
+  */
+  bool ReadCompressed(ON_BinaryArchive& archive);
+
+private:
+  class CPackedValues;
+  class CValueBuffer;
+  CValueBuffer& Edit();
+  void Release();
+  void Pack(double tolerance, CPackedValues& packed, ON_SimpleArray<unsigned char>& buffer) const;
+  bool Decode(const CPackedValues& packed, const unsigned char* buffer, size_t size) const;
+
+  precision m_precision;
+
+  // The values, shared by copies, or nullptr if there are none.
+  CValueBuffer* m_buffer;
+};
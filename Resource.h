@@ -10,6 +10,8 @@
 #define IDC_MIDRANGE_STATIC             5003
 #define IDC_BUTTON2                     5004
 #define IDC_AUTO_BUTTON                 5004
+#define IDC_COLORMAP_COMBO              5005
+#define IDC_BANDS_EDIT                  5006
 
 // Next default values for new objects
 // 
@@ -17,7 +19,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        5001
 #define _APS_NEXT_COMMAND_VALUE         32771
-#define _APS_NEXT_CONTROL_VALUE         5005
+#define _APS_NEXT_CONTROL_VALUE         5007
 #define _APS_NEXT_SYMED_VALUE           5000
 #endif
 #endif
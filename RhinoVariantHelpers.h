@@ -173,6 +173,7 @@ private:
   static int SafeArrayToPointArray(SAFEARRAY* psa, ON_4dPointArray& arr);
   static int SafeArrayToPointArray(SAFEARRAY* psa, ON_4fPointArray& arr);
 
+public:
   // Exception handling
   enum exception_type
   {
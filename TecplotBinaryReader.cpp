@@ -0,0 +1,693 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// TecplotBinaryReader.cpp
+
+#include "stdafx.h"
+#include "TecplotBinaryReader.h"
+#include "AnalysisUserData.h"
+#include "TecplotImportOptions.h"
+
+// Magic number and version at the start of every supported file
+static const char TDV_MAGIC[] = "#!TDV112";
+static const size_t TDV_MAGIC_LENGTH = 8;
+
+// Header section record markers
+static const float ZONE_MARKER = 299.0f;
+static const float CUSTOM_LABEL_MARKER = 599.0f;
+static const float USER_RECORD_MARKER = 699.0f;
+static const float DATASET_AUX_MARKER = 799.0f;
+static const float VARIABLE_AUX_MARKER = 899.0f;
+static const float END_OF_HEADER_MARKER = 357.0f;
+
+// Variable data formats
+static const int FLOAT_FORMAT = 1;
+static const int DOUBLE_FORMAT = 2;
+static const int LONG_FORMAT = 3;
+static const int SHORT_FORMAT = 4;
+static const int BYTE_FORMAT = 5;
+
+// True if values in a variable data format lose nothing as floats
+static bool IsSingleFormat(int format)
+{
+  return FLOAT_FORMAT == format || SHORT_FORMAT == format || BYTE_FORMAT == format;
+}
+
+// Size of one value in a variable data format, or 0 if
+// the format is not supported.
+static size_t ValueSize(int format)
+{
+  size_t rc = 0;
+  switch (format)
+  {
+  case FLOAT_FORMAT:
+    rc = sizeof(float);
+    break;
+  case DOUBLE_FORMAT:
+    rc = sizeof(double);
+    break;
+  case LONG_FORMAT:
+    rc = sizeof(ON__INT32);
+    break;
+  case SHORT_FORMAT:
+    rc = sizeof(ON__INT16);
+    break;
+  case BYTE_FORMAT:
+    rc = sizeof(ON__UINT8);
+    break;
+  default:
+    break;
+  }
+  return rc;
+}
+
+/*
+Description:
+  Copies a block of values of one type, converting them to T.
+*/
+template <class S, class T>
+static void ConvertValues(const char* s, int count, T* values, int stride)
+{
+  S x = 0;
+  for (int i = 0; i < count; i++, s += sizeof(x))
+  {
+    memcpy(&x, s, sizeof(x));
+    values[(size_t)i * stride] = (T)x;
+  }
+}
+
+/*
+Description:
+  Copies a block of values that has already been bounds checked.
+Parameters:
+  values - [out] value n is written to values[n * stride].
+Returns:
+  False if the format is not supported.
+*/
+template <class T>
+static bool CopyValues(const char* s, int format, int count, T* values, int stride)
+{
+  bool rc = true;
+  switch (format)
+  {
+  case DOUBLE_FORMAT:
+    if (1 == stride && sizeof(T) == sizeof(double))
+      memcpy(values, s, sizeof(double) * count);
+    else
+      ConvertValues<double>(s, count, values, stride);
+    break;
+  case FLOAT_FORMAT:
+    if (1 == stride && sizeof(T) == sizeof(float))
+      memcpy(values, s, sizeof(float) * count);
+    else
+      ConvertValues<float>(s, count, values, stride);
+    break;
+  case LONG_FORMAT:
+    ConvertValues<ON__INT32>(s, count, values, stride);
+    break;
+  case SHORT_FORMAT:
+    ConvertValues<ON__INT16>(s, count, values, stride);
+    break;
+  case BYTE_FORMAT:
+    ConvertValues<ON__UINT8>(s, count, values, stride);
+    break;
+  default:
+    rc = false;
+    break;
+  }
+  return rc;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+CTecplotBinaryReader::CZoneData::CZoneData()
+  : m_nodes(nullptr)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+CTecplotBinaryReader::CTecplotBinaryReader()
+  : m_bValid(false)
+{
+}
+
+bool CTecplotBinaryReader::Open(const wchar_t* filename)
+{
+  m_bValid = false;
+  m_title.Empty();
+  m_variables.Empty();
+  m_zones.Empty();
+  m_zone_data.Empty();
+  m_filename.Empty();
+
+  if (!m_file.Open(filename))
+    return false;
+  m_filename = filename;
+
+  const char* s = m_file.Begin();
+  m_bValid = ReadHeader(s);
+
+  // The data section has one record for each zone
+  for (int i = 0; i < m_zones.Count() && m_bValid; i++)
+    m_bValid = IndexZoneData(s, i, m_zone_data.AppendNew());
+
+  // Zones whose analysis variables are all single precision or
+  // narrower can be stored as floats. Passive variables are zero.
+  for (int i = 0; i < m_zone_data.Count() && m_bValid; i++)
+  {
+    const CZoneData& data = m_zone_data[i];
+    int single_count = 0;
+    bool bSingleData = true;
+    for (int v = 3; v < data.m_values.Count() && bSingleData; v++)
+    {
+      if (nullptr == data.m_values[v])
+        continue;
+      bSingleData = IsSingleFormat(data.m_formats[v]);
+      single_count++;
+    }
+    m_zones[i].m_bSingleData = bSingleData && single_count > 0;
+  }
+
+  return true;
+}
+
+bool CTecplotBinaryReader::IsValid() const
+{
+  return m_bValid;
+}
+
+int CTecplotBinaryReader::ZoneCount() const
+{
+  return m_bValid ? m_zones.Count() : 0;
+}
+
+bool CTecplotBinaryReader::Skip(const char*& s, size_t size) const
+{
+  if (nullptr == s || size > (size_t)(m_file.End() - s))
+    return false;
+  s += size;
+  return true;
+}
+
+bool CTecplotBinaryReader::ReadInt(const char*& s, int& i) const
+{
+  const char* p = s;
+  if (!Skip(s, sizeof(ON__INT32)))
+    return false;
+  ON__INT32 value = 0;
+  memcpy(&value, p, sizeof(value));
+  i = (int)value;
+  return true;
+}
+
+bool CTecplotBinaryReader::ReadFloat(const char*& s, float& x) const
+{
+  const char* p = s;
+  if (!Skip(s, sizeof(float)))
+    return false;
+  memcpy(&x, p, sizeof(x));
+  return true;
+}
+
+bool CTecplotBinaryReader::ReadDouble(const char*& s, double& x) const
+{
+  const char* p = s;
+  if (!Skip(s, sizeof(double)))
+    return false;
+  memcpy(&x, p, sizeof(x));
+  return true;
+}
+
+bool CTecplotBinaryReader::ReadString(const char*& s, ON_wString& str) const
+{
+  // Strings are stored as one 32-bit integer per character,
+  // terminated by a zero.
+  str.Empty();
+  int c = 0;
+  for (;;)
+  {
+    if (!ReadInt(s, c))
+      return false;
+    if (0 == c)
+      break;
+    str += (wchar_t)c;
+  }
+  return true;
+}
+
+bool CTecplotBinaryReader::ReadHeader(const char*& s)
+{
+  if (m_file.Size() < TDV_MAGIC_LENGTH || 0 != memcmp(s, TDV_MAGIC, TDV_MAGIC_LENGTH))
+    return false;
+  s += TDV_MAGIC_LENGTH;
+
+  // Files written with the other byte order do not read back as 1
+  int byte_order = 0;
+  if (!ReadInt(s, byte_order) || 1 != byte_order)
+    return false;
+
+  // FULL, GRID or SOLUTION. Only FULL files have coordinates and values.
+  int file_type = 0;
+  if (!ReadInt(s, file_type) || 0 != file_type)
+    return false;
+
+  if (!ReadString(s, m_title))
+    return false;
+
+  int variable_count = 0;
+  if (!ReadInt(s, variable_count) || variable_count <= 0)
+    return false;
+
+  m_variables.Reserve(variable_count);
+  for (int i = 0; i < variable_count; i++)
+  {
+    if (!ReadString(s, m_variables.AppendNew()))
+      return false;
+  }
+
+  for (;;)
+  {
+    float marker = 0.0f;
+    if (!ReadFloat(s, marker))
+      return false;
+
+    if (END_OF_HEADER_MARKER == marker)
+      break;
+
+    int i = 0;
+    ON_wString str;
+    if (ZONE_MARKER == marker)
+    {
+      CTecplotZone& zone = m_zones.AppendNew();
+      zone.m_index = m_zones.Count() - 1;
+      if (!ReadZoneHeader(s, zone))
+        return false;
+    }
+    else if (DATASET_AUX_MARKER == marker)
+    {
+      if (!ReadString(s, str) || !ReadInt(s, i) || !ReadString(s, str))
+        return false;
+    }
+    else if (VARIABLE_AUX_MARKER == marker)
+    {
+      if (!ReadInt(s, i) || !ReadString(s, str) || !ReadInt(s, i) || !ReadString(s, str))
+        return false;
+    }
+    else if (CUSTOM_LABEL_MARKER == marker)
+    {
+      int count = 0;
+      if (!ReadInt(s, count))
+        return false;
+      for (int j = 0; j < count; j++)
+      {
+        if (!ReadString(s, str))
+          return false;
+      }
+    }
+    else if (USER_RECORD_MARKER == marker)
+    {
+      if (!ReadString(s, str))
+        return false;
+    }
+    else
+    {
+      // Geometry and text records are not supported
+      return false;
+    }
+  }
+
+  return (m_zones.Count() > 0);
+}
+
+bool CTecplotBinaryReader::ReadZoneHeader(const char*& s, CTecplotZone& zone) const
+{
+  if (!ReadString(s, zone.m_title))
+    return false;
+
+  // Strand IDs are written as -1 for static zones
+  int parent_zone = 0, zone_color = 0, zone_type = 0;
+  if (!ReadInt(s, parent_zone) || !ReadInt(s, zone.m_strand_id) || !ReadDouble(s, zone.m_solution_time) || !ReadInt(s, zone_color) || !ReadInt(s, zone_type))
+    return false;
+  if (zone.m_strand_id < 0)
+    zone.m_strand_id = 0;
+
+  if (zone_type < CTecplotZone::ordered || zone_type > CTecplotZone::fe_polyhedron)
+    return false;
+  zone.m_zone_type = (CTecplotZone::zone_type)zone_type;
+  zone.m_bBlock = true;
+
+  // Only node located values can be mapped to mesh vertices
+  int specify_location = 0;
+  if (!ReadInt(s, specify_location))
+    return false;
+  if (specify_location)
+  {
+    for (int i = 0; i < m_variables.Count(); i++)
+    {
+      int location = 0;
+      if (!ReadInt(s, location) || 0 != location)
+        return false;
+    }
+  }
+
+  // Face neighbor data follows the zone data and is not supported
+  int raw_face_neighbors = 0, face_connections = 0;
+  if (!ReadInt(s, raw_face_neighbors) || !ReadInt(s, face_connections))
+    return false;
+  if (0 != raw_face_neighbors || 0 != face_connections)
+    return false;
+
+  if (zone.IsOrdered())
+  {
+    if (!ReadInt(s, zone.m_imax) || !ReadInt(s, zone.m_jmax) || !ReadInt(s, zone.m_kmax))
+      return false;
+  }
+  else
+  {
+    // Polygon and polyhedron zones store faces rather than elements
+    if (0 == zone.NodesPerElement())
+      return false;
+    if (!ReadInt(s, zone.m_point_count) || !ReadInt(s, zone.m_element_count))
+      return false;
+    // I, J and K cell dimensions, reserved
+    int i = 0;
+    if (!ReadInt(s, i) || !ReadInt(s, i) || !ReadInt(s, i))
+      return false;
+  }
+
+  if (zone.PointCount() <= 0 || zone.m_element_count < 0)
+    return false;
+
+  return ReadAuxiliaryData(s);
+}
+
+bool CTecplotBinaryReader::ReadAuxiliaryData(const char*& s) const
+{
+  for (;;)
+  {
+    int more = 0;
+    if (!ReadInt(s, more))
+      return false;
+    if (0 == more)
+      break;
+    ON_wString str;
+    int format = 0;
+    if (!ReadString(s, str) || !ReadInt(s, format) || !ReadString(s, str))
+      return false;
+  }
+  return true;
+}
+
+bool CTecplotBinaryReader::IndexZoneData(const char*& s, int zone_index, CZoneData& data) const
+{
+  const CTecplotZone& zone = m_zones[zone_index];
+  const int variable_count = m_variables.Count();
+
+  float marker = 0.0f;
+  if (!ReadFloat(s, marker) || ZONE_MARKER != marker)
+    return false;
+
+  int i = 0;
+  data.m_formats.Reserve(variable_count);
+  for (i = 0; i < variable_count; i++)
+  {
+    if (!ReadInt(s, data.m_formats.AppendNew()))
+      return false;
+  }
+
+  // Passive variables have no values in this zone
+  int has_passive = 0;
+  ON_SimpleArray<int> passive(variable_count);
+  for (i = 0; i < variable_count; i++)
+    passive.Append(0);
+  if (!ReadInt(s, has_passive))
+    return false;
+  for (i = 0; i < variable_count && has_passive; i++)
+  {
+    if (!ReadInt(s, passive[i]))
+      return false;
+  }
+
+  // Shared variables have their values in an earlier zone
+  int has_sharing = 0;
+  ON_SimpleArray<int> sharing(variable_count);
+  for (i = 0; i < variable_count; i++)
+    sharing.Append(-1);
+  if (!ReadInt(s, has_sharing))
+    return false;
+  for (i = 0; i < variable_count && has_sharing; i++)
+  {
+    if (!ReadInt(s, sharing[i]))
+      return false;
+    if (sharing[i] >= zone_index || (sharing[i] >= 0 && m_zones[sharing[i]].PointCount() != zone.PointCount()))
+      return false;
+  }
+
+  int share_connectivity = 0;
+  if (!ReadInt(s, share_connectivity))
+    return false;
+
+  // The value range of every variable stored in this zone
+  for (i = 0; i < variable_count; i++)
+  {
+    if (!passive[i] && -1 == sharing[i] && !Skip(s, 2 * sizeof(double)))
+      return false;
+  }
+
+  const int point_count = zone.PointCount();
+  data.m_values.Reserve(variable_count);
+  for (i = 0; i < variable_count; i++)
+  {
+    const char*& values = data.m_values.AppendNew();
+    values = nullptr;
+    if (passive[i])
+      continue;
+
+    if (sharing[i] >= 0)
+    {
+      data.m_formats[i] = m_zone_data[sharing[i]].m_formats[i];
+      values = m_zone_data[sharing[i]].m_values[i];
+      continue;
+    }
+
+    const size_t value_size = ValueSize(data.m_formats[i]);
+    values = s;
+    if (0 == value_size || !Skip(s, value_size * point_count))
+      return false;
+  }
+
+  if (!zone.IsOrdered())
+  {
+    // Zero based node indices, one block for the whole zone
+    if (share_connectivity >= 0)
+    {
+      if (share_connectivity >= zone_index)
+        return false;
+      const CTecplotZone& shared_zone = m_zones[share_connectivity];
+      if (shared_zone.m_zone_type != zone.m_zone_type || shared_zone.m_element_count != zone.m_element_count)
+        return false;
+      data.m_nodes = m_zone_data[share_connectivity].m_nodes;
+    }
+    else
+    {
+      data.m_nodes = s;
+      if (!Skip(s, sizeof(ON__INT32) * (size_t)zone.m_element_count * zone.NodesPerElement()))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+ON_Mesh* CTecplotBinaryReader::ReadZone(int zone_index, ON_Mesh* mesh, const CTecplotImportOptions* options) const
+{
+  return ReadZone(zone_index, mesh, options, nullptr);
+}
+
+ON_Mesh* CTecplotBinaryReader::ReadZone(int zone_index, ON_Mesh* mesh, const CTecplotImportOptions* options, const CAnalysisTimeSeries* frames) const
+{
+  if (mesh)
+    mesh->Destroy();
+
+  if (!m_bValid || zone_index < 0 || zone_index >= m_zones.Count())
+    return nullptr;
+
+  const CTecplotZone& zone = m_zones[zone_index];
+  const CZoneData& data = m_zone_data[zone_index];
+
+  // x, y, z and at least one analysis value
+  if (m_variables.Count() < 4)
+    return nullptr;
+
+  // The coordinates and the first analysis value are required
+  int i = 0;
+  for (i = 0; i < 4; i++)
+  {
+    if (nullptr == data.m_values[i])
+      return nullptr;
+  }
+
+  if (!zone.IsOrdered() && nullptr == data.m_nodes)
+    return nullptr;
+
+  const int point_count = zone.PointCount();
+
+  const bool bNewMesh = (nullptr == mesh);
+  if (bNewMesh)
+    mesh = new ON_Mesh();
+
+  CAnalysisUserData* ud = zone.CreateAnalysisData(m_variables, options);
+  mesh->m_V.SetCapacity(point_count);
+  mesh->m_V.SetCount(point_count);
+
+  // Each variable is a block of values that is copied straight into
+  // the vertex coordinates or its analysis channel, in the precision
+  // the channel is stored in. Passive variables have no values in the
+  // zone, so their channels are zero.
+  bool rc = true;
+  float* v = &mesh->m_V[0].x;
+  for (i = 0; i < 3 && rc; i++)
+    rc = CopyValues(data.m_values[i], data.m_formats[i], point_count, v + i, 3);
+  for (i = 3; i < m_variables.Count() && rc; i++)
+  {
+    float* float_values = ud->ChannelFloatValues(i - 3);
+    double* values = ud->ChannelValues(i - 3);
+    if (nullptr == data.m_values[i])
+      memset(float_values ? (void*)float_values : (void*)values, 0, ud->m_a.ValueSize() * point_count);
+    else if (float_values)
+      rc = CopyValues(data.m_values[i], data.m_formats[i], point_count, float_values, 1);
+    else
+      rc = CopyValues(data.m_values[i], data.m_formats[i], point_count, values, 1);
+  }
+
+  if (rc)
+  {
+    if (zone.IsOrdered())
+      zone.AddStructuredFaces(mesh, options);
+    else
+    {
+      const int node_count = zone.m_element_count * zone.NodesPerElement();
+      ON_SimpleArray<int> nodes;
+      nodes.SetCapacity(node_count);
+      nodes.SetCount(node_count);
+      memcpy(nodes.Array(), data.m_nodes, sizeof(ON__INT32) * node_count);
+      rc = zone.AddElementFaces(nodes.Array(), mesh);
+    }
+  }
+
+  if (!rc)
+  {
+    delete ud;
+    if (bNewMesh)
+      delete mesh;
+    else
+      mesh->Destroy();
+    return nullptr;
+  }
+
+  if (frames)
+    ud->m_frames = *frames;
+
+  zone.AttachAnalysisData(mesh, ud);
+
+  return mesh;
+}
+
+bool CTecplotBinaryReader::ReadZones(ON_SimpleArray<ON_Mesh*>& meshes, const CTecplotImportOptions* options) const
+{
+  if (!m_bValid)
+    return false;
+
+  const int zone_count = m_zones.Count();
+  const int variable_count = m_variables.Count();
+
+  // Without time series, each zone is its own series
+  ON_SimpleArray<int> series(zone_count);
+  int i;
+  if (options && options->m_bTimeSeries)
+    CTecplotZone::FindTimeSeries(m_zones, series);
+  else
+  {
+    for (i = 0; i < zone_count; i++)
+      series.Append(i);
+  }
+
+  // The later frames of a series are found by the offsets of their
+  // values and read when they are shown.
+  ON_ClassArray<CAnalysisTimeSeries> frames(zone_count);
+  for (i = 0; i < zone_count; i++)
+    frames.AppendNew();
+  for (i = 0; i < zone_count; i++)
+  {
+    CAnalysisTimeSeries& f = frames[series[i]];
+    if (series[i] == i)
+    {
+      f.m_filename = m_filename;
+      f.m_file_type = CAnalysisTimeSeries::tecplot_binary;
+      f.m_file_size = m_file.Size();
+      f.m_point_count = m_zones[i].PointCount();
+      f.m_variable_count = variable_count;
+    }
+    f.m_times.Append(m_zones[i].m_solution_time);
+    const CZoneData& data = m_zone_data[i];
+    for (int v = 3; v < variable_count; v++)
+    {
+      f.m_offsets.Append(data.m_values[v] ? (ON__INT64)(data.m_values[v] - m_file.Begin()) : -1);
+      f.m_formats.Append(data.m_formats[v]);
+    }
+  }
+
+  ON_SimpleArray<ON_Mesh*> zone_meshes(zone_count);
+  zone_meshes.SetCount(zone_count);
+  zone_meshes.Zero();
+
+  concurrency::parallel_for(0, zone_count, [&](int i)
+  {
+    if (series[i] == i)
+      zone_meshes[i] = ReadZone(i, nullptr, options, (frames[i].FrameCount() > 1) ? &frames[i] : nullptr);
+  });
+
+  // The later frames of a series do not have a mesh of their own
+  bool rc = true;
+  for (i = 0; i < zone_count; i++)
+  {
+    if (zone_meshes[i])
+      meshes.Append(zone_meshes[i]);
+    else if (series[i] == i)
+      rc = false;
+  }
+
+  return rc;
+}
+
+bool CTecplotBinaryReader::ReadValues(const wchar_t* filename, ON__UINT64 file_size, const ON__INT64* offsets, const int* formats, int block_count, int value_count, double* values)
+{
+  if (nullptr == offsets || nullptr == formats || nullptr == values || block_count < 0 || value_count < 0)
+    return false;
+
+  CAnalysisMappedFile file;
+  if (!file.Open(filename) || (ON__UINT64)file.Size() != file_size)
+    return false;
+
+  const size_t size = file.Size();
+  bool rc = true;
+  for (int b = 0; b < block_count && rc; b++)
+  {
+    double* block = values + (size_t)b * value_count;
+
+    // Passive variables have no values in the zone
+    if (offsets[b] < 0)
+    {
+      memset(block, 0, sizeof(double) * value_count);
+      continue;
+    }
+
+    const size_t value_size = ValueSize(formats[b]);
+    rc = (value_size > 0 && (size_t)offsets[b] <= size && value_size * value_count <= size - (size_t)offsets[b]);
+    if (rc)
+      rc = CopyValues(file.Begin() + offsets[b], formats[b], value_count, block, 1);
+  }
+
+  return rc;
+}
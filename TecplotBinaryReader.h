@@ -0,0 +1,134 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// TecplotBinaryReader.h
+
+#pragma once
+
+#include "AnalysisMappedFile.h"
+#include "TecplotZone.h"
+
+class CAnalysisTimeSeries;
+
+// CTecplotBinaryReader
+// Reads binary Tecplot (.plt) files, version "#!TDV112", as written
+// by TecIO and most solvers. The file is mapped into memory and the
+// zone data is copied in bulk into the mesh arrays.
+//
+
+class CTecplotBinaryReader
+{
+public:
+  CTecplotBinaryReader();
+  ~CTecplotBinaryReader() = default;
+
+  /*
+  Description:
+    Opens a binary Tecplot file and reads its header section. The
+    data section is indexed, so zones can be read in any order.
+  Parameters:
+    filename - [in] the name of the file to read.
+  Returns:
+    True if the file was opened. Call IsValid() to find out
+    if the file could be indexed.
+  */
+  bool Open(const wchar_t* filename);
+
+  // True if the header section and data section were indexed.
+  bool IsValid() const;
+
+  // Number of zones in the file.
+  int ZoneCount() const;
+
+  /*
+  Description:
+    Reads a zone and creates an analysis mesh from it. Ordered zones
+    and FETRIANGLE, FEQUADRILATERAL, FETETRAHEDRON and FEBRICK zones
+    with node located values are supported. Volume zones are reduced
+    to their boundary faces. Variables and connectivity shared
+    with earlier zones are supported. The first three variables are
+    the x, y and z coordinates and each of the others becomes an
+    analysis channel.
+  Parameters:
+    zone_index - [in] zero based zone number.
+    mesh       - [in] If not null, the mesh to fill in. Otherwise a new
+                      mesh is allocated.
+    options    - [in] import options, or nullptr for the defaults.
+  Returns:
+    A pointer to the analysis mesh if successful, or nullptr
+    if the zone could not be read.
+  */
+  ON_Mesh* ReadZone(int zone_index, ON_Mesh* mesh = nullptr, const CTecplotImportOptions* options = nullptr) const;
+
+  /*
+  Description:
+    Reads all of the zones concurrently. If options->m_bTimeSeries is
+    true, the zones of a time series, as found by
+    CTecplotZone::FindTimeSeries(), become one mesh whose other frames
+    are read when they are shown.
+  Parameters:
+    meshes  - [out] the analysis meshes of the zones that were read,
+                    in file order, are appended. The caller is
+                    responsible for deleting them.
+    options - [in] import options, or nullptr for the defaults.
+  Returns:
+    True if every zone was read.
+  */
+  bool ReadZones(ON_SimpleArray<ON_Mesh*>& meshes, const CTecplotImportOptions* options = nullptr) const;
+
+  /*
+  Description:
+    Reads blocks of values from a file without indexing it. Used to
+    read the frames of a time series.
+  Parameters:
+    filename    - [in] the name of the file to read.
+    file_size   - [in] the expected size of the file.
+    offsets     - [in] the offset of each block in the file, or -1 for
+                       a passive variable, whose values are zero.
+    formats     - [in] the data format of each block.
+    block_count - [in] the number of blocks.
+    value_count - [in] the number of values in each block.
+    values      - [out] block_count * value_count values.
+  Returns:
+    True if successful. False if the file has changed size or a
+    block is not in the file.
+  */
+  static bool ReadValues(const wchar_t* filename, ON__UINT64 file_size, const ON__INT64* offsets, const int* formats, int block_count, int value_count, double* values);
+
+private:
+  // Where a zone's values are in the mapped file. Shared variables and
+  // connectivity point at the data of the zone they are shared with.
+  class CZoneData
+  {
+  public:
+    CZoneData();
+    ON_SimpleArray<int> m_formats;
+    ON_SimpleArray<const char*> m_values;
+    const char* m_nodes;
+  };
+
+  ON_Mesh* ReadZone(int zone_index, ON_Mesh* mesh, const CTecplotImportOptions* options, const CAnalysisTimeSeries* frames) const;
+  bool ReadHeader(const char*& s);
+  bool ReadZoneHeader(const char*& s, CTecplotZone& zone) const;
+  bool ReadAuxiliaryData(const char*& s) const;
+  bool IndexZoneData(const char*& s, int zone_index, CZoneData& data) const;
+
+  bool ReadInt(const char*& s, int& i) const;
+  bool ReadFloat(const char*& s, float& x) const;
+  bool ReadDouble(const char*& s, double& x) const;
+  bool ReadString(const char*& s, ON_wString& str) const;
+  bool Skip(const char*& s, size_t size) const;
+
+private:
+  CAnalysisMappedFile m_file;
+  ON_wString m_filename;
+  bool m_bValid;
+
+  // Header section information
+  ON_wString m_title;
+  ON_ClassArray<ON_wString> m_variables;
+  ON_ClassArray<CTecplotZone> m_zones;
+
+  // Data section index, one for each zone
+  ON_ClassArray<CZoneData> m_zone_data;
+};
@@ -0,0 +1,178 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// TecplotImportOptions.cpp
+
+#include "stdafx.h"
+#include "TecplotImportOptions.h"
+
+// Profile entry names
+static const wchar_t* BOUNDARY_ONLY_ENTRY = L"TecplotBoundaryOnly";
+static const wchar_t* TIME_SERIES_ENTRY = L"TecplotTimeSeries";
+static const wchar_t* TEXTURE_COLORS_ENTRY = L"TecplotTextureColors";
+static const wchar_t* PRECISION_ENTRY = L"TecplotPrecision";
+static const wchar_t* SLICE_ENTRIES[3] = { L"TecplotISlices", L"TecplotJSlices", L"TecplotKSlices" };
+
+CTecplotImportOptions::CTecplotImportOptions()
+  : m_bBoundaryOnly(false)
+  , m_bTimeSeries(false)
+  , m_bTextureColors(false)
+  , m_precision(auto_precision)
+{
+}
+
+CRhinoCommand::result CTecplotImportOptions::GetOptions()
+{
+  for (;;)
+  {
+    CRhinoGetOption go;
+    go.SetCommandPrompt(RHSTR(L"Tecplot import options"));
+    go.AcceptNothing();
+
+    go.AddCommandOptionToggle(RHCMDOPTNAME(L"Surface"), RHCMDOPTVALUE(L"AllPlanes"), RHCMDOPTVALUE(L"Boundary"), m_bBoundaryOnly, &m_bBoundaryOnly);
+    const int i_opt = go.AddCommandOption(RHCMDOPTNAME(L"ISlices"));
+    const int j_opt = go.AddCommandOption(RHCMDOPTNAME(L"JSlices"));
+    const int k_opt = go.AddCommandOption(RHCMDOPTNAME(L"KSlices"));
+    go.AddCommandOptionToggle(RHCMDOPTNAME(L"TimeSeries"), RHCMDOPTVALUE(L"No"), RHCMDOPTVALUE(L"Yes"), m_bTimeSeries, &m_bTimeSeries);
+    go.AddCommandOptionToggle(RHCMDOPTNAME(L"Colors"), RHCMDOPTVALUE(L"Vertex"), RHCMDOPTVALUE(L"Texture"), m_bTextureColors, &m_bTextureColors);
+
+    // The list is in value_precision order
+    ON_ClassArray<CRhinoCommandOptionValue> precisions;
+    precisions.Append(RHCMDOPTVALUE(L"Auto"));
+    precisions.Append(RHCMDOPTVALUE(L"Single"));
+    precisions.Append(RHCMDOPTVALUE(L"Double"));
+    const int precision_opt = go.AddCommandOptionList(RHCMDOPTNAME(L"Precision"), precisions, (int)m_precision);
+
+    go.GetOption();
+    if (go.CommandResult() != CRhinoCommand::success)
+      return go.CommandResult();
+
+    if (CRhinoGet::option != go.Result())
+      break;
+
+    const CRhinoCommandOption* opt = go.Option();
+    if (nullptr == opt)
+      continue;
+
+    if (precision_opt == opt->m_option_index)
+    {
+      const int precision = opt->m_list_option_current;
+      if (precision >= auto_precision && precision <= double_precision)
+        m_precision = (value_precision)precision;
+      continue;
+    }
+
+    int direction = -1;
+    if (i_opt == opt->m_option_index)
+      direction = 0;
+    else if (j_opt == opt->m_option_index)
+      direction = 1;
+    else if (k_opt == opt->m_option_index)
+      direction = 2;
+
+    if (direction >= 0)
+    {
+      CRhinoGetString gs;
+      gs.SetCommandPrompt(RHSTR(L"Zero based slice indices, separated by commas"));
+      gs.SetDefaultString(SliceString(direction));
+      gs.AcceptNothing();
+      gs.GetString();
+      if (gs.CommandResult() != CRhinoCommand::success)
+        return gs.CommandResult();
+      if (CRhinoGet::string == gs.Result())
+        SetSlices(direction, gs.String());
+    }
+  }
+
+  return CRhinoCommand::success;
+}
+
+void CTecplotImportOptions::LoadProfile(LPCTSTR lpszSection, CRhinoProfileContext& pc)
+{
+  pc.LoadProfileBool(lpszSection, BOUNDARY_ONLY_ENTRY, &m_bBoundaryOnly);
+  pc.LoadProfileBool(lpszSection, TIME_SERIES_ENTRY, &m_bTimeSeries);
+  pc.LoadProfileBool(lpszSection, TEXTURE_COLORS_ENTRY, &m_bTextureColors);
+
+  int precision = (int)m_precision;
+  if (pc.LoadProfileInt(lpszSection, PRECISION_ENTRY, &precision) && precision >= auto_precision && precision <= double_precision)
+    m_precision = (value_precision)precision;
+
+  ON_wString s;
+  for (int direction = 0; direction < 3; direction++)
+  {
+    if (pc.LoadProfileString(lpszSection, SLICE_ENTRIES[direction], s))
+      SetSlices(direction, s);
+  }
+}
+
+void CTecplotImportOptions::SaveProfile(LPCTSTR lpszSection, CRhinoProfileContext& pc) const
+{
+  pc.SaveProfileBool(lpszSection, BOUNDARY_ONLY_ENTRY, m_bBoundaryOnly);
+  pc.SaveProfileBool(lpszSection, TIME_SERIES_ENTRY, m_bTimeSeries);
+  pc.SaveProfileBool(lpszSection, TEXTURE_COLORS_ENTRY, m_bTextureColors);
+  pc.SaveProfileInt(lpszSection, PRECISION_ENTRY, (int)m_precision);
+
+  for (int direction = 0; direction < 3; direction++)
+    pc.SaveProfileString(lpszSection, SLICE_ENTRIES[direction], SliceString(direction));
+}
+
+CAnalysisValues::precision CTecplotImportOptions::ValuePrecision(bool bSingleData) const
+{
+  if (single_precision == m_precision || (auto_precision == m_precision && bSingleData))
+    return CAnalysisValues::single_precision;
+  return CAnalysisValues::double_precision;
+}
+
+ON_wString CTecplotImportOptions::SliceString(int direction) const
+{
+  ON_wString s;
+  if (direction < 0 || direction > 2 || 0 == m_slices[direction].Count())
+    return ON_wString(L"None");
+
+  ON_wString index;
+  for (int i = 0; i < m_slices[direction].Count(); i++)
+  {
+    index.Format(i ? L",%d" : L"%d", m_slices[direction][i]);
+    s += index;
+  }
+
+  return s;
+}
+
+void CTecplotImportOptions::SetSlices(int direction, const wchar_t* s)
+{
+  if (direction < 0 || direction > 2)
+    return;
+
+  ON_SimpleArray<int>& slices = m_slices[direction];
+  slices.SetCount(0);
+  if (nullptr == s)
+    return;
+
+  int index = -1;
+  for (;; s++)
+  {
+    if (*s >= L'0' && *s <= L'9')
+    {
+      index = (index < 0 ? 0 : 10 * index) + (int)(*s - L'0');
+      continue;
+    }
+
+    if (index >= 0)
+      slices.Append(index);
+    index = -1;
+
+    if (0 == *s)
+      break;
+  }
+
+  // Ascending, with no duplicates
+  slices.QuickSort(ON_CompareIncreasing<int>);
+  int count = 0;
+  for (int i = 0; i < slices.Count(); i++)
+  {
+    if (0 == count || slices[count - 1] != slices[i])
+      slices[count++] = slices[i];
+  }
+  slices.SetCount(count);
+}
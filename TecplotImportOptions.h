@@ -0,0 +1,91 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// TecplotImportOptions.h
+
+#pragma once
+
+#include "AnalysisValues.h"
+
+// CTecplotImportOptions
+// Options that control how Tecplot zones are turned into meshes.
+// The options are saved in the plug-in's profile and can be set
+// on the command line, so scripts can use -_Import to set them.
+//
+
+class CTecplotImportOptions
+{
+public:
+  // How the precision of the analysis values is chosen
+  enum value_precision : int
+  {
+    auto_precision = 0,   // single if the zone's data is single precision
+    single_precision = 1,
+    double_precision = 2
+  };
+
+  CTecplotImportOptions();
+
+  /*
+  Description:
+    Prompts for the options on the command line.
+  Returns:
+    CRhinoCommand::success if the options were accepted.
+  */
+  CRhinoCommand::result GetOptions();
+
+  void LoadProfile(LPCTSTR lpszSection, CRhinoProfileContext& pc);
+  void SaveProfile(LPCTSTR lpszSection, CRhinoProfileContext& pc) const;
+
+  /*
+  Description:
+    Formats the slice indices of a grid direction as a comma
+    separated list, such as "0,10,20", or "None".
+  Parameters:
+    direction - [in] 0 = I, 1 = J, 2 = K.
+  */
+  ON_wString SliceString(int direction) const;
+
+  /*
+  Description:
+    Sets the slice indices of a grid direction from a comma or space
+    separated list of zero based indices. Anything that is not a
+    number, such as "None", clears the list.
+  Parameters:
+    direction - [in] 0 = I, 1 = J, 2 = K.
+    s         - [in] the list.
+  */
+  void SetSlices(int direction, const wchar_t* s);
+
+  /*
+  Description:
+    Gets the precision to store a zone's analysis values in.
+  Parameters:
+    bSingleData - [in] true if the zone's analysis variables are single
+                       precision or narrower in the file.
+  */
+  CAnalysisValues::precision ValuePrecision(bool bSingleData) const;
+
+  // If true, 3D ordered zones produce only the six exterior faces of
+  // the block, plus any slice planes. If false, every grid plane is
+  // meshed, which hides most faces inside the volume.
+  bool m_bBoundaryOnly;
+
+  // Zero based I, J and K indices of the grid planes to add to
+  // boundary only surfaces.
+  ON_SimpleArray<int> m_slices[3];
+
+  // If true, zones that are frames of the same time series become one
+  // mesh that can be stepped through with AnalyzeMeshFrames. If false,
+  // every zone becomes a mesh.
+  bool m_bTimeSeries;
+
+  // If true, the meshes are colored with a texture rather than vertex
+  // colors, so display range and color map changes are drawn without
+  // recoloring. See CAnalysisUserData::SetTextureColors().
+  bool m_bTextureColors;
+
+  // The precision of the analysis values. Single precision halves the
+  // memory and the saved size of the meshes.
+  value_precision m_precision;
+};
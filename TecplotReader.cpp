@@ -0,0 +1,857 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// TecplotReader.cpp
+
+#include "stdafx.h"
+#include "TecplotReader.h"
+#include "AnalysisTextParser.h"
+#include "AnalysisUserData.h"
+#include "TecplotImportOptions.h"
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Characters that can start a keyword, such as ZONE or DATAPACKING
+static bool IsKeywordStart(char c)
+{
+  return (CAnalysisTextParser::IsAlpha(c) || '_' == c);
+}
+
+// Characters that can continue a keyword, such as Common.Reference
+static bool IsKeywordChar(char c)
+{
+  return (IsKeywordStart(c) || CAnalysisTextParser::IsDigit(c) || '.' == c);
+}
+
+// Characters that can start a number. The zone data begins with the first one.
+static bool IsNumberStart(char c)
+{
+  return (CAnalysisTextParser::IsDigit(c) || '+' == c || '-' == c || '.' == c);
+}
+
+// Skips white space, commas and # comment lines between header records.
+static const char* SkipHeaderSpace(const char* s, const char* end)
+{
+  while (s < end)
+  {
+    if ('#' == *s)
+    {
+      while (s < end && '\n' != *s)
+        s++;
+    }
+    else if (' ' == *s || '\t' == *s || '\r' == *s || '\n' == *s || ',' == *s)
+      s++;
+    else
+      break;
+  }
+  return s;
+}
+
+// Reads a header value: a "quoted string", a (parenthesized list) or a bare word.
+static const char* ReadHeaderValue(const char* s, const char* end, const char*& value, const char*& value_end)
+{
+  if (s < end && ('"' == *s || '(' == *s))
+  {
+    const char close = ('"' == *s) ? '"' : ')';
+    value = ++s;
+    while (s < end && close != *s)
+      s++;
+    value_end = s;
+    if (s < end)
+      s++;
+  }
+  else
+  {
+    value = s;
+    while (s < end && ' ' != *s && '\t' != *s && '\r' != *s && '\n' != *s && ',' != *s)
+      s++;
+    value_end = s;
+  }
+  return s;
+}
+
+// Case insensitive comparison of a [s, end) token with a keyword.
+static bool IsKeyword(const char* s, const char* end, const char* keyword)
+{
+  const size_t length = strlen(keyword);
+  return ((size_t)(end - s) == length && 0 == _strnicmp(s, keyword, length));
+}
+
+// Case insensitive search for a keyword in a [s, end) token.
+static bool HasKeyword(const char* s, const char* end, const char* keyword)
+{
+  const size_t length = strlen(keyword);
+  for (; (size_t)(end - s) >= length; s++)
+  {
+    if (0 == _strnicmp(s, keyword, length))
+      return true;
+  }
+  return false;
+}
+
+/*
+Description:
+  Reads a DT= value, the data types of the variables, such as
+  (SINGLE SINGLE SINGLE DOUBLE).
+Returns:
+  True if every variable that follows x, y and z is single precision
+  or narrower, so its values lose nothing in single precision.
+*/
+static bool IsSingleData(const char* s, const char* end)
+{
+  int variable = 0;
+  int single_count = 0;
+  while (s < end)
+  {
+    while (s < end && (' ' == *s || '\t' == *s || ',' == *s || '\r' == *s || '\n' == *s))
+      s++;
+    const char* token = s;
+    while (s < end && ' ' != *s && '\t' != *s && ',' != *s && '\r' != *s && '\n' != *s)
+      s++;
+    if (token == s)
+      break;
+
+    // The coordinates are read into the mesh vertices
+    if (variable++ < 3)
+      continue;
+
+    if (!IsKeyword(token, s, "SINGLE") && !IsKeyword(token, s, "SHORTINT") && !IsKeyword(token, s, "BYTE"))
+      return false;
+    single_count++;
+  }
+  return single_count > 0;
+}
+
+/*
+Description:
+  Reads a ZONETYPE= or ET= value, such as FEBRICK or BRICK.
+Returns:
+  False if the value is not a zone type.
+*/
+static bool ParseZoneType(const char* s, const char* end, CTecplotZone::zone_type& zone_type)
+{
+  static const struct
+  {
+    const char* name;
+    CTecplotZone::zone_type zone_type;
+  } zone_types[] =
+  {
+    { "ORDERED", CTecplotZone::ordered },
+    { "LINESEG", CTecplotZone::fe_line_segment },
+    { "TRIANGLE", CTecplotZone::fe_triangle },
+    { "QUADRILATERAL", CTecplotZone::fe_quadrilateral },
+    { "TETRAHEDRON", CTecplotZone::fe_tetrahedron },
+    { "BRICK", CTecplotZone::fe_brick },
+    { "POLYGON", CTecplotZone::fe_polygon },
+    { "POLYHEDRON", CTecplotZone::fe_polyhedron },
+  };
+
+  // ZONETYPE= values start with FE, ET= values do not
+  if (end - s > 2 && 0 == _strnicmp(s, "FE", 2))
+    s += 2;
+
+  for (int i = 0; i < (int)(sizeof(zone_types) / sizeof(zone_types[0])); i++)
+  {
+    if (IsKeyword(s, end, zone_types[i].name))
+    {
+      zone_type = zone_types[i].zone_type;
+      return true;
+    }
+  }
+  return false;
+}
+
+static ON_wString HeaderString(const char* s, const char* end)
+{
+  return ON_wString(ON_String(s, (int)(end - s)));
+}
+
+// Finds the ZONE records, which each start a line, in [s, end).
+static void FindZones(const char* s, const char* end, ON_SimpleArray<const char*>& zones)
+{
+  const char* line = nullptr;
+  const char* line_end = nullptr;
+  while (CAnalysisTextParser::GetLine(s, end, line, line_end))
+  {
+    while (line < line_end && (' ' == *line || '\t' == *line))
+      line++;
+    if (line_end - line >= 4 && 0 == _strnicmp(line, "ZONE", 4) && (line_end - line == 4 || !IsKeywordChar(line[4])))
+      zones.Append(line);
+  }
+}
+
+// Skips a number without converting it. Returns nullptr if s is not at a number.
+static const char* SkipNumber(const char* s, const char* end)
+{
+  if (nullptr == s || s >= end || !CAnalysisTextParser::IsNumeric(*s))
+    return nullptr;
+  while (s < end && CAnalysisTextParser::IsNumeric(*s))
+    s++;
+  return s;
+}
+
+/*
+Description:
+  Reads a VARSHARELIST= value, such as [1-3]=1 or [1,2,3], where the
+  zone number defaults to the previous zone.
+Parameters:
+  zone - [in/out] the zone, whose m_index is set. m_bSharedCoordinates
+                  and m_coordinates_zone are set if x, y and z are shared.
+Returns:
+  False if an analysis variable is shared, or if only some of x, y
+  and z are shared, or they are shared with different zones.
+*/
+static bool ParseVariableSharing(const char* s, const char* end, CTecplotZone& zone)
+{
+  bool bShared[3] = { false, false, false };
+  int shared_zones[3] = { -1, -1, -1 };
+
+  for (;;)
+  {
+    while (s < end && '[' != *s)
+      s++;
+    if (s >= end)
+      break;
+
+    // One based variable numbers and ranges, such as 1-3,5
+    ON_SimpleArray<int> variables;
+    for (s++; s < end && ']' != *s;)
+    {
+      if (!CAnalysisTextParser::IsDigit(*s))
+      {
+        s++;
+        continue;
+      }
+      int first = 0, last = 0;
+      s = CAnalysisTextParser::ParseInt(s, end, first);
+      last = first;
+      if (s && s < end && '-' == *s)
+        s = CAnalysisTextParser::ParseInt(s + 1, end, last);
+      if (nullptr == s || first < 1 || last < first || last > 3)
+        return false;
+      for (int v = first; v <= last; v++)
+        variables.Append(v - 1);
+    }
+    if (s < end)
+      s++;
+
+    int shared_zone = zone.m_index - 1;
+    while (s < end && (' ' == *s || '\t' == *s))
+      s++;
+    if (s < end && '=' == *s)
+    {
+      s = CAnalysisTextParser::SkipWhiteSpace(s + 1, end);
+      s = CAnalysisTextParser::ParseInt(s, end, shared_zone);
+      if (nullptr == s)
+        return false;
+      shared_zone--;
+    }
+
+    for (int i = 0; i < variables.Count(); i++)
+    {
+      bShared[variables[i]] = true;
+      shared_zones[variables[i]] = shared_zone;
+    }
+  }
+
+  if (!bShared[0] && !bShared[1] && !bShared[2])
+    return true;
+  if (!bShared[0] || !bShared[1] || !bShared[2] || shared_zones[0] != shared_zones[1] || shared_zones[0] != shared_zones[2])
+    return false;
+
+  zone.m_bSharedCoordinates = true;
+  zone.m_coordinates_zone = shared_zones[0];
+  return true;
+}
+
+/*
+Description:
+  Reads one BLOCK variable, a column of count values separated by
+  white space, straight into its destination.
+Parameters:
+  values - [out] if not null, value n is written to values[n * stride].
+                 If null, the values are skipped without converting them.
+Returns:
+  The position after the last value, or nullptr on failure.
+*/
+template <class T>
+static const char* ParseBlockColumn(const char* s, const char* end, int count, T* values, int stride)
+{
+  if (nullptr == values)
+  {
+    for (int n = 0; n < count && s; n++)
+      s = SkipNumber(CAnalysisTextParser::SkipWhiteSpace(s, end), end);
+    return s;
+  }
+
+  double x = 0.0;
+  for (int n = 0; n < count && s; n++)
+  {
+    s = CAnalysisTextParser::SkipWhiteSpace(s, end);
+    s = CAnalysisTextParser::ParseDouble(s, end, x);
+    if (s)
+      values[(size_t)n * stride] = (T)x;
+  }
+  return s;
+}
+
+/*
+Description:
+  Reads the next value on a POINT line.
+Parameters:
+  value - [out] if null, the value is skipped without converting it.
+Returns:
+  The position after the value, or nullptr on failure.
+*/
+template <class T>
+static const char* ParsePointValue(const char* s, const char* end, T* value)
+{
+  s = CAnalysisTextParser::SkipJunk(s, end);
+  if (nullptr == value)
+    return SkipNumber(s, end);
+
+  double x = 0.0;
+  s = CAnalysisTextParser::ParseDouble(s, end, x);
+  if (s)
+    *value = (T)x;
+  return s;
+}
+
+/*
+Description:
+  Reads the values of a zone, with POINT or BLOCK data packing.
+  Coordinates that the zone shares with another zone are not in
+  its data.
+Parameters:
+  variable_count - [in] the number of variables, x, y and z and then
+                        the analysis variables.
+  points   - [out] if not null, the coordinates of node n are written
+                   to points[3*n], points[3*n+1] and points[3*n+2].
+  channels - [out] if not null, variable_count - 3 columns. The value
+                   of variable c+3 at node n is written to channels[c][n]
+                   if channels[c] is not null.
+Returns:
+  The position after the values, or nullptr on failure.
+*/
+template <class T>
+static const char* ParseZoneValues(const char* s, const char* end, const CTecplotZone& zone, int variable_count, float* points, T* const* channels)
+{
+  const int point_count = zone.PointCount();
+  const int first = zone.m_bSharedCoordinates ? 3 : 0;
+
+  if (zone.m_bBlock)
+  {
+    // Each variable is a column of values that is streamed straight
+    // into the vertex coordinates or its analysis channel.
+    for (int v = first; v < variable_count && s; v++)
+    {
+      if (v < 3)
+        s = ParseBlockColumn(s, end, point_count, points ? points + v : nullptr, 3);
+      else
+        s = ParseBlockColumn(s, end, point_count, channels ? channels[v - 3] : nullptr, 1);
+    }
+    return s;
+  }
+
+  // Each node is a line of values. The lines of ordered zones are in
+  // IJK order, so the vertex index of node (i,j,k) is
+  // i + (j + k * JMAX) * IMAX.
+  const char* line = nullptr;
+  const char* line_end = nullptr;
+  for (int n = 0; n < point_count; n++)
+  {
+    if (!CAnalysisTextParser::GetLine(s, end, line, line_end))
+      return nullptr;
+    for (int v = first; v < variable_count && line; v++)
+    {
+      if (v < 3)
+        line = ParsePointValue(line, line_end, points ? points + 3 * (size_t)n + v : nullptr);
+      else
+        line = ParsePointValue(line, line_end, (channels && channels[v - 3]) ? channels[v - 3] + n : nullptr);
+    }
+    if (nullptr == line)
+      return nullptr;
+  }
+  return s;
+}
+
+/*
+Description:
+  Finds a zone, by its zone number, whose coordinates or
+  connectivity another zone shares.
+Parameters:
+  zones     - [in] the zones of the file, or nullptr.
+  zone_data - [in] the start of each zone's data, or nullptr.
+  zone      - [out] the zone.
+Returns:
+  The start of the zone's data, or nullptr if it was not found.
+*/
+static const char* FindSharedZone(int zone_number, const ON_ClassArray<CTecplotZone>* zones, const ON_SimpleArray<const char*>* zone_data, const CTecplotZone*& zone)
+{
+  zone = nullptr;
+  if (nullptr == zones || nullptr == zone_data || 0 == zones->Count() || zones->Count() != zone_data->Count())
+    return nullptr;
+
+  const int i = zone_number - (*zones)[0].m_index;
+  if (i < 0 || i >= zones->Count())
+    return nullptr;
+
+  zone = zones->At(i);
+  return (*zone_data)[i];
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+CTecplotReader::CTecplotReader()
+  : m_cursor(nullptr)
+  , m_zone_index(0)
+{
+}
+
+bool CTecplotReader::Open(const wchar_t* filename)
+{
+  m_cursor = nullptr;
+  m_zone_index = 0;
+  m_title.Empty();
+  m_variables.Empty();
+  m_filename.Empty();
+  if (!m_file.Open(filename))
+    return false;
+  m_cursor = m_file.Begin();
+  m_filename = filename;
+  return true;
+}
+
+size_t CTecplotReader::FileSize() const
+{
+  return m_file.IsOpen() ? m_file.Size() : 0;
+}
+
+bool CTecplotReader::ReadZoneHeader(const char*& cursor, const char* end, CTecplotZone& zone, ON_wString* title, ON_ClassArray<ON_wString>* variables) const
+{
+  const char* s = cursor;
+  if (nullptr == s)
+    return false;
+
+  for (;;)
+  {
+    s = SkipHeaderSpace(s, end);
+    if (s >= end)
+      return false;
+
+    // The zone data starts with the first number
+    if (IsNumberStart(*s))
+      break;
+
+    // Skip stray strings and characters
+    if (!IsKeywordStart(*s))
+    {
+      const char* value = nullptr;
+      const char* value_end = nullptr;
+      s = ('"' == *s || '(' == *s) ? ReadHeaderValue(s, end, value, value_end) : s + 1;
+      continue;
+    }
+
+    const char* key = s;
+    while (s < end && IsKeywordChar(*s))
+      s++;
+    const char* key_end = s;
+
+    while (s < end && (' ' == *s || '\t' == *s))
+      s++;
+
+    // Records such as ZONE have no value
+    if (s >= end || '=' != *s)
+      continue;
+
+    s = SkipHeaderSpace(s + 1, end);
+    const char* value = nullptr;
+    const char* value_end = nullptr;
+    s = ReadHeaderValue(s, end, value, value_end);
+
+    if (IsKeyword(key, key_end, "VARIABLES"))
+    {
+      if (variables)
+      {
+        variables->Empty();
+        variables->Append(HeaderString(value, value_end));
+      }
+      // The other variable names may follow on the same or the next lines
+      for (;;)
+      {
+        const char* next = SkipHeaderSpace(s, end);
+        if (next >= end || '"' != *next)
+          break;
+        s = ReadHeaderValue(next, end, value, value_end);
+        if (variables)
+          variables->Append(HeaderString(value, value_end));
+      }
+    }
+    else if (IsKeyword(key, key_end, "TITLE"))
+    {
+      if (title)
+        *title = HeaderString(value, value_end);
+    }
+    else if (IsKeyword(key, key_end, "T"))
+      zone.m_title = HeaderString(value, value_end);
+    else if (IsKeyword(key, key_end, "I"))
+      CAnalysisTextParser::ParseInt(value, value_end, zone.m_imax);
+    else if (IsKeyword(key, key_end, "J"))
+      CAnalysisTextParser::ParseInt(value, value_end, zone.m_jmax);
+    else if (IsKeyword(key, key_end, "K"))
+      CAnalysisTextParser::ParseInt(value, value_end, zone.m_kmax);
+    else if (IsKeyword(key, key_end, "N") || IsKeyword(key, key_end, "NODES"))
+      CAnalysisTextParser::ParseInt(value, value_end, zone.m_point_count);
+    else if (IsKeyword(key, key_end, "E") || IsKeyword(key, key_end, "ELEMENTS"))
+      CAnalysisTextParser::ParseInt(value, value_end, zone.m_element_count);
+    else if (IsKeyword(key, key_end, "ZONETYPE") || IsKeyword(key, key_end, "ET"))
+    {
+      if (!ParseZoneType(value, value_end, zone.m_zone_type))
+        return false;
+    }
+    else if (IsKeyword(key, key_end, "DATAPACKING") || IsKeyword(key, key_end, "F"))
+    {
+      // F=FEPOINT and F=FEBLOCK are the old finite element formats
+      zone.m_bBlock = HasKeyword(value, value_end, "BLOCK");
+      if (HasKeyword(value, value_end, "FE") && zone.IsOrdered())
+        zone.m_zone_type = CTecplotZone::fe_quadrilateral;
+    }
+    else if (IsKeyword(key, key_end, "DT"))
+      zone.m_bSingleData = IsSingleData(value, value_end);
+    else if (IsKeyword(key, key_end, "STRANDID"))
+      CAnalysisTextParser::ParseInt(value, value_end, zone.m_strand_id);
+    else if (IsKeyword(key, key_end, "SOLUTIONTIME"))
+      CAnalysisTextParser::ParseDouble(value, value_end, zone.m_solution_time);
+    else if (IsKeyword(key, key_end, "VARSHARELIST"))
+    {
+      // Shared coordinates are read from the zone that has them, but
+      // shared analysis values would make the channels of the zones
+      // the same.
+      if (!ParseVariableSharing(value, value_end, zone))
+        return false;
+    }
+    else if (IsKeyword(key, key_end, "CONNECTIVITYSHAREZONE"))
+    {
+      int connectivity_zone = 0;
+      if (nullptr == CAnalysisTextParser::ParseInt(value, value_end, connectivity_zone))
+        return false;
+      zone.m_bSharedConnectivity = true;
+      zone.m_connectivity_zone = connectivity_zone - 1;
+    }
+    else if (IsKeyword(key, key_end, "VARLOCATION"))
+    {
+      // Only node located values can be mapped to mesh vertices
+      if (HasKeyword(value, value_end, "CELLCENTERED"))
+        return false;
+    }
+  }
+
+  cursor = s;
+
+  return true;
+}
+
+ON_Mesh* CTecplotReader::ReadZone(ON_Mesh* mesh, const CTecplotImportOptions* options)
+{
+  if (mesh)
+    mesh->Destroy();
+
+  if (!m_file.IsOpen())
+    return nullptr;
+
+  const char* s = m_cursor;
+  const char* end = m_file.End();
+
+  CTecplotZone zone;
+  zone.m_index = m_zone_index;
+  if (!ReadZoneHeader(s, end, zone, &m_title, &m_variables))
+    return nullptr;
+
+  mesh = ReadZoneData(s, end, zone, mesh, options, nullptr, nullptr, nullptr);
+  if (mesh)
+  {
+    m_cursor = s;
+    m_zone_index++;
+  }
+
+  return mesh;
+}
+
+bool CTecplotReader::ReadZones(ON_SimpleArray<ON_Mesh*>& meshes, const CTecplotImportOptions* options)
+{
+  if (!m_file.IsOpen())
+    return false;
+
+  const char* begin = m_cursor;
+  const char* end = m_file.End();
+
+  ON_SimpleArray<const char*> bounds;
+  FindZones(begin, end, bounds);
+
+  // Files without ZONE records have one zone
+  if (0 == bounds.Count())
+  {
+    ON_Mesh* mesh = ReadZone(nullptr, options);
+    if (mesh)
+      meshes.Append(mesh);
+    return (nullptr != mesh);
+  }
+
+  // The file header is everything before the first ZONE record
+  CTecplotZone file_header;
+  const char* s = begin;
+  ReadZoneHeader(s, bounds[0], file_header, &m_title, &m_variables);
+
+  // Zone i is the range [bounds[i], bounds[i+1])
+  const int zone_count = bounds.Count();
+  bounds.Append(end);
+
+  // The headers are read first, so the zones of a time series
+  // can be found before any values are read.
+  ON_ClassArray<CTecplotZone> zones(zone_count);
+  ON_SimpleArray<const char*> data(zone_count);
+  int i;
+  for (i = 0; i < zone_count; i++)
+  {
+    zones.AppendNew().m_index = m_zone_index + i;
+    data.Append(nullptr);
+  }
+
+  concurrency::parallel_for(0, zone_count, [&](int i)
+  {
+    const char* zone_s = bounds[i];
+    if (ReadZoneHeader(zone_s, bounds[i + 1], zones[i], nullptr, nullptr))
+      data[i] = zone_s;
+  });
+
+  // Zones that share coordinates or connectivity with a zone that
+  // shares them in turn are read from the zone that has them.
+  for (i = 0; i < zone_count; i++)
+  {
+    CTecplotZone& zone = zones[i];
+    const CTecplotZone* shared_zone = nullptr;
+    if (zone.m_bSharedCoordinates && FindSharedZone(zone.m_coordinates_zone, &zones, &data, shared_zone) && shared_zone->m_index < zone.m_index && shared_zone->m_bSharedCoordinates)
+      zone.m_coordinates_zone = shared_zone->m_coordinates_zone;
+    if (zone.m_bSharedConnectivity && FindSharedZone(zone.m_connectivity_zone, &zones, &data, shared_zone) && shared_zone->m_index < zone.m_index && shared_zone->m_bSharedConnectivity)
+      zone.m_connectivity_zone = shared_zone->m_connectivity_zone;
+  }
+
+  // Without time series, each zone is its own series
+  ON_SimpleArray<int> series(zone_count);
+  if (options && options->m_bTimeSeries)
+    CTecplotZone::FindTimeSeries(zones, series);
+  else
+  {
+    for (i = 0; i < zone_count; i++)
+      series.Append(i);
+  }
+
+  // The later frames of a series are found by the offset of their
+  // ZONE record and read when they are shown.
+  ON_ClassArray<CAnalysisTimeSeries> frames(zone_count);
+  for (i = 0; i < zone_count; i++)
+    frames.AppendNew();
+  for (i = 0; i < zone_count; i++)
+  {
+    if (nullptr == data[i] || nullptr == data[series[i]])
+      continue;
+    CAnalysisTimeSeries& f = frames[series[i]];
+    if (series[i] == i)
+    {
+      f.m_filename = m_filename;
+      f.m_file_type = CAnalysisTimeSeries::tecplot_ascii;
+      f.m_file_size = m_file.Size();
+      f.m_point_count = zones[i].PointCount();
+      f.m_variable_count = m_variables.Count();
+    }
+    f.m_times.Append(zones[i].m_solution_time);
+    f.m_offsets.Append((ON__INT64)(bounds[i] - m_file.Begin()));
+  }
+
+  ON_SimpleArray<ON_Mesh*> zone_meshes(zone_count);
+  zone_meshes.SetCount(zone_count);
+  zone_meshes.Zero();
+
+  concurrency::parallel_for(0, zone_count, [&](int i)
+  {
+    const char* zone_s = data[i];
+    if (zone_s && series[i] == i)
+    {
+      const CAnalysisTimeSeries* zone_frames = (frames[i].FrameCount() > 1) ? &frames[i] : nullptr;
+      zone_meshes[i] = ReadZoneData(zone_s, bounds[i + 1], zones[i], nullptr, options, zone_frames, &zones, &data);
+    }
+  });
+
+  m_cursor = end;
+  m_zone_index += zone_count;
+
+  // The later frames of a series do not have a mesh of their own
+  bool rc = true;
+  for (i = 0; i < zone_count; i++)
+  {
+    if (zone_meshes[i])
+      meshes.Append(zone_meshes[i]);
+    else if (series[i] == i || nullptr == data[i])
+      rc = false;
+  }
+
+  return rc;
+}
+
+bool CTecplotReader::ReadZoneValues(ON__INT64 offset, int point_count, int variable_count, double* values) const
+{
+  if (!m_file.IsOpen() || nullptr == values || offset < 0 || offset >= (ON__INT64)m_file.Size())
+    return false;
+
+  const char* s = m_file.Begin() + offset;
+  const char* end = m_file.End();
+
+  CTecplotZone zone;
+  if (!ReadZoneHeader(s, end, zone, nullptr, nullptr) || zone.PointCount() != point_count)
+    return false;
+
+  // x, y, z and at least one analysis value
+  if (zone.m_bBlock && variable_count < 4)
+    return false;
+
+  // The coordinates are skipped, and the channels are parsed
+  // straight into their columns.
+  const int channel_count = (variable_count > 4) ? variable_count - 3 : 1;
+  ON_SimpleArray<double*> channels(channel_count);
+  for (int c = 0; c < channel_count; c++)
+    channels.Append(values + (size_t)c * point_count);
+
+  return (nullptr != ParseZoneValues(s, end, zone, 3 + channel_count, nullptr, channels.Array()));
+}
+
+ON_Mesh* CTecplotReader::ReadZoneData(const char*& s, const char* end, const CTecplotZone& zone, ON_Mesh* mesh, const CTecplotImportOptions* options, const CAnalysisTimeSeries* frames, const ON_ClassArray<CTecplotZone>* zones, const ON_SimpleArray<const char*>* zone_data) const
+{
+  if (zone.IsOrdered())
+  {
+    if (zone.m_imax <= 0 || zone.m_jmax <= 0 || zone.m_kmax <= 0)
+      return nullptr;
+  }
+  else
+  {
+    // Line segment zones have no faces, and polygon and polyhedron
+    // zones list faces rather than elements.
+    if (zone.m_point_count <= 0 || zone.m_element_count <= 0)
+      return nullptr;
+    if (CTecplotZone::fe_line_segment == zone.m_zone_type || 0 == zone.NodesPerElement())
+      return nullptr;
+  }
+
+  // x, y, z and at least one analysis value
+  if (zone.m_bBlock && m_variables.Count() < 4)
+    return nullptr;
+
+  // Shared coordinates and connectivity are read from the zone that
+  // has them, skipping its analysis values.
+  const CTecplotZone* coordinates_zone = nullptr;
+  const CTecplotZone* connectivity_zone = nullptr;
+  const char* coordinates = nullptr;
+  const char* connectivity = nullptr;
+  if (zone.m_bSharedCoordinates)
+  {
+    coordinates = FindSharedZone(zone.m_coordinates_zone, zones, zone_data, coordinates_zone);
+    if (nullptr == coordinates || coordinates_zone->m_bSharedCoordinates || coordinates_zone->PointCount() != zone.PointCount())
+      return nullptr;
+  }
+  if (zone.m_bSharedConnectivity && !zone.IsOrdered())
+  {
+    connectivity = FindSharedZone(zone.m_connectivity_zone, zones, zone_data, connectivity_zone);
+    if (nullptr == connectivity || connectivity_zone->m_bSharedConnectivity || connectivity_zone->m_zone_type != zone.m_zone_type || connectivity_zone->m_element_count != zone.m_element_count)
+      return nullptr;
+  }
+
+  const bool bNewMesh = (nullptr == mesh);
+  if (bNewMesh)
+    mesh = new ON_Mesh();
+
+  CAnalysisUserData* ud = zone.CreateAnalysisData(m_variables, options);
+
+  const int point_count = zone.PointCount();
+  mesh->m_V.SetCapacity(point_count);
+  mesh->m_V.SetCount(point_count);
+  float* points = &mesh->m_V[0].x;
+
+  // One column for every channel, so each value goes straight to its
+  // channel in the precision the channel is stored in.
+  const int channel_count = ud->ChannelCount() > 0 ? ud->ChannelCount() : 1;
+  const int variable_count = 3 + channel_count;
+  float* zone_points = zone.m_bSharedCoordinates ? nullptr : points;
+  if (ud->m_a.FloatArray())
+  {
+    ON_SimpleArray<float*> channels(channel_count);
+    for (int c = 0; c < channel_count; c++)
+      channels.Append(ud->ChannelFloatValues(c));
+    s = ParseZoneValues(s, end, zone, variable_count, zone_points, channels.Array());
+  }
+  else
+  {
+    ON_SimpleArray<double*> channels(channel_count);
+    for (int c = 0; c < channel_count; c++)
+      channels.Append(ud->ChannelValues(c));
+    s = ParseZoneValues(s, end, zone, variable_count, zone_points, channels.Array());
+  }
+  bool rc = (nullptr != s);
+
+  if (rc && coordinates)
+    rc = (nullptr != ParseZoneValues<double>(coordinates, m_file.End(), *coordinates_zone, variable_count, points, nullptr));
+
+  if (rc)
+  {
+    if (zone.IsOrdered())
+      zone.AddStructuredFaces(mesh, options);
+    else if (connectivity)
+    {
+      // The elements follow the values of the zone
+      connectivity = ParseZoneValues<double>(connectivity, m_file.End(), *connectivity_zone, variable_count, nullptr, nullptr);
+      rc = ReadElements(connectivity, m_file.End(), zone, mesh);
+    }
+    else
+      rc = ReadElements(s, end, zone, mesh);
+  }
+
+  if (!rc)
+  {
+    delete ud;
+    if (bNewMesh)
+      delete mesh;
+    else
+      mesh->Destroy();
+    return nullptr;
+  }
+
+  if (frames)
+    ud->m_frames = *frames;
+
+  zone.AttachAnalysisData(mesh, ud);
+
+  return mesh;
+}
+
+bool CTecplotReader::ReadElements(const char*& cursor, const char* end, const CTecplotZone& zone, ON_Mesh* mesh) const
+{
+  // The connectivity is a block of one based node numbers, one
+  // element per line, that is parsed straight into an index array.
+  const int index_count = zone.m_element_count * zone.NodesPerElement();
+  ON_SimpleArray<int> nodes(index_count);
+  nodes.SetCount(index_count);
+  int* node = nodes.Array();
+
+  const char* s = cursor;
+  for (int i = 0; i < index_count && s; i++)
+  {
+    s = CAnalysisTextParser::SkipWhiteSpace(s, end);
+    s = CAnalysisTextParser::ParseInt(s, end, node[i]);
+    node[i]--;
+  }
+
+  if (nullptr == s)
+    return false;
+
+  cursor = s;
+
+  return zone.AddElementFaces(node, mesh);
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// TecplotReader.h
+
+#pragma once
+
+#include "AnalysisMappedFile.h"
+#include "TecplotZone.h"
+
+class CAnalysisTimeSeries;
+
+// CTecplotReader
+// Reads ASCII Tecplot (.tp) files. The file is mapped into memory
+// and parsed in place as narrow characters.
+//
+
+class CTecplotReader
+{
+public:
+  CTecplotReader();
+  ~CTecplotReader() = default;
+
+  /*
+  Description:
+    Opens a Tecplot file for reading.
+  Parameters:
+    filename - [in] the name of the file to read.
+  Returns:
+    True if successful.
+  */
+  bool Open(const wchar_t* filename);
+
+  // Size of the open file in bytes, or 0 if no file is open.
+  size_t FileSize() const;
+
+  /*
+  Description:
+    Reads the next zone and creates an analysis mesh from it. Ordered
+    (IJK) zones and finite element triangle, quadrilateral,
+    tetrahedron and brick zones, with POINT or BLOCK data packing,
+    are supported. Zones that share coordinates or connectivity with
+    an earlier zone can only be read by ReadZones().
+  Parameters:
+    mesh    - [in] If not null, the mesh to fill in. Otherwise a new
+                   mesh is allocated.
+    options - [in] import options, or nullptr for the defaults.
+  Returns:
+    A pointer to the analysis mesh if successful, or nullptr
+    if the zone could not be read.
+  */
+  ON_Mesh* ReadZone(ON_Mesh* mesh = nullptr, const CTecplotImportOptions* options = nullptr);
+
+  /*
+  Description:
+    Reads all of the remaining zones. The zones are found by their
+    ZONE records and parsed concurrently. Coordinates shared with an
+    earlier zone (VARSHARELIST=) and connectivity shared with an
+    earlier zone (CONNECTIVITYSHAREZONE=) are read from that zone. If options->m_bTimeSeries
+    is true, the zones of a time series, as found by
+    CTecplotZone::FindTimeSeries(), become one mesh whose other frames
+    are read when they are shown.
+  Parameters:
+    meshes  - [out] the analysis meshes of the zones that were read,
+                    in file order, are appended. The caller is
+                    responsible for deleting them.
+    options - [in] import options, or nullptr for the defaults.
+  Returns:
+    True if every zone was read.
+  */
+  bool ReadZones(ON_SimpleArray<ON_Mesh*>& meshes, const CTecplotImportOptions* options = nullptr);
+
+  /*
+  Description:
+    Reads the values of a zone without creating a mesh. Used to read
+    the frames of a time series. Only the zone's record is read, and
+    the coordinates are skipped.
+  Parameters:
+    offset         - [in] the offset of the zone's ZONE record in the file.
+    point_count    - [in] the expected number of nodes in the zone.
+    variable_count - [in] the number of variables in the file header,
+                          as in CAnalysisTimeSeries::m_variable_count.
+    values         - [out] the values of every channel, one column of
+                           point_count values after another.
+  Returns:
+    True if successful.
+  */
+  bool ReadZoneValues(ON__INT64 offset, int point_count, int variable_count, double* values) const;
+
+private:
+  bool ReadZoneHeader(const char*& s, const char* end, CTecplotZone& zone, ON_wString* title, ON_ClassArray<ON_wString>* variables) const;
+  ON_Mesh* ReadZoneData(const char*& s, const char* end, const CTecplotZone& zone, ON_Mesh* mesh, const CTecplotImportOptions* options, const CAnalysisTimeSeries* frames, const ON_ClassArray<CTecplotZone>* zones, const ON_SimpleArray<const char*>* zone_data) const;
+  bool ReadElements(const char*& s, const char* end, const CTecplotZone& zone, ON_Mesh* mesh) const;
+
+private:
+  CAnalysisMappedFile m_file;
+  ON_wString m_filename;
+  const char* m_cursor;
+  int m_zone_index;
+
+  // File header information (TITLE=, VARIABLES=)
+  ON_wString m_title;
+  ON_ClassArray<ON_wString> m_variables;
+};
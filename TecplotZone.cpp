@@ -0,0 +1,533 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// TecplotZone.cpp
+
+#include "stdafx.h"
+#include "TecplotZone.h"
+#include "AnalysisUserData.h"
+#include "TecplotImportOptions.h"
+
+/*
+Description:
+  Adds the quads of one grid plane of an ordered zone.
+Parameters:
+  direction - [in] the grid direction that is constant on the plane:
+                   0 = I (JK quads), 1 = J (IK quads), 2 = K (IJ quads).
+  index     - [in] the zero based index of the plane.
+  bFlip     - [in] if true, the quads are reversed.
+*/
+static void AddPlaneFaces(int IMAX, int JMAX, int KMAX, int direction, int index, bool bFlip, ON_Mesh* mesh)
+{
+  const int dim[3] = { IMAX, JMAX, KMAX };
+  const int step[3] = { 1, IMAX, IMAX * JMAX };
+
+  // u and v are the two directions that vary on the plane
+  const int u = (0 == direction) ? 1 : 0;
+  const int v = (2 == direction) ? 1 : 2;
+  if (index < 0 || index >= dim[direction] || dim[u] < 2 || dim[v] < 2)
+    return;
+
+  mesh->m_F.Reserve(mesh->m_F.Count() + (dim[u] - 1) * (dim[v] - 1));
+
+  const int du = step[u];
+  const int dv = step[v];
+  ON_MeshFace f;
+  for (int b = 1; b < dim[v]; b++)
+  {
+    for (int a = 1; a < dim[u]; a++)
+    {
+      const int vi = index * step[direction] + a * du + b * dv;
+      f.vi[0] = vi - du - dv;
+      f.vi[1] = bFlip ? vi - du : vi - dv;
+      f.vi[2] = vi;
+      f.vi[3] = bFlip ? vi - dv : vi - du;
+      mesh->m_F.Append(f);
+    }
+  }
+}
+
+// Moves the values of the vertices that are kept down.
+template <class T>
+static void CullValues(T* values, const int* vertex_map, int vertex_count)
+{
+  for (int i = 0; i < vertex_count; i++)
+  {
+    if (vertex_map[i] >= 0)
+      values[vertex_map[i]] = values[i];
+  }
+}
+
+/*
+Description:
+  Removes the values of the vertices that are not kept from m_a[] or
+  from one of the arrays in m_channels[].
+Parameters:
+  vertex_map - [in] the new index of each vertex, or -1 if it is removed.
+  count      - [in] number of vertices that are kept.
+*/
+static void CullValues(CAnalysisValues& values, const int* vertex_map, int vertex_count, int count)
+{
+  if (values.Count() != vertex_count)
+    return;
+
+  // The values are in the precision they were read in
+  if (values.FloatArray())
+    CullValues(values.FloatArray(), vertex_map, vertex_count);
+  else if (values.DoubleArray())
+    CullValues(values.DoubleArray(), vertex_map, vertex_count);
+  values.SetCount(count);
+  values.Shrink();
+}
+
+/*
+Description:
+  Removes the vertices that no face uses, along with their values in
+  every analysis channel, and renumbers the faces.
+*/
+static void CullUnusedVertices(ON_Mesh* mesh, CAnalysisUserData* ud)
+{
+  const int vertex_count = mesh->m_V.Count();
+  const int face_count = mesh->m_F.Count();
+  if (0 == face_count || ud->m_a.Count() != vertex_count || nullptr == ud->m_a.Array())
+    return;
+
+  ON_SimpleArray<int> vertex_map(vertex_count);
+  vertex_map.SetCount(vertex_count);
+  for (int i = 0; i < vertex_count; i++)
+    vertex_map[i] = -1;
+
+  int i, j;
+  for (i = 0; i < face_count; i++)
+  {
+    const ON_MeshFace& f = mesh->m_F[i];
+    for (j = 0; j < 4; j++)
+      vertex_map[f.vi[j]] = 0;
+  }
+
+  int count = 0;
+  for (i = 0; i < vertex_count; i++)
+  {
+    if (0 == vertex_map[i])
+    {
+      vertex_map[i] = count;
+      mesh->m_V[count] = mesh->m_V[i];
+      count++;
+    }
+  }
+
+  if (count == vertex_count)
+    return;
+
+  CullValues(ud->m_a, vertex_map.Array(), vertex_count, count);
+  for (i = 0; i < ud->m_channels.Count(); i++)
+    CullValues(ud->m_channels[i], vertex_map.Array(), vertex_count, count);
+
+  // Frames read later are mapped from nodes to the remaining vertices
+  if (ud->m_frames.FrameCount() > 0)
+  {
+    ud->m_frames.m_node_index.SetCapacity(count);
+    ud->m_frames.m_node_index.SetCount(0);
+    for (i = 0; i < vertex_count; i++)
+    {
+      if (vertex_map[i] >= 0)
+        ud->m_frames.m_node_index.Append(i);
+    }
+  }
+
+  mesh->m_V.SetCount(count);
+  mesh->m_V.Shrink();
+
+  for (i = 0; i < face_count; i++)
+  {
+    ON_MeshFace& f = mesh->m_F[i];
+    for (j = 0; j < 4; j++)
+      f.vi[j] = vertex_map[f.vi[j]];
+  }
+}
+
+// The faces of the volume element types, as local node numbers. The
+// faces of an element with Tecplot's node numbering point outwards.
+static const int TETRAHEDRON_FACES[4][4] =
+{
+  { 0, 2, 1, 1 }, { 0, 1, 3, 3 }, { 1, 2, 3, 3 }, { 0, 3, 2, 2 }
+};
+static const int BRICK_FACES[6][4] =
+{
+  { 0, 3, 2, 1 }, { 4, 5, 6, 7 }, { 0, 1, 5, 4 },
+  { 1, 2, 6, 5 }, { 2, 3, 7, 6 }, { 3, 0, 4, 7 }
+};
+
+/*
+Description:
+  Makes a mesh face from the corners of an element face. Tecplot
+  writes prisms, pyramids and tetrahedra as bricks with repeated
+  nodes, so repeated corners are removed.
+Returns:
+  False if fewer than three distinct corners remain.
+*/
+static bool MakeElementFace(const int corners[4], ON_MeshFace& f)
+{
+  int count = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    const int vi = corners[i];
+    if (count > 0 && (vi == f.vi[count - 1] || (3 == i && vi == f.vi[0])))
+      continue;
+    f.vi[count++] = vi;
+  }
+  if (count < 3)
+    return false;
+  if (4 == count && (f.vi[0] == f.vi[2] || f.vi[1] == f.vi[3]))
+    return false;
+  if (3 == count)
+    f.vi[3] = f.vi[2];
+  return true;
+}
+
+// The distinct vertices of a face in increasing order, with -1 in
+// key[3] for triangles, so a face and its reverse have the same key.
+static void GetFaceKey(const ON_MeshFace& f, int key[4])
+{
+  const int count = (f.vi[2] == f.vi[3]) ? 3 : 4;
+  key[3] = -1;
+  for (int i = 0; i < count; i++)
+  {
+    int j = i;
+    for (; j > 0 && key[j - 1] > f.vi[i]; j--)
+      key[j] = key[j - 1];
+    key[j] = f.vi[i];
+  }
+}
+
+static ON__UINT32 FaceKeyHash(const int key[4])
+{
+  ON__UINT32 h = 2166136261u;
+  for (int i = 0; i < 4; i++)
+  {
+    h ^= (ON__UINT32)key[i];
+    h *= 16777619u;
+  }
+  return h ^ (h >> 15);
+}
+
+/*
+Description:
+  Adds the boundary faces of a tetrahedron or brick zone. Every
+  element face goes into a hash table keyed on its vertices. Faces
+  shared by two elements are inside the volume, so only the faces
+  seen once are added, in the order of their elements.
+Parameters:
+  nodes             - [in] zero based node indices, already checked.
+  element_count     - [in] number of elements.
+  nodes_per_element - [in] 4 or 8.
+*/
+static void AddVolumeBoundaryFaces(const int* nodes, int element_count, int nodes_per_element, ON_Mesh* mesh)
+{
+  const int(*element_faces)[4] = (4 == nodes_per_element) ? TETRAHEDRON_FACES : BRICK_FACES;
+  const int faces_per_element = (4 == nodes_per_element) ? 4 : 6;
+
+  // Open addressing, at most half full
+  const int face_count = element_count * faces_per_element;
+  int capacity = 1024;
+  while (capacity < 2 * face_count)
+    capacity *= 2;
+  const ON__UINT32 mask = (ON__UINT32)(capacity - 1);
+
+  // A slot is empty while its count is zero
+  ON_SimpleArray<ON_MeshFace> slots(capacity);
+  slots.SetCount(capacity);
+  ON_SimpleArray<int> slot_counts(capacity);
+  slot_counts.SetCount(capacity);
+  slot_counts.Zero();
+
+  // Slots in the order their faces were first seen
+  ON_SimpleArray<int> order(face_count / 2 + 1);
+
+  ON_MeshFace f;
+  int corners[4], key[4], slot_key[4];
+  for (int e = 0; e < element_count; e++, nodes += nodes_per_element)
+  {
+    for (int n = 0; n < faces_per_element; n++)
+    {
+      for (int c = 0; c < 4; c++)
+        corners[c] = nodes[element_faces[n][c]];
+      if (!MakeElementFace(corners, f))
+        continue;
+
+      GetFaceKey(f, key);
+      int slot = (int)(FaceKeyHash(key) & mask);
+      for (;;)
+      {
+        if (0 == slot_counts[slot])
+        {
+          slots[slot] = f;
+          slot_counts[slot] = 1;
+          order.Append(slot);
+          break;
+        }
+        GetFaceKey(slots[slot], slot_key);
+        if (0 == memcmp(key, slot_key, sizeof(key)))
+        {
+          slot_counts[slot]++;
+          break;
+        }
+        slot = (int)((slot + 1) & mask);
+      }
+    }
+  }
+
+  int boundary_count = 0;
+  for (int i = 0; i < order.Count(); i++)
+  {
+    if (1 == slot_counts[order[i]])
+      boundary_count++;
+  }
+
+  mesh->m_F.Reserve(mesh->m_F.Count() + boundary_count);
+  for (int i = 0; i < order.Count(); i++)
+  {
+    if (1 == slot_counts[order[i]])
+      mesh->m_F.Append(slots[order[i]]);
+  }
+}
+
+CTecplotZone::CTecplotZone()
+  : m_index(0)
+  , m_zone_type(ordered)
+  , m_imax(1)
+  , m_jmax(1)
+  , m_kmax(1)
+  , m_point_count(0)
+  , m_element_count(0)
+  , m_bBlock(false)
+  , m_bSingleData(false)
+  , m_strand_id(0)
+  , m_solution_time(0.0)
+  , m_bSharedCoordinates(false)
+  , m_coordinates_zone(-1)
+  , m_bSharedConnectivity(false)
+  , m_connectivity_zone(-1)
+{
+}
+
+int CTecplotZone::PointCount() const
+{
+  if (IsOrdered())
+    return m_imax * m_jmax * m_kmax;
+  return m_point_count;
+}
+
+bool CTecplotZone::IsOrdered() const
+{
+  return (ordered == m_zone_type);
+}
+
+int CTecplotZone::NodesPerElement() const
+{
+  int rc = 0;
+  switch (m_zone_type)
+  {
+  case fe_line_segment:
+    rc = 2;
+    break;
+  case fe_triangle:
+    rc = 3;
+    break;
+  case fe_quadrilateral:
+  case fe_tetrahedron:
+    rc = 4;
+    break;
+  case fe_brick:
+    rc = 8;
+    break;
+  default:
+    break;
+  }
+  return rc;
+}
+
+void CTecplotZone::AddStructuredFaces(ON_Mesh* mesh, const CTecplotImportOptions* options) const
+{
+  if (nullptr == mesh || !IsOrdered())
+    return;
+
+  const int IMAX = m_imax;
+  const int JMAX = m_jmax;
+  const int KMAX = m_kmax;
+
+  if (options && options->m_bBoundaryOnly)
+  {
+    // The JK, IK and IJ quads of the exterior planes are oriented along
+    // +I, -J and +K, so the planes at the other ends are flipped. A
+    // direction with one node has a single plane, which is not flipped.
+    const int dim[3] = { IMAX, JMAX, KMAX };
+    const bool bFlipFirst[3] = { true, false, true };
+    int direction;
+    for (direction = 0; direction < 3; direction++)
+    {
+      const int last = dim[direction] - 1;
+      AddPlaneFaces(IMAX, JMAX, KMAX, direction, 0, last > 0 && bFlipFirst[direction], mesh);
+      if (last > 0)
+        AddPlaneFaces(IMAX, JMAX, KMAX, direction, last, !bFlipFirst[direction], mesh);
+    }
+
+    for (direction = 0; direction < 3; direction++)
+    {
+      const ON_SimpleArray<int>& slices = options->m_slices[direction];
+      for (int i = 0; i < slices.Count(); i++)
+      {
+        // The exterior planes are already there
+        if (slices[i] > 0 && slices[i] < dim[direction] - 1)
+          AddPlaneFaces(IMAX, JMAX, KMAX, direction, slices[i], false, mesh);
+      }
+    }
+
+    return;
+  }
+
+  const int face_count =
+    (IMAX - 1) * (JMAX - 1) * KMAX +
+    IMAX * (JMAX - 1) * (KMAX - 1) +
+    (IMAX - 1) * JMAX * (KMAX - 1);
+  mesh->m_F.Reserve(mesh->m_F.Count() + face_count);
+
+  const int di = 1;
+  const int dj = IMAX;
+  const int dk = IMAX * JMAX;
+  ON_MeshFace f;
+
+  for (int k = 0; k < KMAX; k++) for (int j = 0; j < JMAX; j++) for (int i = 0; i < IMAX; i++)
+  {
+    const int v = i + (j + k * JMAX) * IMAX;
+    if (i > 0 && j > 0)
+    {
+      f.vi[0] = v - di - dj;
+      f.vi[1] = v - dj;
+      f.vi[2] = v;
+      f.vi[3] = v - di;
+      mesh->m_F.Append(f);
+    }
+    if (j > 0 && k > 0)
+    {
+      f.vi[0] = v - dj - dk;
+      f.vi[1] = v - dk;
+      f.vi[2] = v;
+      f.vi[3] = v - dj;
+      mesh->m_F.Append(f);
+    }
+    if (i > 0 && k > 0)
+    {
+      f.vi[0] = v - di - dk;
+      f.vi[1] = v - dk;
+      f.vi[2] = v;
+      f.vi[3] = v - di;
+      mesh->m_F.Append(f);
+    }
+  }
+}
+
+bool CTecplotZone::AddElementFaces(const int* nodes, ON_Mesh* mesh) const
+{
+  const bool bSurface = (fe_triangle == m_zone_type || fe_quadrilateral == m_zone_type);
+  const bool bVolume = (fe_tetrahedron == m_zone_type || fe_brick == m_zone_type);
+  if (!bSurface && !bVolume)
+    return false;
+
+  const int node_count = NodesPerElement();
+  if (nullptr == nodes || nullptr == mesh)
+    return false;
+
+  const int vertex_count = mesh->m_V.Count();
+  const size_t index_count = (size_t)m_element_count * node_count;
+  for (size_t i = 0; i < index_count; i++)
+  {
+    if (nodes[i] < 0 || nodes[i] >= vertex_count)
+      return false;
+  }
+
+  if (bVolume)
+  {
+    AddVolumeBoundaryFaces(nodes, m_element_count, node_count, mesh);
+    return true;
+  }
+
+  mesh->m_F.Reserve(mesh->m_F.Count() + m_element_count);
+
+  ON_MeshFace f;
+  for (int e = 0; e < m_element_count; e++, nodes += node_count)
+  {
+    for (int n = 0; n < node_count; n++)
+      f.vi[n] = nodes[n];
+    // Triangles repeat the last vertex
+    if (3 == node_count)
+      f.vi[3] = f.vi[2];
+    mesh->m_F.Append(f);
+  }
+
+  return true;
+}
+
+CAnalysisUserData* CTecplotZone::CreateAnalysisData(const ON_ClassArray<ON_wString>& variables, const CTecplotImportOptions* options) const
+{
+  const CAnalysisValues::precision precision = options ? options->ValuePrecision(m_bSingleData) : CAnalysisValues::double_precision;
+
+  CAnalysisUserData* ud = new CAnalysisUserData();
+  const int channel_count = variables.Count() - 3;
+  if (channel_count > 0)
+    ud->CreateChannels(variables.Array() + 3, channel_count, PointCount(), precision);
+  else
+    ud->CreateChannels(nullptr, 0, PointCount(), precision);
+  return ud;
+}
+
+void CTecplotZone::AttachAnalysisData(ON_Mesh* mesh, CAnalysisUserData* ud) const
+{
+  if (nullptr == mesh || nullptr == ud)
+    return;
+
+  CullUnusedVertices(mesh, ud);
+
+  mesh->ComputeVertexNormals();
+
+  ud->ComputeRange(true);
+
+  ud->m_zone_index = m_index;
+  ud->m_zone_type = m_zone_type;
+  ud->m_zone_size[0] = IsOrdered() ? m_imax : m_point_count;
+  ud->m_zone_size[1] = IsOrdered() ? m_jmax : m_element_count;
+  ud->m_zone_size[2] = IsOrdered() ? m_kmax : 0;
+  ud->m_zone_title = m_title;
+  mesh->AttachUserData(ud);
+  CAnalysisUserData::UpdateColors(mesh);
+}
+
+void CTecplotZone::FindTimeSeries(const ON_ClassArray<CTecplotZone>& zones, ON_SimpleArray<int>& series)
+{
+  const int zone_count = zones.Count();
+  series.SetCapacity(zone_count);
+  series.SetCount(zone_count);
+
+  for (int i = 0; i < zone_count; i++)
+  {
+    const CTecplotZone& zone = zones[i];
+    series[i] = i;
+    if (zone.m_strand_id <= 0)
+      continue;
+
+    for (int j = 0; j < i; j++)
+    {
+      // Only the first frame of a series is compared
+      const CTecplotZone& first = zones[j];
+      if (series[j] != j || first.m_strand_id != zone.m_strand_id || first.m_zone_type != zone.m_zone_type)
+        continue;
+      if (first.IsOrdered()
+        ? (first.m_imax == zone.m_imax && first.m_jmax == zone.m_jmax && first.m_kmax == zone.m_kmax)
+        : (first.m_point_count == zone.m_point_count && first.m_element_count == zone.m_element_count))
+      {
+        series[i] = j;
+        break;
+      }
+    }
+  }
+}
@@ -0,0 +1,161 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// TecplotZone.h
+
+#pragma once
+
+class CAnalysisUserData;
+class CTecplotImportOptions;
+
+// CTecplotZone
+// The information read from a Tecplot zone header, shared by the
+// ASCII and binary readers, and the code that turns a zone's nodes
+// into mesh faces.
+//
+
+class CTecplotZone
+{
+public:
+  // Zone types, numbered as in the Tecplot binary file format
+  enum zone_type : int
+  {
+    ordered = 0,
+    fe_line_segment = 1,
+    fe_triangle = 2,
+    fe_quadrilateral = 3,
+    fe_tetrahedron = 4,
+    fe_brick = 5,
+    fe_polygon = 6,
+    fe_polyhedron = 7
+  };
+
+  CTecplotZone();
+
+  // Number of nodes in the zone. IMAX * JMAX * KMAX for ordered
+  // zones, otherwise the finite element node count (N=).
+  int PointCount() const;
+
+  // True for ordered (IJK) zones
+  bool IsOrdered() const;
+
+  // Number of nodes in each element of a finite element zone,
+  // or 0 for ordered, polygon and polyhedron zones.
+  int NodesPerElement() const;
+
+  /*
+  Description:
+    Adds the quads of an ordered zone to a mesh. By default, for each
+    node (i,j,k), the IJ, JK and IK quads that end at the node are added,
+    in that order. If options->m_bBoundaryOnly is true, only the quads on
+    the six exterior planes of the block and on the requested slice
+    planes are added, oriented so the exterior normals agree.
+  Parameters:
+    mesh    - [in] the mesh, whose m_V[] holds the zone's nodes in IJK order.
+    options - [in] import options, or nullptr for the defaults.
+  */
+  void AddStructuredFaces(ON_Mesh* mesh, const CTecplotImportOptions* options = nullptr) const;
+
+  /*
+  Description:
+    Adds the faces of a finite element zone to a mesh. Triangle and
+    quadrilateral elements become faces. Tetrahedron and brick zones
+    are reduced to the element faces on the boundary of the volume.
+  Parameters:
+    nodes - [in] zero based node indices, NodesPerElement() for
+                 each of the zone's m_element_count elements.
+    mesh  - [in] the mesh, whose m_V[] holds the zone's nodes.
+  Returns:
+    True if successful. False if the zone type has no faces, such
+    as line segments, or a node index is out of range.
+  */
+  bool AddElementFaces(const int* nodes, ON_Mesh* mesh) const;
+
+  /*
+  Description:
+    Creates the analysis data for the zone's nodes, with one channel
+    for each variable that follows x, y and z.
+  Parameters:
+    variables - [in] the variable names from the file header.
+    options   - [in] import options, or nullptr for the defaults.
+  Returns:
+    The analysis data, with m_a[] and m_channels[] sized to hold a
+    value for each node, in the precision chosen by
+    options->ValuePrecision(), so readers write the values in their
+    final precision. The caller is responsible for deleting it.
+  */
+  CAnalysisUserData* CreateAnalysisData(const ON_ClassArray<ON_wString>& variables, const CTecplotImportOptions* options) const;
+
+  /*
+  Description:
+    Finishes a mesh read from a zone: removes vertices that no face
+    uses, such as the interior nodes of a zone read as a boundary
+    surface, computes the value range and vertex normals, records
+    the zone information on the analysis data, attaches it and sets
+    the colors.
+  Parameters:
+    mesh - [in] the mesh.
+    ud   - [in] the analysis data from CreateAnalysisData(), one value
+                for each mesh vertex. The mesh takes ownership.
+  */
+  void AttachAnalysisData(ON_Mesh* mesh, CAnalysisUserData* ud) const;
+
+  /*
+  Description:
+    Groups the zones of a file into time series. Zones with the same
+    positive strand ID and the same type and dimensions are the frames
+    of one series, in file order. Zones without a strand ID, or with
+    strand ID 0, are static and stay separate meshes.
+  Parameters:
+    zones  - [in] the zones of a file.
+    series - [out] for each zone, the index of the first zone of
+                   its series, which is the zone itself if it is
+                   the first or only frame.
+  */
+  static void FindTimeSeries(const ON_ClassArray<CTecplotZone>& zones, ON_SimpleArray<int>& series);
+
+  // Zero based zone number in the file
+  int m_index;
+
+  // Zone title (T=)
+  ON_wString m_title;
+
+  zone_type m_zone_type;
+
+  // Ordered zone dimensions (I=, J=, K=). Tecplot defaults
+  // omitted dimensions to 1.
+  int m_imax;
+  int m_jmax;
+  int m_kmax;
+
+  // Finite element zone node and element counts (N=, E=)
+  int m_point_count;
+  int m_element_count;
+
+  // True if the zone uses BLOCK data packing, where each variable
+  // is a contiguous column of values. False for POINT data packing,
+  // where each node is a line of values.
+  bool m_bBlock;
+
+  // True if every analysis variable is single precision or narrower
+  // in the file (DT=), so its values can be stored as floats.
+  bool m_bSingleData;
+
+  // Time series strand (STRANDID=), or 0 if the zone is static,
+  // and solution time (SOLUTIONTIME=)
+  int m_strand_id;
+  double m_solution_time;
+
+  // True if the zone's x, y and z values are those of another zone
+  // (VARSHARELIST=), so they are not in the zone's data, and the
+  // zero based number of that zone. Sharing of the analysis
+  // variables is not supported.
+  bool m_bSharedCoordinates;
+  int m_coordinates_zone;
+
+  // True if a finite element zone's connectivity is that of another
+  // zone (CONNECTIVITYSHAREZONE=), so it is not in the zone's data,
+  // and the zero based number of that zone.
+  bool m_bSharedConnectivity;
+  int m_connectivity_zone;
+};
@@ -54,19 +54,25 @@ public:
   CRhinoCommand::result RunCommand(const CRhinoCommandContext&) override;
 
 private:
+  CRhinoCommand::result GetChannel(
+    const ON_SimpleArray<const CRhinoMeshObject*>& mesh_objects
+  );
+
   CRhinoCommand::result GetDialogParameters(
     CRhinoDoc& doc,
     const ON_SimpleArray<const CRhinoMeshObject*>& mesh_objects,
     const ON_Interval& minmax,
     const ON_Interval& old_redblue,
-    ON_Interval& redblue
+    ON_Interval& redblue,
+    CAnalysisColorMap& color_map
   );
 
   CRhinoCommand::result GetScriptParameters(
     const ON_SimpleArray<const CRhinoMeshObject*>& mesh_objects,
     const ON_Interval& minmax,
     const ON_Interval& old_redblue,
-    ON_Interval& redblue
+    ON_Interval& redblue,
+    CAnalysisColorMap& color_map
   );
 };
 
@@ -82,86 +88,165 @@ CRhinoCommand::result CCommandAnalyzeMesh::RunCommand(const CRhinoCommandContext
   if (go.CommandResult() != success)
     return go.CommandResult();
 
-  int i, ud_count = 0;
+  int i;
   ON_Interval minmax, redblue;
 
   ON_SimpleArray<const CRhinoMeshObject*> mesh_objects(go.ObjectCount());
   for (i = 0; i < go.ObjectCount(); i++)
   {
     const CRhinoMeshObject* mesh_object = CRhinoMeshObject::Cast(go.Object(i).Object());
-    if (mesh_object)
-    {
-      const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh_object->Mesh());
-      if (ud)
-      {
-        if (0 == ud_count)
-        {
-          minmax = ud->m_minmax;
-          redblue[0] = ud->m_redblue[0];
-          redblue[1] = ud->m_redblue[1];
-        }
-        else
-        {
-          minmax.Union(ud->m_minmax);
-          if (redblue[0] != ud->m_redblue[0])
-            redblue[0] = ON_UNSET_VALUE;
-          if (redblue[1] != ud->m_redblue[1])
-            redblue[1] = ON_UNSET_VALUE;
-        }
-        ud_count++;
-
-        mesh_objects.Append(mesh_object);
-      }
-    }
+    if (mesh_object && CAnalysisUserData::Get(mesh_object->Mesh()))
+      mesh_objects.Append(mesh_object);
   }
 
   if (0 == mesh_objects.Count())
     return failure;
 
+  CRhinoCommand::result rc = GetChannel(mesh_objects);
+  if (rc != success)
+    return rc;
+
+  for (i = 0; i < mesh_objects.Count(); i++)
+  {
+    const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh_objects[i]->Mesh());
+    if (0 == i)
+    {
+      minmax = ud->m_minmax;
+      redblue[0] = ud->m_redblue[0];
+      redblue[1] = ud->m_redblue[1];
+    }
+    else
+    {
+      minmax.Union(ud->m_minmax);
+      if (redblue[0] != ud->m_redblue[0])
+        redblue[0] = ON_UNSET_VALUE;
+      if (redblue[1] != ud->m_redblue[1])
+        redblue[1] = ON_UNSET_VALUE;
+    }
+  }
+
   ON_Interval old_redblue = redblue;
 
-  CRhinoCommand::result rc = cancel;
+  // The color map of the first mesh is offered. The maps are saved,
+  // since the dialog changes them as it runs.
+  ON_ClassArray<CAnalysisColorMap> old_color_maps(mesh_objects.Count());
+  for (i = 0; i < mesh_objects.Count(); i++)
+    old_color_maps.Append(CAnalysisUserData::Get(mesh_objects[i]->Mesh())->m_color_map);
+  CAnalysisColorMap color_map = old_color_maps[0];
+
+  rc = cancel;
   if (context.IsInteractive())
-    rc = GetDialogParameters(context.m_doc, mesh_objects, minmax, old_redblue, redblue);
+    rc = GetDialogParameters(context.m_doc, mesh_objects, minmax, old_redblue, redblue, color_map);
   else
-    rc = GetScriptParameters(mesh_objects, minmax, old_redblue, redblue);
+    rc = GetScriptParameters(mesh_objects, minmax, old_redblue, redblue, color_map);
 
   ON_Interval colors = (rc == success ? redblue : old_redblue);
 
+  // A map that was not changed leaves each mesh with its own map
+  const bool bNewColorMap = (rc == success && color_map != old_color_maps[0]);
+
+  // The colors of all of the meshes are computed together, on
+  // every processor, before the views are redrawn.
+  ON_SimpleArray<ON_Mesh*> meshes(mesh_objects.Count());
   for (i = 0; i < mesh_objects.Count(); i++)
   {
     ON_Mesh* mesh = const_cast<ON_Mesh*>(mesh_objects[i]->Mesh());
     if (mesh)
     {
-      const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh);
+      CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
       if (ud)
       {
-        if (ON_UNSET_VALUE != colors[0] || ON_UNSET_VALUE != colors[1])
-        {
-          ON_Interval new_redblue = ud->m_redblue;
-          if (ON_UNSET_VALUE != colors[0])
-            new_redblue[0] = colors[0];
-          if (ON_UNSET_VALUE != colors[1])
-            new_redblue[1] = colors[1];
-
-          const_cast<CAnalysisUserData*>(ud)->m_redblue = new_redblue;
-          CAnalysisUserData::UpdateColors(mesh);
-        }
+        ON_Interval new_redblue = ud->m_redblue;
+        if (ON_UNSET_VALUE != colors[0])
+          new_redblue[0] = colors[0];
+        if (ON_UNSET_VALUE != colors[1])
+          new_redblue[1] = colors[1];
+
+        ud->m_redblue = new_redblue;
+        ud->m_color_map = bNewColorMap ? color_map : old_color_maps[i];
+        meshes.Append(mesh);
       }
     }
   }
 
+  CAnalysisUserData::UpdateColors(meshes);
+
   context.m_doc.Regen();
 
   return rc;
 }
 
+CRhinoCommand::result CCommandAnalyzeMesh::GetChannel(
+  const ON_SimpleArray<const CRhinoMeshObject*>& mesh_objects
+)
+{
+  // The variables of the first mesh are offered
+  const CAnalysisUserData* first_ud = CAnalysisUserData::Get(mesh_objects[0]->Mesh());
+  if (nullptr == first_ud || first_ud->ChannelCount() < 2)
+    return success;
+
+  int i;
+  ON_wString names;
+  for (i = 0; i < first_ud->ChannelCount(); i++)
+  {
+    if (i > 0)
+      names += L", ";
+    names += first_ud->ChannelName(i);
+  }
+  RhinoApp().Print(RHSTR(L"Analysis variables: %s\n"), static_cast<const wchar_t*>(names));
+
+  ON_wString name = first_ud->ChannelName(first_ud->m_active_channel);
+  for (;;)
+  {
+    CRhinoGetString gs;
+    gs.SetCommandPrompt(RHSTR(L"Variable to display"));
+    gs.SetDefaultString(name);
+    gs.AcceptNothing();
+    gs.GetString();
+    if (gs.CommandResult() != success)
+      return gs.CommandResult();
+
+    if (CRhinoGet::string != gs.Result())
+      break;
+
+    ON_wString str(gs.String());
+    str.TrimLeftAndRight();
+    if (first_ud->FindChannel(str) >= 0)
+    {
+      name = str;
+      break;
+    }
+
+    RhinoApp().Print(RHSTR(L"Unknown variable \"%s\".\n"), static_cast<const wchar_t*>(str));
+  }
+
+  // Switching only recomputes the colors. Meshes without the
+  // variable keep the one they have.
+  ON_SimpleArray<ON_Mesh*> meshes(mesh_objects.Count());
+  for (i = 0; i < mesh_objects.Count(); i++)
+  {
+    ON_Mesh* mesh = const_cast<ON_Mesh*>(mesh_objects[i]->Mesh());
+    CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
+    if (nullptr == ud)
+      continue;
+
+    const int channel = ud->FindChannel(name);
+    if (channel >= 0 && channel != ud->m_active_channel && ud->SetActiveChannel(channel))
+      meshes.Append(mesh);
+  }
+
+  CAnalysisUserData::UpdateColors(meshes);
+
+  return success;
+}
+
 CRhinoCommand::result CCommandAnalyzeMesh::GetDialogParameters(
   CRhinoDoc& doc,
   const ON_SimpleArray<const CRhinoMeshObject*>& mesh_objects,
   const ON_Interval& minmax,
   const ON_Interval& old_redblue,
-  ON_Interval& redblue
+  ON_Interval& redblue,
+  CAnalysisColorMap& color_map
 )
 {
   RhinoApp().Print(RHSTR(L"Analysis parameter varies from %g to %g.\n"), minmax[0], minmax[1]);
@@ -170,6 +255,7 @@ CRhinoCommand::result CCommandAnalyzeMesh::GetDialogParameters(
   dlg.m_minmax = minmax;
   dlg.m_range1 = old_redblue[0];
   dlg.m_range2 = old_redblue[1];
+  dlg.m_color_map = color_map;
 
   int i;
   for (i = 0; i < mesh_objects.Count(); i++)
@@ -182,6 +268,7 @@ CRhinoCommand::result CCommandAnalyzeMesh::GetDialogParameters(
 
   redblue[0] = dlg.m_range1;
   redblue[1] = dlg.m_range2;
+  color_map = dlg.m_color_map;
 
   if (rc == IDCANCEL)
     return cancel;
@@ -193,13 +280,18 @@ CRhinoCommand::result CCommandAnalyzeMesh::GetScriptParameters(
   const ON_SimpleArray<const CRhinoMeshObject*>& mesh_objects,
   const ON_Interval& minmax,
   const ON_Interval& old_redblue,
-  ON_Interval& redblue
+  ON_Interval& redblue,
+  CAnalysisColorMap& color_map
 )
 {
   RhinoApp().Print(RHSTR(L"Analysis parameter varies from %g to %g.\n"), minmax[0], minmax[1]);
 
   redblue = old_redblue;
 
+  // A custom map can only be kept; new custom maps are set by script.
+  const bool bCustom = (CAnalysisColorMap::custom == color_map.m_type);
+  const CAnalysisColorMap custom_map = color_map;
+
   for (;;)
   {
     CRhinoGetOption go;
@@ -214,10 +306,25 @@ CRhinoCommand::result CCommandAnalyzeMesh::GetScriptParameters(
       ? go.AddCommandOptionNumber(RHCMDOPTNAME(L"Blue"), &redblue[1], RHSTR(L"Blue"))
       : go.AddCommandOption(RHCMDOPTNAME(L"Blue"), RHCMDOPTVALUE(L"varies"));
 
+    // The list is in CAnalysisColorMap::map_type order
+    ON_ClassArray<CRhinoCommandOptionValue> maps;
+    maps.Append(RHCMDOPTVALUE(L"Rainbow"));
+    maps.Append(RHCMDOPTVALUE(L"Viridis"));
+    maps.Append(RHCMDOPTVALUE(L"Turbo"));
+    maps.Append(RHCMDOPTVALUE(L"CoolWarm"));
+    if (bCustom)
+      maps.Append(RHCMDOPTVALUE(L"Custom"));
+    int map_opt = go.AddCommandOptionList(RHCMDOPTNAME(L"ColorMap"), maps, (int)color_map.m_type);
+
+    int band_count = color_map.m_band_count;
+    go.AddCommandOptionInteger(RHCMDOPTNAME(L"Bands"), &band_count, RHSTR(L"Number of bands, 0 for continuous colors"), 0, CAnalysisColorMap::max_band_count);
+
     go.GetOption();
     if (go.CommandResult() != success)
       return go.CommandResult();
 
+    color_map.m_band_count = band_count;
+
     if (CRhinoGet::option == go.Result())
     {
       const CRhinoCommandOption* opt = go.Option();
@@ -241,6 +348,18 @@ CRhinoCommand::result CCommandAnalyzeMesh::GetScriptParameters(
             return gn.CommandResult();
           redblue[1] = gn.Number();
         }
+        else if (map_opt == opt->m_option_index)
+        {
+          const int type = opt->m_list_option_current;
+          if (CAnalysisColorMap::custom == type)
+            color_map = custom_map;
+          else
+          {
+            color_map.m_type = (CAnalysisColorMap::map_type)type;
+            color_map.m_colors.Destroy();
+          }
+          color_map.m_band_count = band_count;
+        }
       }
     }
     else
@@ -0,0 +1,188 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// cmdAnalyzeMeshFrames.cpp
+
+#include "StdAfx.h"
+#include "AnalysisUserData.h"
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// BEGIN AnalyzeMeshFrames command
+//
+
+#pragma region AnalyzeMeshFrames command
+
+class CAnalysisFramesPicker : public CRhinoGetObject
+{
+public:
+  bool CustomGeometryFilter(
+    const CRhinoObject* object,
+    const ON_Geometry* geometry,
+    ON_COMPONENT_INDEX component_index
+  )
+    const
+  {
+    bool rc = false;
+    if (object)
+    {
+      const CRhinoMeshObject* mesh_object = CRhinoMeshObject::Cast(object);
+      if (mesh_object)
+      {
+        const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh_object->Mesh());
+        if (ud && ud->m_frames.FrameCount() > 0)
+          rc = true;
+      }
+    }
+    return rc;
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+class CCommandAnalyzeMeshFrames : public CRhinoCommand
+{
+public:
+  CCommandAnalyzeMeshFrames() = default;
+  ~CCommandAnalyzeMeshFrames() = default;
+  UUID CommandUUID() override
+  {
+    // {688F80F4-1CD3-4BE1-ACCD-16B2EA50D19E}
+    static const GUID AnalyzeMeshFramesCommand_UUID =
+    { 0x688F80F4, 0x1CD3, 0x4BE1, { 0xAC, 0xCD, 0x16, 0xB2, 0xEA, 0x50, 0xD1, 0x9E } };
+    return AnalyzeMeshFramesCommand_UUID;
+  }
+  const wchar_t* EnglishCommandName() override { return L"AnalyzeMeshFrames"; }
+  CRhinoCommand::result RunCommand(const CRhinoCommandContext&) override;
+
+private:
+  void ShowFrame(
+    CRhinoDoc& doc,
+    const ON_SimpleArray<const CRhinoMeshObject*>& mesh_objects,
+    int frame
+  );
+};
+
+// The one and only CCommandAnalyzeMeshFrames object
+static class CCommandAnalyzeMeshFrames theAnalyzeMeshFramesCommand;
+
+CRhinoCommand::result CCommandAnalyzeMeshFrames::RunCommand(const CRhinoCommandContext& context)
+{
+  CAnalysisFramesPicker go;
+  go.SetCommandPrompt(RHSTR(L"Select time series analysis meshes"));
+  go.SetGeometryFilter(CRhinoGetObject::mesh_object);
+  go.GetObjects(1, 0);
+  if (go.CommandResult() != success)
+    return go.CommandResult();
+
+  int i;
+  int frame_count = 0;
+
+  ON_SimpleArray<const CRhinoMeshObject*> mesh_objects(go.ObjectCount());
+  for (i = 0; i < go.ObjectCount(); i++)
+  {
+    const CRhinoMeshObject* mesh_object = CRhinoMeshObject::Cast(go.Object(i).Object());
+    const CAnalysisUserData* ud = mesh_object ? CAnalysisUserData::Get(mesh_object->Mesh()) : nullptr;
+    if (ud && ud->m_frames.FrameCount() > 0)
+    {
+      mesh_objects.Append(mesh_object);
+      if (ud->m_frames.FrameCount() > frame_count)
+        frame_count = ud->m_frames.FrameCount();
+    }
+  }
+
+  if (0 == mesh_objects.Count())
+    return failure;
+
+  // Frames are numbered from 1 on the command line
+  const CAnalysisUserData* first_ud = CAnalysisUserData::Get(mesh_objects[0]->Mesh());
+  int frame = first_ud->m_frames.m_current_frame;
+  RhinoApp().Print(RHSTR(L"Time series has %d frames.\n"), frame_count);
+
+  for (;;)
+  {
+    int number = frame + 1;
+
+    CRhinoGetOption gf;
+    gf.SetCommandPrompt(RHSTR(L"Frame to display"));
+    gf.AcceptNothing();
+
+    const int first_opt = gf.AddCommandOption(RHCMDOPTNAME(L"First"));
+    const int previous_opt = gf.AddCommandOption(RHCMDOPTNAME(L"Previous"));
+    const int next_opt = gf.AddCommandOption(RHCMDOPTNAME(L"Next"));
+    const int last_opt = gf.AddCommandOption(RHCMDOPTNAME(L"Last"));
+    const int frame_opt = gf.AddCommandOptionInteger(RHCMDOPTNAME(L"Frame"), &number, RHSTR(L"Frame number"), 1, frame_count);
+
+    gf.GetOption();
+    if (gf.CommandResult() != success)
+      return gf.CommandResult();
+
+    if (CRhinoGet::option != gf.Result())
+      break;
+
+    const CRhinoCommandOption* opt = gf.Option();
+    if (nullptr == opt)
+      continue;
+
+    if (first_opt == opt->m_option_index)
+      frame = 0;
+    else if (previous_opt == opt->m_option_index)
+      frame = (frame > 0) ? frame - 1 : 0;
+    else if (next_opt == opt->m_option_index)
+      frame = (frame < frame_count - 1) ? frame + 1 : frame_count - 1;
+    else if (last_opt == opt->m_option_index)
+      frame = frame_count - 1;
+    else if (frame_opt == opt->m_option_index)
+      frame = number - 1;
+
+    ShowFrame(context.m_doc, mesh_objects, frame);
+  }
+
+  return success;
+}
+
+void CCommandAnalyzeMeshFrames::ShowFrame(
+  CRhinoDoc& doc,
+  const ON_SimpleArray<const CRhinoMeshObject*>& mesh_objects,
+  int frame
+)
+{
+  // Only the values change, so the colors are recomputed in place.
+  // Meshes with fewer frames keep the frame they show.
+  double time = ON_UNSET_VALUE;
+  ON_SimpleArray<ON_Mesh*> meshes(mesh_objects.Count());
+  for (int i = 0; i < mesh_objects.Count(); i++)
+  {
+    ON_Mesh* mesh = const_cast<ON_Mesh*>(mesh_objects[i]->Mesh());
+    CAnalysisUserData* ud = const_cast<CAnalysisUserData*>(CAnalysisUserData::Get(mesh));
+    if (nullptr == ud || frame >= ud->m_frames.FrameCount() || frame == ud->m_frames.m_current_frame)
+      continue;
+
+    if (ud->SetFrame(frame))
+    {
+      meshes.Append(mesh);
+      if (ON_UNSET_VALUE == time)
+        time = ud->m_frames.m_times[frame];
+    }
+    else
+    {
+      RhinoApp().Print(RHSTR(L"Unable to read frame %d from \"%s\".\n"), frame + 1, static_cast<const wchar_t*>(ud->m_frames.m_filename));
+    }
+  }
+
+  CAnalysisUserData::UpdateColors(meshes);
+
+  if (ON_UNSET_VALUE != time)
+    RhinoApp().Print(RHSTR(L"Frame %d, solution time %g.\n"), frame + 1, time);
+
+  doc.Regen();
+}
+
+#pragma endregion
+
+//
+// END AnalyzeMeshFrames command
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
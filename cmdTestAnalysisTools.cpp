@@ -0,0 +1,92 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// cmdTestAnalysisTools.cpp
+
+#include "StdAfx.h"
+#include "AnalysisTest.h"
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// BEGIN TestAnalysisTools command
+//
+
+#pragma region TestAnalysisTools command
+
+// Prints the test results on the command line as they are written
+class CAnalysisTestLog : public ON_TextLog
+{
+protected:
+  void AppendText(const wchar_t* s) override
+  {
+    if (s && s[0])
+      RhinoApp().Print(L"%s", s);
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+class CCommandTestAnalysisTools : public CRhinoCommand
+{
+public:
+  CCommandTestAnalysisTools() = default;
+  ~CCommandTestAnalysisTools() = default;
+  UUID CommandUUID() override
+  {
+    // {588EC560-B768-4DB8-9064-785E5940CB39}
+    static const GUID TestAnalysisToolsCommand_UUID =
+    { 0x588EC560, 0xB768, 0x4DB8, { 0x90, 0x64, 0x78, 0x5E, 0x59, 0x40, 0xCB, 0x39 } };
+    return TestAnalysisToolsCommand_UUID;
+  }
+  const wchar_t* EnglishCommandName() override { return L"TestAnalysisTools"; }
+  CRhinoCommand::result RunCommand(const CRhinoCommandContext&) override;
+
+private:
+  // CAnalysisTest::test_type, or -1 for every test
+  int m_type = CAnalysisTest::check_test;
+};
+
+// The one and only CCommandTestAnalysisTools object
+static class CCommandTestAnalysisTools theTestAnalysisToolsCommand;
+
+CRhinoCommand::result CCommandTestAnalysisTools::RunCommand(const CRhinoCommandContext& context)
+{
+  for (;;)
+  {
+    CRhinoGetOption go;
+    go.SetCommandPrompt(RHSTR(L"Analysis tools tests"));
+    go.AcceptNothing();
+
+    // The list is in test_type order, followed by all
+    ON_ClassArray<CRhinoCommandOptionValue> types;
+    types.Append(RHCMDOPTVALUE(L"Checks"));
+    types.Append(RHCMDOPTVALUE(L"Benchmarks"));
+    types.Append(RHCMDOPTVALUE(L"All"));
+    const int run_opt = go.AddCommandOptionList(RHCMDOPTNAME(L"Run"), types, m_type < 0 ? 2 : m_type);
+
+    go.GetOption();
+    if (go.CommandResult() != success)
+      return go.CommandResult();
+
+    if (CRhinoGet::option != go.Result())
+      break;
+
+    const CRhinoCommandOption* opt = go.Option();
+    if (opt && run_opt == opt->m_option_index)
+      m_type = (2 == opt->m_list_option_current) ? -1 : opt->m_list_option_current;
+  }
+
+  CAnalysisTestLog log;
+  const int failure_count = CAnalysisTest::RunTests(m_type, log);
+
+  return failure_count ? failure : success;
+}
+
+#pragma endregion
+
+//
+// END TestAnalysisTools command
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
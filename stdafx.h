@@ -50,6 +50,8 @@
 #include <afxcmn.h>                              // MFC support for Windows Common Controls
 #endif // _AFX_NO_AFXCMN_SUPPORT
 
+#include <ppl.h>                                 // Parallel Patterns Library
+
 const wchar_t* RHSTR(const wchar_t* s);
 const wchar_t* RHSTR_LIT(const wchar_t* s);
 
@@ -0,0 +1,373 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// testAnalysisColorTable.cpp
+
+#include "stdafx.h"
+#include "AnalysisTest.h"
+#include "AnalysisColorTable.h"
+#include "AnalysisTexture.h"
+#include <algorithm>
+
+/*
+Description:
+  The color of a value as CAnalysisUserData::Color() computed it before
+  the color table, with an HSV conversion for every value.
+*/
+static ON_Color HSVColor(double a, const ON_Interval& redblue)
+{
+  ON_Color c;
+  if (redblue[0] == redblue[1])
+  {
+    const double s = redblue[0];
+    if (a < s)
+      c.SetRGB(255, 0, 0);
+    else if (a > s)
+      c.SetRGB(0, 0, 255);
+    else
+      c.SetRGB(0, 255, 0);
+  }
+  else
+  {
+    double s = redblue.NormalizedParameterAt(a);
+    if (s < 0.0)
+      s = 0.0;
+    else if (s > 1.0)
+      s = 1.0;
+    c.SetHSV(s * 4.0 * ON_PI / 3.0, 1.0, 1.0);
+  }
+  return c;
+}
+
+// The largest difference of the red, green and blue of two colors
+static int ColorDifference(const ON_Color& a, const ON_Color& b)
+{
+  const int dr = abs(a.Red() - b.Red());
+  const int dg = abs(a.Green() - b.Green());
+  const int db = abs(a.Blue() - b.Blue());
+  return dr > dg ? (dr > db ? dr : db) : (dg > db ? dg : db);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// The default table colors values as the HSV conversion did
+class CAnalysisColorTableTest : public CAnalysisTest
+{
+public:
+  CAnalysisColorTableTest() : CAnalysisTest(L"Analysis color table", check_test) {}
+
+protected:
+  void Run() override
+  {
+    const CAnalysisColorTable& table = CAnalysisColorTable::Default();
+    const ON_Interval redblue(-2.0, 3.0);
+
+    // Values from below the range to above it
+    const int count = 100001;
+    ON_SimpleArray<double> values(count);
+    ON_SimpleArray<float> float_values(count);
+    for (int i = 0; i < count; i++)
+    {
+      const double a = -3.0 + 7.0 * i / (count - 1);
+      values.Append(a);
+      float_values.Append((float)a);
+    }
+
+    ON_SimpleArray<ON_Color> colors(count), float_colors(count);
+    colors.SetCount(count);
+    float_colors.SetCount(count);
+    table.MapValues(values.Array(), count, redblue, colors.Array());
+    table.MapValues(float_values.Array(), count, redblue, float_colors.Array());
+
+    int largest_difference = 0;
+    int float_different_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+      const int difference = ColorDifference(colors[i], HSVColor(values[i], redblue));
+      if (difference > largest_difference)
+        largest_difference = difference;
+      if (ColorDifference(float_colors[i], HSVColor(float_values[i], redblue)) > 1)
+        float_different_count++;
+    }
+    Check(largest_difference <= 1, L"colors are within one level of the HSV colors");
+    Check(0 == float_different_count, L"float colors are within one level of the HSV colors");
+    Check(colors[0] == table.Colors()[0] && colors[count - 1] == table.Colors()[CAnalysisColorTable::color_count - 1], L"values outside of the range are clamped");
+
+    // NaN is the start of the map
+    const double nan = ON_DBL_QNAN;
+    ON_Color nan_color;
+    table.MapValues(&nan, 1, redblue, &nan_color);
+    Check(nan_color == table.Colors()[0], L"NaN is the first color");
+
+    // An empty range is red below, green at and blue above the value
+    const double empty_values[3] = { 0.5, 1.0, 1.5 };
+    ON_Color empty_colors[3];
+    table.MapValues(empty_values, 3, ON_Interval(1.0, 1.0), empty_colors);
+    Check(empty_colors[0] == ON_Color(255, 0, 0) && empty_colors[1] == ON_Color(0, 255, 0) && empty_colors[2] == ON_Color(0, 0, 255), L"empty range");
+
+    // A table is built once for each map
+    CAnalysisColorMap map;
+    map.m_type = CAnalysisColorMap::viridis;
+    Check(&CAnalysisColorTable::Get(map) == &CAnalysisColorTable::Get(map), L"tables are shared");
+    Check(&CAnalysisColorTable::Get(CAnalysisColorMap()) == &table, L"the default table is shared");
+  }
+};
+
+// The one and only CAnalysisColorTableTest test
+static class CAnalysisColorTableTest theAnalysisColorTableTest;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// True if a file exists
+static bool FileExists(const wchar_t* filename)
+{
+  FILE* fp = ON::OpenFile(filename, L"rb");
+  if (nullptr == fp)
+    return false;
+  ON::CloseFile(fp);
+  return true;
+}
+
+// A custom map that is different for every index
+static CAnalysisColorMap CustomMap(int index)
+{
+  const ON_Color colors[2] = { ON_Color(index % 256, 0, 0), ON_Color(0, (index / 256) % 256, 255) };
+  CAnalysisColorMap map;
+  map.SetCustomColors(colors, 2);
+  return map;
+}
+
+// The tables and bitmaps of custom maps that no mesh uses are deleted,
+// so a script that sets many custom maps does not fill up memory or
+// the temporary folder
+class CAnalysisCustomTableTest : public CAnalysisTest
+{
+public:
+  CAnalysisCustomTableTest() : CAnalysisTest(L"Analysis custom color tables", check_test) {}
+
+protected:
+  void Run() override
+  {
+    // A table that a mesh is colored with, and one that nothing uses
+    const CAnalysisColorTable& used = CAnalysisColorTable::Get(CustomMap(1000));
+    CAnalysisColorTable::AddRef(&used);
+    ON_wString used_filename, unused_filename;
+    const bool rc = CAnalysisTexture::GetBitmapFile(used, used_filename)
+      && CAnalysisTexture::GetBitmapFile(CAnalysisColorTable::Get(CustomMap(1001)), unused_filename);
+    Check(rc && FileExists(used_filename) && FileExists(unused_filename), L"bitmaps of custom tables");
+
+    // A script that sets a new custom map on every call
+    const CAnalysisColorTable* last = nullptr;
+    for (int i = 0; i < 100; i++)
+    {
+      ON_wString filename;
+      last = &CAnalysisColorTable::Get(CustomMap(i));
+      CAnalysisTexture::GetBitmapFile(*last, filename);
+    }
+
+    Check(!FileExists(unused_filename), L"custom tables that are not used are deleted with their bitmaps");
+    Check(FileExists(used_filename) && &CAnalysisColorTable::Get(CustomMap(1000)) == &used, L"custom tables that are used are kept");
+    Check(&CAnalysisColorTable::Get(CustomMap(99)) == last, L"the most recently used custom tables are kept");
+    CAnalysisColorTable::Release(&used);
+  }
+};
+
+// The one and only CAnalysisCustomTableTest test
+static class CAnalysisCustomTableTest theAnalysisCustomTableTest;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Recoloring sorted values after a range change gives the colors a full
+// MapValues() pass gives, whether it recolors runs of the sorted values
+// or falls back to the full pass
+class CAnalysisRecolorTest : public CAnalysisTest
+{
+public:
+  CAnalysisRecolorTest() : CAnalysisTest(L"Analysis recoloring", check_test) {}
+
+protected:
+  void Run() override
+  {
+    // Random values on a grid, so some are equal, with a few NaN values
+    const int count = 200001;
+    ON_SimpleArray<double> values(count);
+    ON_SimpleArray<float> float_values(count);
+    ON_RandomNumberGenerator random;
+    random.Seed(15);
+    for (int i = 0; i < count; i++)
+    {
+      const double a = (0 == i % 97) ? ON_DBL_QNAN : floor(random.RandomDouble(0.0, 1000.0)) / 1000.0;
+      values.Append(a);
+      float_values.Append((float)a);
+    }
+
+    // A continuous map, where most range changes recolor most values,
+    // and banded maps, where small changes only recolor the values
+    // near the band edges
+    ON_ClassArray<CAnalysisColorMap> maps;
+    maps.AppendNew();
+    CAnalysisColorMap& viridis = maps.AppendNew();
+    viridis.m_type = CAnalysisColorMap::viridis;
+    viridis.m_band_count = 8;
+    const ON_Color custom_colors[3] = { ON_Color(0, 0, 255), ON_Color(255, 255, 255), ON_Color(255, 0, 0) };
+    CAnalysisColorMap& custom = maps.AppendNew();
+    custom.SetCustomColors(custom_colors, 3);
+    custom.m_band_count = 5;
+
+    m_run_count = 0;
+    m_fallback_count = 0;
+    for (int m = 0; m < maps.Count(); m++)
+    {
+      const CAnalysisColorTable& table = CAnalysisColorTable::Get(maps[m]);
+      RecolorSeries(table, values.Array(), count, L"double");
+      RecolorSeries(table, float_values.Array(), count, L"float");
+    }
+    Check(m_run_count > 0, L"some range changes recolor runs of values");
+    Check(m_fallback_count > 0, L"some range changes recolor every value");
+  }
+
+private:
+  template <class T>
+  void RecolorSeries(const CAnalysisColorTable& table, const T* values, int count, const wchar_t* type_name)
+  {
+    // Sorted as CAnalysisUserData::SortValues() sorts, NaN values first
+    ON_SimpleArray<int> sorted(count);
+    for (int i = 0; i < count; i++)
+      sorted.Append(i);
+    std::sort(sorted.Array(), sorted.Array() + count, [values](int i, int j)
+    {
+      if (values[i] != values[i])
+        return values[j] == values[j];
+      return values[i] < values[j];
+    });
+
+    // Nudges of either end, ranges that clamp many values at both
+    // ends, a reversed range and an empty range
+    const ON_Interval ranges[] =
+    {
+      ON_Interval(0.0, 1.0),
+      ON_Interval(0.002, 1.0),
+      ON_Interval(0.002, 0.995),
+      ON_Interval(0.4, 0.6),
+      ON_Interval(0.41, 0.6),
+      ON_Interval(0.41, 0.61),
+      ON_Interval(0.6, 0.4),
+      ON_Interval(0.6, 0.39),
+      ON_Interval(-1.0, 2.0),
+      ON_Interval(-1.0, 2.05),
+      ON_Interval(0.5, 0.5),
+      ON_Interval(0.0, 1.0)
+    };
+    const int range_count = (int)(sizeof(ranges) / sizeof(ranges[0]));
+
+    ON_SimpleArray<ON_Color> colors(count), expected(count);
+    colors.SetCount(count);
+    expected.SetCount(count);
+    table.MapValues(values, count, ranges[0], colors.Array());
+
+    ON_wString description;
+    for (int r = 1; r < range_count; r++)
+    {
+      description.Format(L"%s values, %s, from [%g,%g] to [%g,%g]", type_name, CAnalysisColorMap::TypeName(table.ColorMap().m_type), ranges[r - 1][0], ranges[r - 1][1], ranges[r][0], ranges[r][1]);
+
+      int different_count = 0;
+      table.MapValues(values, count, ranges[r], expected.Array());
+      for (int i = 0; i < count; i++)
+      {
+        if (colors[i] != expected[i])
+          different_count++;
+      }
+
+      const int changed = table.RecolorValues(values, sorted.Array(), count, ranges[r - 1], ranges[r], colors.Array());
+      Check(0 == memcmp(colors.Array(), expected.Array(), sizeof(ON_Color) * count), description);
+
+      // Runs return the number of colors that changed. More than a
+      // quarter of the values are recolored in one full pass.
+      if (changed < count)
+      {
+        m_run_count++;
+        Check(changed == different_count && changed <= count / 4, description);
+      }
+      else
+      {
+        m_fallback_count++;
+      }
+    }
+
+    // NaN values keep the first color
+    const int nan_index = 0;
+    Check(values[nan_index] != values[nan_index] && colors[nan_index] == table.Colors()[0], L"NaN values are the first color");
+  }
+
+  int m_run_count;
+  int m_fallback_count;
+};
+
+// The one and only CAnalysisRecolorTest test
+static class CAnalysisRecolorTest theAnalysisRecolorTest;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Per vertex cost of coloring a 10 million vertex mesh with the HSV
+// conversion, with a color map evaluation, and with the color table
+class CAnalysisColorTableBenchmark : public CAnalysisTest
+{
+public:
+  CAnalysisColorTableBenchmark() : CAnalysisTest(L"Analysis color table", benchmark_test) {}
+
+protected:
+  void Run() override
+  {
+    const int count = 10000000;
+    const ON_Interval redblue(0.1, 0.9);
+
+    // Random values, so nothing is learned from the order
+    ON_SimpleArray<double> values(count);
+    ON_SimpleArray<float> float_values(count);
+    ON_RandomNumberGenerator random;
+    random.Seed(1);
+    for (int i = 0; i < count; i++)
+    {
+      const double a = random.RandomDouble(0.0, 1.0);
+      values.Append(a);
+      float_values.Append((float)a);
+    }
+    Print(L"%d vertices", count);
+
+    // The loop UpdateColors used before the table
+    ON_SimpleArray<ON_Color> colors;
+    double start = Seconds();
+    colors.Reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+      const ON_Color c = HSVColor(values[i], redblue);
+      colors.Append(c);
+    }
+    PrintTime(L"HSV conversion and Append", Seconds() - start, count);
+
+    CAnalysisColorMap map;
+    map.m_type = CAnalysisColorMap::viridis;
+    start = Seconds();
+    for (int i = 0; i < count; i++)
+      colors[i] = map.Evaluate(redblue.NormalizedParameterAt(values[i]));
+    PrintTime(L"Viridis color map evaluation", Seconds() - start, count);
+
+    const CAnalysisColorTable& table = CAnalysisColorTable::Get(map);
+    start = Seconds();
+    table.MapValues(values.Array(), count, redblue, colors.Array());
+    PrintTime(L"Color table, doubles", Seconds() - start, count);
+
+    start = Seconds();
+    table.MapValues(float_values.Array(), count, redblue, colors.Array());
+    PrintTime(L"Color table, floats", Seconds() - start, count);
+  }
+
+private:
+  void PrintTime(const wchar_t* name, double seconds, int count)
+  {
+    Print(L"%s: %.3f seconds, %.1f ns per vertex", name, seconds, 1.0e9 * seconds / count);
+  }
+};
+
+// The one and only CAnalysisColorTableBenchmark test
+static class CAnalysisColorTableBenchmark theAnalysisColorTableBenchmark;
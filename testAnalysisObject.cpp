@@ -0,0 +1,161 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// testAnalysisObject.cpp
+
+#include "stdafx.h"
+#include "AnalysisTest.h"
+#include "AnalysisObject.h"
+#include "AnalysisUserData.h"
+#include "RhinoVariantHelpers.h"
+
+// The arrays of a grid of vertices, as a script passes them to
+// AddAnalysisMesh
+class CScriptGrid
+{
+public:
+  /*
+  Description:
+    Builds a grid of size by size vertices with one quad for each cell.
+  Parameters:
+    bTyped - [in] if true, the arrays are flat arrays of doubles and
+                  longs. Otherwise the vertices are an array of points
+                  and the faces and values are arrays of variants, as
+                  the variant helpers create them.
+  */
+  CScriptGrid(int size, bool bTyped)
+  {
+    ON_3dPointArray points(size * size);
+    ON_SimpleArray<double> values(size * size);
+    for (int j = 0; j < size; j++)
+    {
+      for (int i = 0; i < size; i++)
+      {
+        points.Append(ON_3dPoint((double)i, (double)j, 0.1 * sin(0.1 * i)));
+        values.Append(sin(0.01 * i) * cos(0.01 * j));
+      }
+    }
+
+    ON_SimpleArray<int> indices(4 * (size - 1) * (size - 1));
+    for (int j = 0; j + 1 < size; j++)
+    {
+      for (int i = 0; i + 1 < size; i++)
+      {
+        const int vi = j * size + i;
+        indices.Append(vi);
+        indices.Append(vi + 1);
+        indices.Append(vi + size + 1);
+        indices.Append(vi + size);
+      }
+    }
+
+    if (bTyped)
+    {
+      m_vertices.CreateOneDim(VT_R8, 3 * points.Count(), points.Array());
+      m_faces.CreateOneDim(VT_I4, indices.Count(), indices.Array());
+      m_data.CreateOneDim(VT_R8, values.Count(), values.Array());
+    }
+    else
+    {
+      CRhinoVariantHelpers::CreateSafeArray(points, m_vertices);
+      CRhinoVariantHelpers::CreateSafeArray(indices, m_faces);
+      CRhinoVariantHelpers::CreateSafeArray(values, m_data);
+    }
+  }
+
+  // Creates the mesh, as AddAnalysisMesh does
+  ON_Mesh* CreateMesh() const
+  {
+    return CAnalysisObject::CreateAnalysisMesh(m_vertices, m_faces, m_data);
+  }
+
+private:
+  COleSafeArray m_vertices;
+  COleSafeArray m_faces;
+  COleSafeArray m_data;
+};
+
+// True if two meshes have the same vertices, faces and values
+static bool SameMesh(const ON_Mesh* a, const ON_Mesh* b)
+{
+  if (nullptr == a || nullptr == b)
+    return false;
+  if (a->m_V.Count() != b->m_V.Count() || a->m_F.Count() != b->m_F.Count())
+    return false;
+  if (0 != memcmp(a->m_V.Array(), b->m_V.Array(), a->m_V.Count() * sizeof(ON_3fPoint)))
+    return false;
+  if (0 != memcmp(a->m_F.Array(), b->m_F.Array(), a->m_F.Count() * sizeof(ON_MeshFace)))
+    return false;
+
+  const CAnalysisUserData* a_ud = CAnalysisUserData::Get(a);
+  const CAnalysisUserData* b_ud = CAnalysisUserData::Get(b);
+  if (nullptr == a_ud || nullptr == b_ud)
+    return false;
+
+  ON_SimpleArray<double> a_values, b_values;
+  a_ud->m_a.GetValues(a_values);
+  b_ud->m_a.GetValues(b_values);
+  return a_values.Count() == b_values.Count() && 0 == memcmp(a_values.Array(), b_values.Array(), a_values.Count() * sizeof(double));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Flat typed arrays make the same mesh as arrays of variants
+class CAnalysisObjectTest : public CAnalysisTest
+{
+public:
+  CAnalysisObjectTest() : CAnalysisTest(L"Script analysis meshes", check_test) {}
+
+protected:
+  void Run() override
+  {
+    const CScriptGrid typed(50, true);
+    const CScriptGrid variants(50, false);
+    ON_Mesh* typed_mesh = typed.CreateMesh();
+    ON_Mesh* variant_mesh = variants.CreateMesh();
+    Check(nullptr != typed_mesh && 2500 == typed_mesh->m_V.Count() && 2401 == typed_mesh->m_F.Count(), L"typed arrays");
+    Check(SameMesh(typed_mesh, variant_mesh), L"typed arrays and arrays of variants make the same mesh");
+    delete typed_mesh;
+    delete variant_mesh;
+  }
+};
+
+// The one and only CAnalysisObjectTest test
+static class CAnalysisObjectTest theAnalysisObjectTest;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Time to create a 1,000,000 vertex mesh from flat typed arrays, which
+// are copied once, and from arrays of variants, which are converted
+// one element at a time
+class CAnalysisObjectBenchmark : public CAnalysisTest
+{
+public:
+  CAnalysisObjectBenchmark() : CAnalysisTest(L"Script analysis meshes", benchmark_test) {}
+
+protected:
+  void Run() override
+  {
+    const int size = 1000;
+    Print(L"%d vertices, %d quads", size * size, (size - 1) * (size - 1));
+
+    const CScriptGrid typed(size, true);
+    double start = Seconds();
+    ON_Mesh* typed_mesh = typed.CreateMesh();
+    const double typed_seconds = Seconds() - start;
+
+    const CScriptGrid variants(size, false);
+    start = Seconds();
+    ON_Mesh* variant_mesh = variants.CreateMesh();
+    const double variant_seconds = Seconds() - start;
+
+    Check(SameMesh(typed_mesh, variant_mesh), L"both paths make the same mesh");
+    Print(L"Typed arrays: %.1f ms", 1000.0 * typed_seconds);
+    Print(L"Arrays of variants: %.1f ms", 1000.0 * variant_seconds);
+    delete typed_mesh;
+    delete variant_mesh;
+  }
+};
+
+// The one and only CAnalysisObjectBenchmark test
+static class CAnalysisObjectBenchmark theAnalysisObjectBenchmark;
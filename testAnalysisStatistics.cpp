@@ -0,0 +1,196 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// testAnalysisStatistics.cpp
+
+#include "stdafx.h"
+#include "AnalysisTest.h"
+#include "AnalysisStatistics.h"
+#include <float.h>
+#include <limits>
+
+// The SIMD kernels, which are compared with the scalar kernel
+static const CAnalysisStatistics::kernel_type SIMD_KERNELS[] = { CAnalysisStatistics::sse2_kernel, CAnalysisStatistics::avx_kernel };
+static const wchar_t* SIMD_KERNEL_NAMES[] = { L"SSE2", L"AVX" };
+static const int SIMD_KERNEL_COUNT = (int)(sizeof(SIMD_KERNELS) / sizeof(SIMD_KERNELS[0]));
+
+/*
+Description:
+  Fills an array with values around an offset, with NaN, infinite,
+  denormal and zero values mixed in at positions that do not line up
+  with the two and four value lanes.
+Parameters:
+  count  - [in] number of values.
+  offset - [in] added to the ordinary values, to test the shift that
+                keeps the variance precise.
+  bMixed - [in] if true, special values are mixed in.
+*/
+template <class T>
+static void MakeValues(ON_SimpleArray<T>& values, int count, double offset, bool bMixed)
+{
+  const T nan = std::numeric_limits<T>::quiet_NaN();
+  const T inf = std::numeric_limits<T>::infinity();
+  const T denormal = std::numeric_limits<T>::denorm_min();
+
+  values.SetCount(0);
+  values.SetCapacity(count);
+  for (int i = 0; i < count; i++)
+  {
+    T x = (T)(offset + 100.0 * sin(0.37 * i));
+    if (bMixed)
+    {
+      switch ((i * 7) % 11)
+      {
+      case 1: x = nan; break;
+      case 3: x = (i & 1) ? inf : -inf; break;
+      case 5: x = (i & 1) ? denormal : -denormal; break;
+      case 8: x = (i & 1) ? (T)0.0 : -(T)0.0; break;
+      default: break;
+      }
+    }
+    values.Append(x);
+  }
+}
+
+// True if two results of the same values agree. The sums of the
+// kernels are added in different orders, so the mean and variance may
+// differ by rounding.
+static bool SameStatistics(const CAnalysisStatistics& a, const CAnalysisStatistics& b)
+{
+  if (a.m_count != b.m_count || a.m_finite_count != b.m_finite_count || a.m_nan_count != b.m_nan_count || a.m_infinite_count != b.m_infinite_count)
+    return false;
+  if (a.m_min != b.m_min || a.m_max != b.m_max)
+    return false;
+  if (0 == a.m_finite_count)
+    return a.m_mean == b.m_mean && a.m_variance == b.m_variance;
+
+  const double scale = fabs(a.m_max) > fabs(a.m_min) ? fabs(a.m_max) : fabs(a.m_min);
+  const double mean_tolerance = 1.0e-12 * (scale + 1.0);
+  const double variance_tolerance = 1.0e-10 * (a.m_variance + 1.0);
+  return fabs(a.m_mean - b.m_mean) <= mean_tolerance && fabs(a.m_variance - b.m_variance) <= variance_tolerance;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// The SSE2 and AVX kernels give the same results as the scalar kernel
+class CAnalysisStatisticsTest : public CAnalysisTest
+{
+public:
+  CAnalysisStatisticsTest() : CAnalysisTest(L"Analysis statistics kernels", check_test) {}
+
+protected:
+  void Run() override
+  {
+    for (int k = 0; k < SIMD_KERNEL_COUNT; k++)
+    {
+      if (!CAnalysisStatistics::IsKernelAvailable(SIMD_KERNELS[k]))
+      {
+        Print(L"%s is not available", SIMD_KERNEL_NAMES[k]);
+        continue;
+      }
+      CompareKernel<double>(SIMD_KERNELS[k], SIMD_KERNEL_NAMES[k], L"double");
+      CompareKernel<float>(SIMD_KERNELS[k], SIMD_KERNEL_NAMES[k], L"float");
+    }
+
+    // A known answer, with every kind of value
+    const double values[7] = { 1.0, ON_DBL_QNAN, 3.0, std::numeric_limits<double>::infinity(), 5.0, -std::numeric_limits<double>::infinity(), 7.0 };
+    CAnalysisStatistics stats;
+    const bool rc = stats.Compute(values, 7);
+    Check(rc && 4 == stats.m_finite_count && 1 == stats.m_nan_count && 2 == stats.m_infinite_count, L"counts");
+    Check(rc && 1.0 == stats.m_min && 7.0 == stats.m_max && 4.0 == stats.m_mean && 5.0 == stats.m_variance, L"range, mean and variance");
+
+    // No finite values
+    const double nan_values[2] = { ON_DBL_QNAN, ON_DBL_QNAN };
+    Check(!stats.Compute(nan_values, 2) && 2 == stats.m_nan_count && ON_UNSET_VALUE == stats.m_mean, L"no finite values");
+  }
+
+private:
+  template <class T>
+  void CompareKernel(CAnalysisStatistics::kernel_type kernel, const wchar_t* kernel_name, const wchar_t* type_name)
+  {
+    // Every length up to a few lanes past a multiple of four, so
+    // each remainder is left to the scalar loop, and a long array
+    static const int lengths[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 17, 31, 33, 1001, 100003 };
+    static const double offsets[] = { 0.0, 1.0e6 };
+
+    int different_count = 0;
+    ON_SimpleArray<T> values;
+    for (int l = 0; l < (int)(sizeof(lengths) / sizeof(lengths[0])); l++)
+    {
+      for (int o = 0; o < (int)(sizeof(offsets) / sizeof(offsets[0])); o++)
+      {
+        for (int mixed = 0; mixed < 2; mixed++)
+        {
+          MakeValues(values, lengths[l], offsets[o], 0 != mixed);
+
+          // Every start, so loads are not always aligned
+          for (int start = 0; start < 4 && start < values.Count(); start++)
+          {
+            CAnalysisStatistics scalar, simd;
+            const bool scalar_rc = scalar.Compute(values.Array() + start, values.Count() - start, CAnalysisStatistics::scalar_kernel);
+            const bool simd_rc = simd.Compute(values.Array() + start, values.Count() - start, kernel);
+            if (scalar_rc != simd_rc || !SameStatistics(scalar, simd))
+              different_count++;
+          }
+        }
+      }
+    }
+
+    // Only special values
+    const T specials[5] = { std::numeric_limits<T>::quiet_NaN(), std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity(), std::numeric_limits<T>::denorm_min(), std::numeric_limits<T>::quiet_NaN() };
+    CAnalysisStatistics scalar, simd;
+    const bool scalar_rc = scalar.Compute(specials, 5, CAnalysisStatistics::scalar_kernel);
+    const bool simd_rc = simd.Compute(specials, 5, kernel);
+    if (scalar_rc != simd_rc || !SameStatistics(scalar, simd))
+      different_count++;
+
+    ON_wString description;
+    description.Format(L"%s %s results match the scalar kernel", kernel_name, type_name);
+    Check(0 == different_count, description);
+  }
+};
+
+// The one and only CAnalysisStatisticsTest test
+static class CAnalysisStatisticsTest theAnalysisStatisticsTest;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Throughput of each kernel on 10 million doubles and floats
+class CAnalysisStatisticsBenchmark : public CAnalysisTest
+{
+public:
+  CAnalysisStatisticsBenchmark() : CAnalysisTest(L"Analysis statistics kernels", benchmark_test) {}
+
+protected:
+  void Run() override
+  {
+    const int count = 10000000;
+    ON_SimpleArray<double> values;
+    ON_SimpleArray<float> float_values;
+    MakeValues(values, count, 0.0, false);
+    MakeValues(float_values, count, 0.0, false);
+    Print(L"%d values", count);
+
+    static const CAnalysisStatistics::kernel_type kernels[] = { CAnalysisStatistics::scalar_kernel, CAnalysisStatistics::sse2_kernel, CAnalysisStatistics::avx_kernel };
+    static const wchar_t* names[] = { L"Scalar", L"SSE2", L"AVX" };
+    for (int k = 0; k < 3; k++)
+    {
+      if (!CAnalysisStatistics::IsKernelAvailable(kernels[k]))
+        continue;
+
+      CAnalysisStatistics stats;
+      double start = Seconds();
+      stats.Compute(values.Array(), count, kernels[k]);
+      const double seconds = Seconds() - start;
+
+      start = Seconds();
+      stats.Compute(float_values.Array(), count, kernels[k]);
+      const double float_seconds = Seconds() - start;
+
+      Print(L"%s: doubles %.2f ns per value, floats %.2f ns per value", names[k], 1.0e9 * seconds / count, 1.0e9 * float_seconds / count);
+    }
+  }
+};
+
+// The one and only CAnalysisStatisticsBenchmark test
+static class CAnalysisStatisticsBenchmark theAnalysisStatisticsBenchmark;
@@ -0,0 +1,168 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// testAnalysisTexture.cpp
+
+#include "stdafx.h"
+#include "AnalysisTest.h"
+#include "AnalysisColorTable.h"
+#include "AnalysisTexture.h"
+
+// Size of the bitmap file and info headers written by WriteBitmap()
+static const int BITMAP_HEADER_SIZE = 14 + 40;
+
+/*
+Description:
+  Reads the pixels of a bitmap written by CAnalysisTexture::WriteBitmap().
+Parameters:
+  colors - [out] the color_count pixels, from left to right.
+Returns:
+  True if the file has the size and headers WriteBitmap() writes.
+*/
+static bool ReadBitmap(const wchar_t* filename, ON_SimpleArray<ON_Color>& colors)
+{
+  const int width = CAnalysisColorTable::color_count;
+  const int size = BITMAP_HEADER_SIZE + 3 * width;
+  ON_SimpleArray<unsigned char> bytes(size + 1);
+  bytes.SetCount(size + 1);
+
+  FILE* fp = ON::OpenFile(filename, L"rb");
+  if (nullptr == fp)
+    return false;
+  const size_t read_size = fread(bytes.Array(), 1, size + 1, fp);
+  ON::CloseFile(fp);
+
+  const unsigned char* p = bytes.Array();
+  const int file_width = p[18] | (p[19] << 8) | (p[20] << 16) | (p[21] << 24);
+  const int bit_count = p[28] | (p[29] << 8);
+  if ((size_t)size != read_size || 'B' != p[0] || 'M' != p[1] || width != file_width || 24 != bit_count)
+    return false;
+
+  // The pixels are blue, green, red
+  colors.SetCount(0);
+  colors.SetCapacity(width);
+  for (int i = 0; i < width; i++)
+  {
+    const unsigned char* pixel = p + BITMAP_HEADER_SIZE + 3 * i;
+    colors.Append(ON_Color(pixel[2], pixel[1], pixel[0]));
+  }
+  return true;
+}
+
+/*
+Description:
+  The texel that a clamped, nearest filtered texture lookup of a
+  texture coordinate hits, in single precision as the graphics card
+  computes it.
+*/
+static int LookupTexel(const ON_Xform& xform, const ON_2fPoint& t)
+{
+  const int width = CAnalysisColorTable::color_count;
+  const float s = (float)(xform.m_xform[0][0] * t.x + xform.m_xform[0][3]);
+  const float texel = floorf(s * width);
+  if (!(texel >= 0.0f))
+    return 0;
+  return texel < (float)width ? (int)texel : width - 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// A texture colored mesh has the colors that MapValues() gives it
+class CAnalysisTextureTest : public CAnalysisTest
+{
+public:
+  CAnalysisTextureTest() : CAnalysisTest(L"Analysis texture colors", check_test) {}
+
+protected:
+  void Run() override
+  {
+    CAnalysisColorMap map;
+    map.m_type = CAnalysisColorMap::viridis;
+    const CAnalysisColorTable& table = CAnalysisColorTable::Get(map);
+
+    // The bitmap is the table, and the table agrees with Color()
+    const ON_wString filename = TempFileName(L"texture.bmp");
+    ON_SimpleArray<ON_Color> bitmap;
+    if (!Check(CAnalysisTexture::WriteBitmap(table, filename) && ReadBitmap(filename, bitmap), L"writing and reading the bitmap"))
+      return;
+    ::DeleteFileW(filename);
+
+    const int width = CAnalysisColorTable::color_count;
+    int different_count = 0;
+    for (int i = 0; i < width; i++)
+    {
+      if (bitmap[i] != table.Colors()[i] || bitmap[i] != table.Color((double)i / (width - 1)))
+        different_count++;
+    }
+    Check(0 == different_count, L"bitmap pixels are the table colors");
+
+    // Values from below the data range to above it, and a NaN
+    const int count = 20001;
+    const ON_Interval minmax(-10.0, 30.0);
+    ON_SimpleArray<double> values(count + 1);
+    for (int i = 0; i < count; i++)
+      values.Append(-20.0 + 60.0 * i / (count - 1));
+    values.Append(ON_DBL_QNAN);
+
+    ON_Mesh mesh;
+    mesh.m_V.SetCapacity(values.Count());
+    mesh.m_V.SetCount(values.Count());
+    if (!Check(CAnalysisTexture::SetTextureCoordinates(&mesh, values.Array(), values.Count(), minmax), L"setting texture coordinates"))
+      return;
+
+    // The whole range, a narrow display range, a range larger than
+    // the data and a range outside of the data
+    CompareColors(table, bitmap, mesh, values, minmax, minmax, L"data range");
+    CompareColors(table, bitmap, mesh, values, minmax, ON_Interval(4.0, 6.0), L"narrow range");
+    CompareColors(table, bitmap, mesh, values, minmax, ON_Interval(-100.0, 100.0), L"wide range");
+    CompareColors(table, bitmap, mesh, values, minmax, ON_Interval(40.0, 50.0), L"range above the data");
+
+    // An empty display range has the start color below it and the
+    // end color above it
+    const ON_Interval empty(5.0, 5.0);
+    const ON_Xform xform = CAnalysisTexture::TextureTransform(minmax, empty);
+    different_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+      if (values[i] == 5.0)
+        continue;
+      const ON_Color& expected = (values[i] < 5.0) ? bitmap[0] : bitmap[width - 1];
+      if (bitmap[LookupTexel(xform, mesh.m_T[i])] != expected)
+        different_count++;
+    }
+    Check(0 == different_count, L"empty range");
+  }
+
+private:
+  // Colors can only differ where single precision rounding puts a
+  // value on the other side of the boundary between two texels.
+  void CompareColors(const CAnalysisColorTable& table, const ON_SimpleArray<ON_Color>& bitmap, const ON_Mesh& mesh, const ON_SimpleArray<double>& values, const ON_Interval& minmax, const ON_Interval& redblue, const wchar_t* name)
+  {
+    const int count = values.Count();
+    ON_SimpleArray<ON_Color> colors(count);
+    colors.SetCount(count);
+    table.MapValues(values.Array(), count, redblue, colors.Array());
+
+    const int width = CAnalysisColorTable::color_count;
+    const ON_Xform xform = CAnalysisTexture::TextureTransform(minmax, redblue);
+    int boundary_count = 0;
+    int different_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+      const int texel = LookupTexel(xform, mesh.m_T[i]);
+      if (bitmap[texel] == colors[i])
+        continue;
+      if ((texel > 0 && bitmap[texel - 1] == colors[i]) || (texel + 1 < width && bitmap[texel + 1] == colors[i]))
+        boundary_count++;
+      else
+        different_count++;
+    }
+
+    ON_wString description;
+    description.Format(L"%s: texture colors are the MapValues colors", name);
+    Check(0 == different_count && boundary_count * 100 <= count, description);
+  }
+};
+
+// The one and only CAnalysisTextureTest test
+static class CAnalysisTextureTest theAnalysisTextureTest;
@@ -0,0 +1,177 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// testAnalysisToolsPlugIn.cpp
+
+#include "stdafx.h"
+#include "AnalysisTest.h"
+#include "AnalysisToolsPlugIn.h"
+#include "AnalysisMappedFile.h"
+#include "AnalysisTextParser.h"
+#include "AnalysisUserData.h"
+
+// A grid of size by size vertices with one quad for each cell, so the
+// file is split into several chunks
+static const int GRID_SIZE = 200;
+static const int HEADER_LINE_COUNT = 2;
+
+/*
+Description:
+  Writes the text of a .ram file. Face indices have a fixed width, so
+  a face can be made invalid without moving the lines after it.
+*/
+static void MakeFalseColorMeshText(ON_SimpleArray<char>& text)
+{
+  const int vcount = GRID_SIZE * GRID_SIZE;
+  const int fcount = (GRID_SIZE - 1) * (GRID_SIZE - 1);
+  text.SetCapacity(48 * (size_t)(vcount + fcount));
+  CAnalysisTest::AppendText(text, "VertexCount=%d\nFaceCount=%d\n", vcount, fcount);
+  for (int j = 0; j < GRID_SIZE; j++)
+  {
+    for (int i = 0; i < GRID_SIZE; i++)
+      CAnalysisTest::AppendText(text, "%.6f %.6f %.6f %.6f\n", (double)i, (double)j, 0.01 * i * j, sin(0.01 * i) * cos(0.01 * j));
+  }
+  for (int j = 0; j + 1 < GRID_SIZE; j++)
+  {
+    for (int i = 0; i + 1 < GRID_SIZE; i++)
+    {
+      const int v = j * GRID_SIZE + i;
+      CAnalysisTest::AppendText(text, "%7d %7d %7d %7d\n", v, v + 1, v + GRID_SIZE + 1, v + GRID_SIZE);
+    }
+  }
+}
+
+// The zero based index of the line that starts at s
+static int LineIndex(const ON_SimpleArray<char>& text, const char* s)
+{
+  return CAnalysisTextParser::LineCount(text.Array(), s);
+}
+
+// The start of a line, by its zero based index
+static char* LineStart(ON_SimpleArray<char>& text, int index)
+{
+  char* s = text.Array();
+  for (int i = 0; i < index; i++)
+    s = static_cast<char*>(memchr(s, '\n', text.Array() + text.Count() - s)) + 1;
+  return s;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Chunked .ram parsing reads every line, and reports the number of the
+// first bad line when it is the first or last line of a chunk
+class CFalseColorMeshTest : public CAnalysisTest
+{
+public:
+  CFalseColorMeshTest() : CAnalysisTest(L"Analysis mesh files", check_test) {}
+
+protected:
+  void Run() override
+  {
+    ON_SimpleArray<char> text;
+    MakeFalseColorMeshText(text);
+    const int vcount = GRID_SIZE * GRID_SIZE;
+
+    ON_wString error;
+    ON_Mesh* mesh = Read(text, L"good.ram", error);
+    const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh);
+    bool bValues = (nullptr != ud && vcount == ud->m_a.Count());
+    for (int i = 0; bValues && i < vcount; i++)
+      bValues = (fabs(ud->m_a[i] - sin(0.01 * (i % GRID_SIZE)) * cos(0.01 * (i / GRID_SIZE))) <= 1.0e-6);
+    Check(nullptr != mesh && vcount == mesh->m_V.Count() && (GRID_SIZE - 1) * (GRID_SIZE - 1) == mesh->m_F.Count() && bValues, L"reading every vertex, face and value");
+    delete mesh;
+
+    // The chunks are split the way the reader splits them, after the
+    // vertex and face counts
+    const char* body = LineStart(text, HEADER_LINE_COUNT);
+    ON_SimpleArray<const char*> bounds;
+    const int chunk_count = CAnalysisTextParser::SplitLines(body, text.Array() + text.Count(), bounds);
+
+    // The first chunk that starts in the vertex lines, and the first
+    // one that starts after the first face line
+    int vertex_line = -1;
+    int face_line = -1;
+    for (int i = 1; i < chunk_count; i++)
+    {
+      const int line = LineIndex(text, bounds[i]);
+      if (vertex_line < 0 && line < HEADER_LINE_COUNT + vcount)
+        vertex_line = line;
+      if (face_line < 0 && line > HEADER_LINE_COUNT + vcount)
+        face_line = line;
+    }
+    if (!Check(vertex_line > HEADER_LINE_COUNT && face_line > 0, L"chunks start in the vertex and face lines"))
+      return;
+
+    // A vertex without its value at the start and at the end of a chunk
+    CheckBadLine(text, vertex_line, false, L"Invalid vertex", L"a bad vertex at the start of a chunk");
+    CheckBadLine(text, vertex_line - 1, false, L"Invalid vertex", L"a bad vertex at the end of a chunk");
+
+    // A face with an index past the last vertex
+    CheckBadLine(text, face_line, true, L"Invalid face", L"a bad face at the start of a chunk");
+    CheckBadLine(text, face_line - 1, true, L"Invalid face", L"a bad face at the end of a chunk");
+
+    // The first of two bad lines in different chunks is reported
+    ON_SimpleArray<char> bad_text(text);
+    BreakLine(bad_text, face_line, true);
+    BreakLine(bad_text, vertex_line - 1, false);
+    CheckError(bad_text, L"Invalid vertex", vertex_line - 1, L"the first of two bad lines");
+  }
+
+private:
+  void CheckBadLine(const ON_SimpleArray<char>& text, int index, bool bFace, const wchar_t* reason, const wchar_t* description)
+  {
+    ON_SimpleArray<char> bad_text(text);
+    BreakLine(bad_text, index, bFace);
+    CheckError(bad_text, reason, index, description);
+  }
+
+  // Checks the error of a file, which has the one based line number
+  void CheckError(const ON_SimpleArray<char>& text, const wchar_t* reason, int index, const wchar_t* description)
+  {
+    ON_wString error;
+    ON_Mesh* mesh = Read(text, L"bad.ram", error);
+    ON_wString expected;
+    expected.Format(L"%s on line %d.", reason, index + 1);
+    Check(nullptr == mesh && expected == error, description);
+    delete mesh;
+  }
+
+  // Makes a line invalid without changing its length
+  static void BreakLine(ON_SimpleArray<char>& text, int index, bool bFace)
+  {
+    char* line = LineStart(text, index);
+    char* line_end = static_cast<char*>(memchr(line, '\n', text.Array() + text.Count() - line));
+    if (bFace)
+    {
+      // The first index is past the last vertex
+      ON_SimpleArray<char> number;
+      CAnalysisTest::AppendText(number, "%7d", GRID_SIZE * GRID_SIZE);
+      memcpy(line, number.Array(), number.Count());
+    }
+    else
+    {
+      // The value is blanked out
+      char* value = line_end;
+      while (value > line && ' ' != value[-1])
+        value--;
+      memset(value, ' ', line_end - value);
+    }
+  }
+
+  static ON_Mesh* Read(const ON_SimpleArray<char>& text, const wchar_t* name, ON_wString& error)
+  {
+    const ON_wString filename = TempFileName(name);
+    ON_Mesh* mesh = nullptr;
+    if (WriteFile(filename, text.Array(), text.UnsignedCount()))
+    {
+      CAnalysisMappedFile file;
+      if (file.Open(filename))
+        mesh = CAnalysisToolsPlugIn::ReadFalseColorMeshFile(file, error);
+    }
+    ::DeleteFileW(filename);
+    return mesh;
+  }
+};
+
+// The one and only CFalseColorMeshTest test
+static class CFalseColorMeshTest theFalseColorMeshTest;
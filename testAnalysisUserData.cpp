@@ -0,0 +1,189 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// testAnalysisUserData.cpp
+
+#include "stdafx.h"
+#include "AnalysisTest.h"
+#include "AnalysisUserData.h"
+
+static const int CHANNEL_COUNT = 3;
+static const int VERTEX_COUNT = 1001;
+
+// The value of a vertex in a channel, different in every channel
+static double ChannelValue(int channel, int vertex)
+{
+  return 10.0 * channel + sin(0.01 * vertex);
+}
+
+/*
+Description:
+  Creates analysis data with three channels of smooth values.
+*/
+static void MakeUserData(CAnalysisUserData& ud, CAnalysisValues::precision precision)
+{
+  const ON_wString names[CHANNEL_COUNT] = { L"Pressure", L"Temperature", L"Velocity" };
+  ud.CreateChannels(names, CHANNEL_COUNT, VERTEX_COUNT, precision);
+
+  ON_SimpleArray<double> values(VERTEX_COUNT);
+  values.SetCount(VERTEX_COUNT);
+  for (int c = 0; c < CHANNEL_COUNT; c++)
+  {
+    for (int i = 0; i < VERTEX_COUNT; i++)
+      values[i] = ChannelValue(c, i);
+    ud.SetChannelValues(c, values.Array());
+  }
+  ud.ComputeRange(true);
+}
+
+// True if a channel has its values, within a tolerance
+static bool HasChannelValues(const CAnalysisUserData& ud, int channel, double tolerance)
+{
+  ON_SimpleArray<double> values(VERTEX_COUNT);
+  values.SetCount(VERTEX_COUNT);
+  if (VERTEX_COUNT != ud.m_a.Count() || !ud.GetChannelValues(channel, values.Array()))
+    return false;
+
+  // Single precision values are rounded to floats
+  const bool bFloat = (CAnalysisValues::single_precision == ud.m_a.Precision());
+  for (int i = 0; i < VERTEX_COUNT; i++)
+  {
+    const double expected = bFloat ? (double)(float)ChannelValue(channel, i) : ChannelValue(channel, i);
+    if (!(fabs(values[i] - expected) <= tolerance))
+      return false;
+  }
+  return true;
+}
+
+// True if every channel has its values
+static bool HasValues(const CAnalysisUserData& ud, double tolerance)
+{
+  if (CHANNEL_COUNT != ud.ChannelCount())
+    return false;
+  for (int c = 0; c < CHANNEL_COUNT; c++)
+  {
+    if (!HasChannelValues(ud, c, tolerance))
+      return false;
+  }
+  return true;
+}
+
+// True if the values of every channel are shared with a copy
+static bool IsShared(const CAnalysisUserData& ud)
+{
+  if (!ud.m_a.IsShared())
+    return false;
+  for (int i = 0; i < ud.m_channels.Count(); i++)
+  {
+    if (!ud.m_channels[i].IsShared())
+      return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Analysis data reads back what was written, and copies share their
+// values until one of them changes them
+class CAnalysisUserDataTest : public CAnalysisTest
+{
+public:
+  CAnalysisUserDataTest() : CAnalysisTest(L"Analysis user data", check_test) {}
+
+protected:
+  void Run() override
+  {
+    for (int p = 0; p < 2; p++)
+    {
+      const CAnalysisValues::precision precision = p ? CAnalysisValues::single_precision : CAnalysisValues::double_precision;
+      const wchar_t* name = p ? L"float" : L"double";
+      TestWriteRead(precision, name);
+      TestCopies(precision, name);
+    }
+  }
+
+private:
+  void TestWriteRead(CAnalysisValues::precision precision, const wchar_t* name)
+  {
+    ON_wString description;
+
+    CAnalysisUserData ud;
+    MakeUserData(ud, precision);
+    ud.SetActiveChannel(1);
+
+    CAnalysisUserData read_ud;
+    description.Format(L"%s values: exact Write and Read", name);
+    const bool rc = WriteRead(ud, read_ud);
+    Check(rc && HasValues(read_ud, 0.0) && precision == read_ud.m_a.Precision(), description);
+
+    description.Format(L"%s values: active channel and ranges", name);
+    Check(rc && 1 == read_ud.m_active_channel && read_ud.m_minmax == ud.m_minmax && read_ud.m_redblue == ud.m_redblue, description);
+
+    // Switching channels after reading does not need the values of
+    // the channels that stay inactive
+    CAnalysisUserData switched_ud;
+    description.Format(L"%s values: switching the channels of read data", name);
+    Check(WriteRead(ud, switched_ud) && switched_ud.SetActiveChannel(2) && switched_ud.m_channels[0].IsPacked() && HasValues(switched_ud, 0.0), description);
+
+    // Rounded values
+    const double tolerance = 1.0e-3;
+    ud.m_tolerance = tolerance;
+    description.Format(L"%s values: Write and Read within the tolerance", name);
+    Check(WriteRead(ud, read_ud) && read_ud.m_tolerance == tolerance && HasValues(read_ud, tolerance * (1.0 + 1.0e-9)), description);
+  }
+
+  void TestCopies(CAnalysisValues::precision precision, const wchar_t* name)
+  {
+    ON_wString description;
+
+    CAnalysisUserData ud;
+    MakeUserData(ud, precision);
+    ud.SortValues();
+
+    // Copies share the values, but not the sort
+    CAnalysisUserData copy(ud);
+    CAnalysisUserData assigned;
+    assigned = ud;
+    description.Format(L"%s values: copies share the values", name);
+    Check(IsShared(copy) && IsShared(assigned) && HasValues(copy, 0.0) && HasValues(assigned, 0.0), description);
+    description.Format(L"%s values: copies do not copy the sort", name);
+    Check(VERTEX_COUNT == ud.m_sorted.Count() && 0 == copy.m_sorted.Count() && 0 == assigned.m_sorted.Count(), description);
+
+    // Switching channels only swaps the shared arrays
+    description.Format(L"%s values: switching channels keeps the values shared", name);
+    Check(copy.SetActiveChannel(2) && copy.SetActiveChannel(0) && copy.SetActiveChannel(1) && IsShared(copy) && IsShared(ud), description);
+    Check(HasValues(copy, 0.0) && HasValues(ud, 0.0) && 0 == ud.m_active_channel, description);
+
+    // Changing a channel of a copy changes only that channel of that copy
+    ON_SimpleArray<double> values(VERTEX_COUNT);
+    values.SetCount(VERTEX_COUNT);
+    for (int i = 0; i < VERTEX_COUNT; i++)
+      values[i] = -1.0;
+    description.Format(L"%s values: changing a copy leaves the original alone", name);
+    const bool rc = copy.SetChannelValues(2, values.Array());
+    Check(rc && HasValues(ud, 0.0) && HasValues(assigned, 0.0) && !HasChannelValues(copy, 2, 0.0), description);
+    Check(rc && HasChannelValues(copy, 0, 0.0) && HasChannelValues(copy, 1, 0.0) && copy.m_a.IsShared(), description);
+
+    // Mutable access to the active channel copies it too
+    description.Format(L"%s values: changing the active channel of a copy", name);
+    if (CAnalysisValues::single_precision == precision)
+      assigned.ChannelFloatValues(0)[0] = -1.0f;
+    else
+      assigned.ChannelValues(0)[0] = -1.0;
+    Check(!assigned.m_a.IsShared() && -1.0 == assigned.m_a[0] && HasValues(ud, 0.0) && HasChannelValues(copy, 0, 0.0), description);
+  }
+
+  // Writes analysis data to a buffer and reads it back
+  static bool WriteRead(const CAnalysisUserData& ud, CAnalysisUserData& read_ud)
+  {
+    ON_Write3dmBufferArchive archive(0, 0, 60, ON::Version());
+    if (!ud.Write(archive))
+      return false;
+
+    ON_Read3dmBufferArchive read_archive(archive.SizeOfArchive(), archive.Buffer(), false, 60, ON::Version());
+    return read_ud.Read(read_archive);
+  }
+};
+
+// The one and only CAnalysisUserDataTest test
+static class CAnalysisUserDataTest theAnalysisUserDataTest;
@@ -0,0 +1,190 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// testAnalysisValues.cpp
+
+#include "stdafx.h"
+#include "AnalysisTest.h"
+#include "AnalysisValues.h"
+#include <float.h>
+#include <limits>
+
+// Smooth values, like those of a solver, around an offset
+static void MakeSmoothValues(ON_SimpleArray<double>& values, int count, double offset)
+{
+  values.SetCount(0);
+  values.SetCapacity(count);
+  for (int i = 0; i < count; i++)
+    values.Append(offset + sin(0.001 * i) + 0.25 * cos(0.0173 * i));
+}
+
+/*
+Description:
+  Writes values compressed to a buffer and reads them back.
+Parameters:
+  read_values - [out] the values that were read, still compressed.
+  size        - [out] the size of the archive.
+Returns:
+  True if successful.
+*/
+static bool CompressValues(const CAnalysisValues& values, double tolerance, CAnalysisValues& read_values, size_t& size)
+{
+  ON_Write3dmBufferArchive archive(0, 0, 60, ON::Version());
+  if (!values.WriteCompressed(archive, tolerance))
+    return false;
+
+  size = archive.SizeOfArchive();
+  ON_Read3dmBufferArchive read_archive(size, archive.Buffer(), false, 60, ON::Version());
+  return read_values.ReadCompressed(read_archive);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Compressed values read back exactly, or within the tolerance, with
+// values that cannot be rounded escaped one at a time
+class CAnalysisValuesTest : public CAnalysisTest
+{
+public:
+  CAnalysisValuesTest() : CAnalysisTest(L"Analysis value compression", check_test) {}
+
+protected:
+  void Run() override
+  {
+    const int count = 10001;
+    ON_SimpleArray<double> values;
+    MakeSmoothValues(values, count, 100.0);
+
+    // A few values that cannot be rounded, including the first and
+    // the last
+    ON_SimpleArray<double> mixed(values);
+    mixed[0] = ON_DBL_QNAN;
+    mixed[17] = std::numeric_limits<double>::infinity();
+    mixed[18] = -std::numeric_limits<double>::infinity();
+    mixed[500] = 1.0e300;
+    mixed[501] = -1.0e300;
+    mixed[count - 1] = ON_DBL_QNAN;
+
+    for (int p = 0; p < 2; p++)
+    {
+      const CAnalysisValues::precision precision = p ? CAnalysisValues::single_precision : CAnalysisValues::double_precision;
+      const wchar_t* name = p ? L"float" : L"double";
+      CompareValues(values, precision, 0.0, name, L"exact");
+      const size_t rounded_size = CompareValues(values, precision, 1.0e-4, name, L"rounded");
+      const size_t exact_size = CompareValues(mixed, precision, 0.0, name, L"exact with NaN and infinite values");
+      const size_t escaped_size = CompareValues(mixed, precision, 1.0e-4, name, L"rounded with escaped values");
+
+      // The other values are still rounded
+      Check(escaped_size < exact_size && escaped_size < rounded_size + 256, L"escaped values only add their own size");
+    }
+
+    // Escaping every other value is no better than exact values
+    ON_SimpleArray<double> half(values);
+    for (int i = 0; i < count; i += 2)
+      half[i] = ON_DBL_QNAN;
+    CompareValues(half, CAnalysisValues::double_precision, 1.0e-4, L"double", L"rounded with most values escaped");
+  }
+
+private:
+  // Returns the compressed size
+  size_t CompareValues(const ON_SimpleArray<double>& expected, CAnalysisValues::precision precision, double tolerance, const wchar_t* type_name, const wchar_t* name)
+  {
+    ON_wString description;
+    description.Format(L"%s values, %s", type_name, name);
+
+    CAnalysisValues values;
+    values.SetPrecision(precision);
+    values.SetValues(expected.Array(), expected.Count());
+
+    // The values as they are stored, before they are compressed
+    ON_SimpleArray<double> stored;
+    values.GetValues(stored);
+
+    CAnalysisValues read_values;
+    size_t size = 0;
+    if (!Check(CompressValues(values, tolerance, read_values, size) && read_values.IsPacked(), description))
+      return 0;
+
+    ON_SimpleArray<double> read;
+    read_values.GetValues(read);
+    if (!Check(read.Count() == stored.Count() && read_values.Precision() == precision, description))
+      return 0;
+
+    // Values that are not finite, or cannot be rounded, are exact.
+    // The others are within the tolerance, apart from single
+    // precision rounding.
+    int different_count = 0;
+    for (int i = 0; i < stored.Count(); i++)
+    {
+      const double a = stored[i];
+      const double b = read[i];
+      const double error = (SinglePrecisionError(precision, a) + tolerance) * (1.0 + 1.0e-12);
+      const bool bExact = (0.0 == tolerance || !(fabs(a) < 1.0e15));
+      if (bExact ? 0 != memcmp(&a, &b, sizeof(a)) : !(fabs(a - b) <= error))
+        different_count++;
+    }
+    Check(0 == different_count, description);
+    return size;
+  }
+
+  // Rounding a value to a float can add half a float step to the error
+  static double SinglePrecisionError(CAnalysisValues::precision precision, double a)
+  {
+    return (CAnalysisValues::single_precision == precision) ? fabs(a) * FLT_EPSILON : 0.0;
+  }
+};
+
+// The one and only CAnalysisValuesTest test
+static class CAnalysisValuesTest theAnalysisValuesTest;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Compressed size and encode and decode speed of 10 million values,
+// exact and rounded, in both precisions
+class CAnalysisValuesBenchmark : public CAnalysisTest
+{
+public:
+  CAnalysisValuesBenchmark() : CAnalysisTest(L"Analysis value compression", benchmark_test) {}
+
+protected:
+  void Run() override
+  {
+    const int count = 10000000;
+    ON_SimpleArray<double> smooth;
+    MakeSmoothValues(smooth, count, 100.0);
+    Print(L"%d smooth values", count);
+
+    static const double tolerances[] = { 0.0, 1.0e-6, 1.0e-3 };
+    for (int p = 0; p < 2; p++)
+    {
+      CAnalysisValues values;
+      values.SetPrecision(p ? CAnalysisValues::single_precision : CAnalysisValues::double_precision);
+      values.SetValues(smooth.Array(), count);
+      const double megabytes = values.ValueSize() * (double)count / (1024.0 * 1024.0);
+
+      for (int t = 0; t < (int)(sizeof(tolerances) / sizeof(tolerances[0])); t++)
+      {
+        ON_Write3dmBufferArchive archive(0, 0, 60, ON::Version());
+        double start = Seconds();
+        const bool rc = values.WriteCompressed(archive, tolerances[t]);
+        const double encode_seconds = Seconds() - start;
+        if (!rc)
+          continue;
+
+        const size_t size = archive.SizeOfArchive();
+        ON_Read3dmBufferArchive read_archive(size, archive.Buffer(), false, 60, ON::Version());
+        CAnalysisValues read_values;
+        start = Seconds();
+        read_values.ReadCompressed(read_archive);
+        read_values.Unpack();
+        const double decode_seconds = Seconds() - start;
+
+        Print(L"%s, tolerance %g: %.1f%% of %.1f MB, encode %.0f MB/s, decode %.0f MB/s",
+          p ? L"Floats" : L"Doubles", tolerances[t], 100.0 * size / (megabytes * 1024.0 * 1024.0), megabytes,
+          megabytes / encode_seconds, megabytes / decode_seconds);
+      }
+    }
+  }
+};
+
+// The one and only CAnalysisValuesBenchmark test
+static class CAnalysisValuesBenchmark theAnalysisValuesBenchmark;
@@ -0,0 +1,457 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// testTecplotBinaryReader.cpp
+
+#include "stdafx.h"
+#include "AnalysisTest.h"
+#include "AnalysisUserData.h"
+#include "TecplotBinaryReader.h"
+#include "TecplotImportOptions.h"
+#include "TecplotReader.h"
+
+// Variable data formats of binary files
+static const int FLOAT_FORMAT = 1;
+static const int DOUBLE_FORMAT = 2;
+static const int SHORT_FORMAT = 4;
+
+// The variables of the round trip files
+static const int VARIABLE_COUNT = 5;
+static const char* VARIABLE_NAMES[VARIABLE_COUNT] = { "x", "y", "z", "p", "q" };
+
+// A zone of the round trip files
+class CRoundTripZone
+{
+public:
+  CRoundTripZone(CTecplotZone::zone_type zone_type = CTecplotZone::ordered, int imax = 0, int jmax = 0)
+    : m_zone_type(zone_type)
+    , m_imax(imax)
+    , m_jmax(jmax)
+    , m_shared_nodes(-1)
+  {
+    for (int v = 0; v < VARIABLE_COUNT; v++)
+    {
+      m_formats[v] = FLOAT_FORMAT;
+      m_passive[v] = 0;
+      m_shared[v] = -1;
+    }
+
+    // Finite element zones are the same I by J grid, as quads
+    if (CTecplotZone::ordered != m_zone_type)
+    {
+      for (int j = 0; j + 1 < jmax; j++)
+      {
+        for (int i = 0; i + 1 < imax; i++)
+        {
+          const int n = j * imax + i;
+          m_nodes.Append(n);
+          m_nodes.Append(n + 1);
+          m_nodes.Append(n + 1 + imax);
+          m_nodes.Append(n + imax);
+        }
+      }
+    }
+  }
+
+  int PointCount() const { return m_imax * m_jmax; }
+  int ElementCount() const { return m_nodes.Count() / 4; }
+
+  // Sets the values of the variables that are stored in the zone
+  void SetValues(int seed)
+  {
+    for (int v = 0; v < VARIABLE_COUNT; v++)
+    {
+      m_values[v].SetCount(0);
+      for (int n = 0; n < PointCount(); n++)
+      {
+        double x = 0.0;
+        if (v < 3)
+          x = 0.25 * ((0 == v ? n % m_imax : n / m_imax) + (2 == v ? seed : 0));
+        else if (!m_passive[v])
+          x = sin(0.1 * n + v + seed);
+
+        // The values are exact in the format they are written in
+        if (SHORT_FORMAT == m_formats[v])
+          x = floor(1000.0 * x);
+        else if (FLOAT_FORMAT == m_formats[v])
+          x = (float)x;
+        m_values[v].Append(x);
+      }
+    }
+  }
+
+  CTecplotZone::zone_type m_zone_type;
+  int m_imax;
+  int m_jmax;
+  ON_SimpleArray<int> m_nodes;   // zero based, four for each element
+  int m_formats[VARIABLE_COUNT];
+  int m_passive[VARIABLE_COUNT];
+  int m_shared[VARIABLE_COUNT];  // the zone the values are shared with, or -1
+  int m_shared_nodes;            // the zone the connectivity is shared with, or -1
+  ON_SimpleArray<double> m_values[VARIABLE_COUNT];
+};
+
+static void AppendInt(ON_SimpleArray<char>& buffer, int i)
+{
+  const ON__INT32 value = (ON__INT32)i;
+  buffer.Append((int)sizeof(value), (const char*)&value);
+}
+
+static void AppendFloat(ON_SimpleArray<char>& buffer, float x)
+{
+  buffer.Append((int)sizeof(x), (const char*)&x);
+}
+
+static void AppendDouble(ON_SimpleArray<char>& buffer, double x)
+{
+  buffer.Append((int)sizeof(x), (const char*)&x);
+}
+
+static void AppendString(ON_SimpleArray<char>& buffer, const char* s)
+{
+  for (; *s; s++)
+    AppendInt(buffer, *s);
+  AppendInt(buffer, 0);
+}
+
+/*
+Description:
+  Writes zones as a "#!TDV112" binary file, with passive variables,
+  shared variables and shared connectivity.
+*/
+static bool WriteBinaryFile(const wchar_t* filename, const ON_ClassArray<CRoundTripZone>& zones)
+{
+  ON_SimpleArray<char> b;
+  b.Append(8, "#!TDV112");
+  AppendInt(b, 1); // byte order
+  AppendInt(b, 0); // full file
+  AppendString(b, "round trip");
+  AppendInt(b, VARIABLE_COUNT);
+  for (int v = 0; v < VARIABLE_COUNT; v++)
+    AppendString(b, VARIABLE_NAMES[v]);
+
+  int z;
+  for (z = 0; z < zones.Count(); z++)
+  {
+    const CRoundTripZone& zone = zones[z];
+    AppendFloat(b, 299.0f);
+    AppendString(b, "zone");
+    AppendInt(b, -1);    // parent zone
+    AppendInt(b, -1);    // strand
+    AppendDouble(b, 0.0);
+    AppendInt(b, -1);    // color
+    AppendInt(b, zone.m_zone_type);
+    AppendInt(b, 0);     // node located values
+    AppendInt(b, 0);     // face neighbors
+    AppendInt(b, 0);
+    if (CTecplotZone::ordered == zone.m_zone_type)
+    {
+      AppendInt(b, zone.m_imax);
+      AppendInt(b, zone.m_jmax);
+      AppendInt(b, 1);
+    }
+    else
+    {
+      AppendInt(b, zone.PointCount());
+      AppendInt(b, zone.ElementCount());
+      AppendInt(b, 0);
+      AppendInt(b, 0);
+      AppendInt(b, 0);
+    }
+    AppendInt(b, 0);     // no auxiliary data
+  }
+  AppendFloat(b, 357.0f);
+
+  for (z = 0; z < zones.Count(); z++)
+  {
+    const CRoundTripZone& zone = zones[z];
+    AppendFloat(b, 299.0f);
+    int v;
+    for (v = 0; v < VARIABLE_COUNT; v++)
+      AppendInt(b, zone.m_formats[v]);
+    AppendInt(b, 1);
+    for (v = 0; v < VARIABLE_COUNT; v++)
+      AppendInt(b, zone.m_passive[v]);
+    AppendInt(b, 1);
+    for (v = 0; v < VARIABLE_COUNT; v++)
+      AppendInt(b, zone.m_shared[v]);
+    AppendInt(b, zone.m_shared_nodes);
+
+    for (v = 0; v < VARIABLE_COUNT; v++)
+    {
+      if (!zone.m_passive[v] && zone.m_shared[v] < 0)
+      {
+        AppendDouble(b, 0.0);
+        AppendDouble(b, 1.0);
+      }
+    }
+
+    for (v = 0; v < VARIABLE_COUNT; v++)
+    {
+      if (zone.m_passive[v] || zone.m_shared[v] >= 0)
+        continue;
+      for (int n = 0; n < zone.PointCount(); n++)
+      {
+        const double x = zone.m_values[v][n];
+        if (DOUBLE_FORMAT == zone.m_formats[v])
+          AppendDouble(b, x);
+        else if (FLOAT_FORMAT == zone.m_formats[v])
+          AppendFloat(b, (float)x);
+        else
+        {
+          const ON__INT16 i = (ON__INT16)x;
+          b.Append((int)sizeof(i), (const char*)&i);
+        }
+      }
+    }
+
+    if (CTecplotZone::ordered != zone.m_zone_type && zone.m_shared_nodes < 0)
+    {
+      for (int i = 0; i < zone.m_nodes.Count(); i++)
+        AppendInt(b, zone.m_nodes[i]);
+    }
+  }
+
+  return CAnalysisTest::WriteFile(filename, b.Array(), b.UnsignedCount());
+}
+
+/*
+Description:
+  Writes the same zones as an ASCII file, with passive variables
+  written as zeros.
+Parameters:
+  bShared - [in] if true, shared values and connectivity are written
+                 with VARSHARELIST and CONNECTIVITYSHAREZONE, otherwise
+                 they are repeated.
+  offsets - [out] if not null, the offset of each ZONE record.
+*/
+static bool WriteTextFile(const wchar_t* filename, const ON_ClassArray<CRoundTripZone>& zones, bool bShared, ON_SimpleArray<ON__INT64>* offsets)
+{
+  ON_SimpleArray<char> t;
+  CAnalysisTest::AppendText(t, "TITLE = \"round trip\"\nVARIABLES =");
+  for (int v = 0; v < VARIABLE_COUNT; v++)
+    CAnalysisTest::AppendText(t, " \"%s\"", VARIABLE_NAMES[v]);
+  CAnalysisTest::AppendText(t, "\n");
+
+  for (int z = 0; z < zones.Count(); z++)
+  {
+    const CRoundTripZone& zone = zones[z];
+    const CRoundTripZone* values[VARIABLE_COUNT];
+    int v;
+    for (v = 0; v < VARIABLE_COUNT; v++)
+      values[v] = zone.m_shared[v] >= 0 ? &zones[zone.m_shared[v]] : &zone;
+
+    if (offsets)
+      offsets->Append(t.Count());
+    if (CTecplotZone::ordered == zone.m_zone_type)
+      CAnalysisTest::AppendText(t, "ZONE T=\"zone\", I=%d, J=%d, K=1, DATAPACKING=POINT", zone.m_imax, zone.m_jmax);
+    else
+      CAnalysisTest::AppendText(t, "ZONE T=\"zone\", N=%d, E=%d, ZONETYPE=FEQUADRILATERAL, DATAPACKING=BLOCK", zone.PointCount(), zone.ElementCount());
+
+    // One based variable and zone numbers, where the variables
+    // of a zone are shared with one zone
+    if (bShared)
+    {
+      int shared_zone = -1;
+      for (v = 0; v < VARIABLE_COUNT; v++)
+      {
+        if (zone.m_shared[v] < 0)
+          continue;
+        CAnalysisTest::AppendText(t, shared_zone < 0 ? ", VARSHARELIST=([%d" : ",%d", v + 1);
+        shared_zone = zone.m_shared[v];
+      }
+      if (shared_zone >= 0)
+        CAnalysisTest::AppendText(t, "]=%d)", shared_zone + 1);
+      if (zone.m_shared_nodes >= 0)
+        CAnalysisTest::AppendText(t, ", CONNECTIVITYSHAREZONE=%d", zone.m_shared_nodes + 1);
+    }
+
+    CAnalysisTest::AppendText(t, ", DT=(");
+    for (v = 0; v < VARIABLE_COUNT; v++)
+    {
+      const int format = values[v]->m_formats[v];
+      CAnalysisTest::AppendText(t, "%s ", DOUBLE_FORMAT == format ? "DOUBLE" : (SHORT_FORMAT == format ? "SHORTINT" : "SINGLE"));
+    }
+    CAnalysisTest::AppendText(t, ")\n");
+
+    // POINT data is one line for each node, BLOCK data
+    // is one line for each variable
+    const bool bPoint = (CTecplotZone::ordered == zone.m_zone_type);
+    const int outer_count = bPoint ? zone.PointCount() : VARIABLE_COUNT;
+    const int inner_count = bPoint ? VARIABLE_COUNT : zone.PointCount();
+    for (int i = 0; i < outer_count; i++)
+    {
+      v = bPoint ? 0 : i;
+      if (bShared && !bPoint && zone.m_shared[v] >= 0)
+        continue;
+      for (int j = 0; j < inner_count; j++)
+      {
+        v = bPoint ? j : i;
+        const int n = bPoint ? i : j;
+        if (bShared && zone.m_shared[v] >= 0)
+          continue;
+        CAnalysisTest::AppendText(t, " %.17g", values[v]->m_values[v][n]);
+      }
+      CAnalysisTest::AppendText(t, "\n");
+    }
+
+    // One based node indices
+    if (bShared && zone.m_shared_nodes >= 0)
+      continue;
+    const CRoundTripZone& nodes = zone.m_shared_nodes >= 0 ? zones[zone.m_shared_nodes] : zone;
+    for (int i = 0; i < nodes.m_nodes.Count(); i += 4)
+      CAnalysisTest::AppendText(t, "%d %d %d %d\n", nodes.m_nodes[i] + 1, nodes.m_nodes[i + 1] + 1, nodes.m_nodes[i + 2] + 1, nodes.m_nodes[i + 3] + 1);
+  }
+
+  return CAnalysisTest::WriteFile(filename, t.Array(), t.UnsignedCount());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Binary files are read into the same meshes as the same data in
+// an ASCII file
+class CTecplotBinaryRoundTripTest : public CAnalysisTest
+{
+public:
+  CTecplotBinaryRoundTripTest() : CAnalysisTest(L"Tecplot binary round trip", check_test) {}
+
+protected:
+  void Run() override
+  {
+    ON_ClassArray<CRoundTripZone> zones;
+
+    // An ordered zone with a passive variable
+    CRoundTripZone zone0(CTecplotZone::ordered, 5, 4);
+    zone0.m_passive[4] = 1;
+    zone0.SetValues(0);
+    zones.Append(zone0);
+
+    // A finite element zone with double and float values
+    CRoundTripZone zone1(CTecplotZone::fe_quadrilateral, 4, 3);
+    zone1.m_formats[3] = DOUBLE_FORMAT;
+    zone1.SetValues(1);
+    zones.Append(zone1);
+
+    // An ordered zone that shares the coordinates of zone 0
+    CRoundTripZone zone2(CTecplotZone::ordered, 5, 4);
+    zone2.m_shared[0] = zone2.m_shared[1] = zone2.m_shared[2] = 0;
+    zone2.m_formats[4] = SHORT_FORMAT;
+    zone2.SetValues(2);
+    zones.Append(zone2);
+
+    // A finite element zone that shares the coordinates and
+    // connectivity of zone 1
+    CRoundTripZone zone3(CTecplotZone::fe_quadrilateral, 4, 3);
+    zone3.m_shared[0] = zone3.m_shared[1] = zone3.m_shared[2] = 1;
+    zone3.m_shared_nodes = 1;
+    zone3.m_formats[4] = DOUBLE_FORMAT;
+    zone3.SetValues(3);
+    zones.Append(zone3);
+
+    const ON_wString binary_filename = TempFileName(L"roundtrip.plt");
+    const ON_wString text_filename = TempFileName(L"roundtrip.tp");
+    const ON_wString shared_filename = TempFileName(L"roundtrip_shared.tp");
+    ON_SimpleArray<ON__INT64> offsets;
+    if (Check(WriteBinaryFile(binary_filename, zones) && WriteTextFile(text_filename, zones, false, nullptr) && WriteTextFile(shared_filename, zones, true, &offsets), L"writing the files"))
+    {
+      CompareFiles(binary_filename, text_filename, zones.Count(), CTecplotImportOptions::auto_precision);
+      CompareFiles(binary_filename, text_filename, zones.Count(), CTecplotImportOptions::double_precision);
+      CompareFiles(binary_filename, shared_filename, zones.Count(), CTecplotImportOptions::auto_precision);
+      CompareFiles(binary_filename, shared_filename, zones.Count(), CTecplotImportOptions::double_precision);
+      CompareZoneValues(shared_filename, zones, offsets);
+    }
+
+    ::DeleteFileW(binary_filename);
+    ::DeleteFileW(text_filename);
+    ::DeleteFileW(shared_filename);
+  }
+
+private:
+  // The values of later time series frames are read without the
+  // coordinates, which shared zones do not have.
+  void CompareZoneValues(const wchar_t* filename, const ON_ClassArray<CRoundTripZone>& zones, const ON_SimpleArray<ON__INT64>& offsets)
+  {
+    CTecplotReader reader;
+    if (!Check(reader.Open(filename) && offsets.Count() == zones.Count(), L"opening the shared file"))
+      return;
+
+    const int channel_count = VARIABLE_COUNT - 3;
+    bool bSame = true;
+    for (int z = 0; z < zones.Count(); z++)
+    {
+      const CRoundTripZone& zone = zones[z];
+      const int point_count = zone.PointCount();
+      ON_SimpleArray<double> values(channel_count * point_count);
+      values.SetCount(channel_count * point_count);
+      if (!Check(reader.ReadZoneValues(offsets[z], point_count, VARIABLE_COUNT, values.Array()), L"reading zone values"))
+        return;
+
+      for (int c = 0; c < channel_count; c++)
+      {
+        for (int n = 0; n < point_count; n++)
+          bSame = bSame && (values[c * point_count + n] == zone.m_values[3 + c][n]);
+      }
+    }
+    Check(bSame, L"zone values");
+  }
+
+  void CompareFiles(const wchar_t* binary_filename, const wchar_t* text_filename, int zone_count, CTecplotImportOptions::value_precision precision)
+  {
+    CTecplotImportOptions options;
+    options.m_precision = precision;
+
+    ON_SimpleArray<ON_Mesh*> binary_meshes, text_meshes;
+    CTecplotBinaryReader binary_reader;
+    CTecplotReader text_reader;
+    const bool bBinary = binary_reader.Open(binary_filename) && binary_reader.ReadZones(binary_meshes, &options);
+    const bool bText = text_reader.Open(text_filename) && text_reader.ReadZones(text_meshes, &options);
+
+    if (Check(bBinary && bText, L"reading the files") && Check(zone_count == binary_meshes.Count() && zone_count == text_meshes.Count(), L"zone count"))
+    {
+      for (int i = 0; i < zone_count; i++)
+        CompareMeshes(binary_meshes[i], text_meshes[i]);
+    }
+
+    for (int i = 0; i < binary_meshes.Count(); i++)
+      delete binary_meshes[i];
+    for (int i = 0; i < text_meshes.Count(); i++)
+      delete text_meshes[i];
+  }
+
+  void CompareMeshes(const ON_Mesh* binary_mesh, const ON_Mesh* text_mesh)
+  {
+    const int vertex_count = binary_mesh->VertexCount();
+    const int face_count = binary_mesh->FaceCount();
+    if (!Check(vertex_count == text_mesh->VertexCount() && face_count == text_mesh->FaceCount(), L"vertex and face counts"))
+      return;
+
+    bool bSame = true;
+    for (int i = 0; i < vertex_count && bSame; i++)
+      bSame = (binary_mesh->m_V[i] == text_mesh->m_V[i]);
+    Check(bSame, L"vertices");
+
+    for (int i = 0; i < face_count && bSame; i++)
+      bSame = (0 == memcmp(binary_mesh->m_F[i].vi, text_mesh->m_F[i].vi, sizeof(binary_mesh->m_F[i].vi)));
+    Check(bSame, L"faces");
+
+    const CAnalysisUserData* binary_ud = CAnalysisUserData::Get(binary_mesh);
+    const CAnalysisUserData* text_ud = CAnalysisUserData::Get(text_mesh);
+    if (!Check(binary_ud && text_ud && binary_ud->ChannelCount() == text_ud->ChannelCount(), L"channel count"))
+      return;
+    Check(binary_ud->m_a.Precision() == text_ud->m_a.Precision(), L"precision");
+
+    ON_SimpleArray<double> binary_values(vertex_count), text_values(vertex_count);
+    binary_values.SetCount(vertex_count);
+    text_values.SetCount(vertex_count);
+    for (int c = 0; c < binary_ud->ChannelCount(); c++)
+    {
+      Check(0 == wcscmp(binary_ud->ChannelName(c), text_ud->ChannelName(c)), L"channel names");
+      if (Check(binary_ud->GetChannelValues(c, binary_values.Array()) && text_ud->GetChannelValues(c, text_values.Array()), L"getting channel values"))
+        Check(0 == memcmp(binary_values.Array(), text_values.Array(), sizeof(double) * vertex_count), L"channel values");
+    }
+    Check(binary_ud->m_minmax == text_ud->m_minmax, L"value range");
+  }
+};
+
+// The one and only CTecplotBinaryRoundTripTest test
+static class CTecplotBinaryRoundTripTest theTecplotBinaryRoundTripTest;
@@ -0,0 +1,560 @@
+// Copyright (c) 1993-2018 Robert McNeel & Associates. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// testTecplotReader.cpp
+
+#include "stdafx.h"
+#include "AnalysisTest.h"
+#include "AnalysisUserData.h"
+#include "TecplotImportOptions.h"
+#include "TecplotReader.h"
+#include <algorithm>
+
+/*
+Description:
+  Writes an ordered POINT zone in the format of sample_tecplot_mesh.tp,
+  an I by J by K grid of x, y, z and p values.
+*/
+static void AppendSampleZone(ON_SimpleArray<char>& text, int imax, int jmax, int kmax)
+{
+  CAnalysisTest::AppendText(text, "ZONE T=\"SubZone\"\n I=%d, J=%d, K=%d, ZONETYPE=Ordered\n DATAPACKING=POINT\n DT=(SINGLE SINGLE SINGLE SINGLE )\n", imax, jmax, kmax);
+  for (int k = 0; k < kmax; k++)
+  {
+    for (int j = 0; j < jmax; j++)
+    {
+      for (int i = 0; i < imax; i++)
+      {
+        const double u = (double)i / imax;
+        const double v = (double)k / kmax;
+        const double w = (double)j / jmax;
+        CAnalysisTest::AppendText(text, " %.6E %.6E %.6E %.6E\n", 0.27 + 0.1 * u, 0.007 * sin(ON_PI * u) + 0.01 * w, 0.0458 * (1.0 - v), 1.0 + 0.1 * sin(6.0 * u) * cos(4.0 * v) + w);
+      }
+    }
+  }
+}
+
+/*
+Description:
+  Writes a file with one ordered zone in the format of the sample.
+*/
+static bool WriteSampleFile(const wchar_t* filename, int imax, int jmax, int kmax, double& megabytes)
+{
+  ON_SimpleArray<char> text;
+  text.SetCapacity(64 * (size_t)imax * jmax * kmax + 256);
+  CAnalysisTest::AppendText(text, "TITLE     = \"p3tec\"\nVARIABLES = \"x\"\n\"y\"\n\"z\"\n\"p\"\n");
+  AppendSampleZone(text, imax, jmax, kmax);
+
+  megabytes = text.UnsignedCount() / (1024.0 * 1024.0);
+  return CAnalysisTest::WriteFile(filename, text.Array(), text.UnsignedCount());
+}
+
+static ON_Mesh* ReadTecplotFile(const wchar_t* filename, CTecplotImportOptions::value_precision precision)
+{
+  CTecplotImportOptions options;
+  options.m_precision = precision;
+
+  CTecplotReader reader;
+  if (!reader.Open(filename))
+    return nullptr;
+  return reader.ReadZone(nullptr, &options);
+}
+
+/*
+Description:
+  Writes an ordered POINT zone on the unit grid, with x = i, y = j and
+  z = k, so every face of the block is axis aligned.
+*/
+static void AppendGridZone(ON_SimpleArray<char>& text, int imax, int jmax, int kmax)
+{
+  CAnalysisTest::AppendText(text, "ZONE I=%d, J=%d, K=%d, DATAPACKING=POINT\n", imax, jmax, kmax);
+  for (int k = 0; k < kmax; k++)
+  {
+    for (int j = 0; j < jmax; j++)
+    {
+      for (int i = 0; i < imax; i++)
+        CAnalysisTest::AppendText(text, "%d %d %d %d\n", i, j, k, i + j + k);
+    }
+  }
+}
+
+/*
+Description:
+  Writes a finite element POINT zone.
+Parameters:
+  zone_type         - [in] FEBRICK or FETETRAHEDRON.
+  points            - [in] the nodes.
+  nodes             - [in] zero based nodes of the elements.
+  nodes_per_element - [in] 4 or 8.
+*/
+static void AppendElementZone(ON_SimpleArray<char>& text, const char* zone_type, const ON_3dPointArray& points, const ON_SimpleArray<int>& nodes, int nodes_per_element)
+{
+  const int element_count = nodes.Count() / nodes_per_element;
+  CAnalysisTest::AppendText(text, "ZONE N=%d, E=%d, ZONETYPE=%s, DATAPACKING=POINT\n", points.Count(), element_count, zone_type);
+  for (int i = 0; i < points.Count(); i++)
+    CAnalysisTest::AppendText(text, "%g %g %g %d\n", points[i].x, points[i].y, points[i].z, i);
+  for (int e = 0; e < element_count; e++)
+  {
+    for (int n = 0; n < nodes_per_element; n++)
+      CAnalysisTest::AppendText(text, n ? " %d" : "%d", nodes[e * nodes_per_element + n] + 1);
+    CAnalysisTest::AppendText(text, "\n");
+  }
+}
+
+// Reads a zone from a file with a title and the x, y, z and p variables
+static ON_Mesh* ReadZoneText(const wchar_t* name, const ON_SimpleArray<char>& zone, const CTecplotImportOptions& options)
+{
+  ON_SimpleArray<char> text;
+  CAnalysisTest::AppendText(text, "TITLE = \"faces\"\nVARIABLES = \"x\" \"y\" \"z\" \"p\"\n");
+  text.Append(zone.Count(), zone.Array());
+
+  const ON_wString filename = CAnalysisTest::TempFileName(name);
+  ON_Mesh* mesh = nullptr;
+  if (CAnalysisTest::WriteFile(filename, text.Array(), text.UnsignedCount()))
+  {
+    CTecplotReader reader;
+    if (reader.Open(filename))
+      mesh = reader.ReadZone(nullptr, &options);
+  }
+  ::DeleteFileW(filename);
+  return mesh;
+}
+
+// The normal of a quad or triangle, from its diagonals, scaled by twice its area
+static ON_3dVector FaceNormal(const ON_Mesh* mesh, const ON_MeshFace& f)
+{
+  const ON_3dPoint v0(mesh->m_V[f.vi[0]]);
+  const ON_3dPoint v1(mesh->m_V[f.vi[1]]);
+  const ON_3dPoint v2(mesh->m_V[f.vi[2]]);
+  const ON_3dPoint v3(mesh->m_V[f.vi[3]]);
+  return ON_CrossProduct(v2 - v0, v3 - v1);
+}
+
+static ON_3dPoint FaceCenter(const ON_Mesh* mesh, const ON_MeshFace& f)
+{
+  const int count = f.IsTriangle() ? 3 : 4;
+  ON_3dPoint center(0.0, 0.0, 0.0);
+  for (int i = 0; i < count; i++)
+    center += ON_3dPoint(mesh->m_V[f.vi[i]]);
+  return center / count;
+}
+
+// True if every face of a convex mesh points away from the average of
+// its vertices, which is inside it
+static bool IsOutward(const ON_Mesh* mesh)
+{
+  ON_3dPoint center(0.0, 0.0, 0.0);
+  for (int i = 0; i < mesh->m_V.Count(); i++)
+    center += ON_3dPoint(mesh->m_V[i]);
+  center = center / mesh->m_V.Count();
+  for (int i = 0; i < mesh->m_F.Count(); i++)
+  {
+    const ON_MeshFace& f = mesh->m_F[i];
+    if (!(FaceNormal(mesh, f) * (FaceCenter(mesh, f) - center) > 0.0))
+      return false;
+  }
+  return true;
+}
+
+// True if every edge is used once in each direction, so the faces form
+// a closed surface with a consistent orientation
+static bool IsClosed(const ON_Mesh* mesh)
+{
+  ON_SimpleArray<ON__UINT64> edges(4 * mesh->m_F.Count());
+  for (int i = 0; i < mesh->m_F.Count(); i++)
+  {
+    const ON_MeshFace& f = mesh->m_F[i];
+    const int count = f.IsTriangle() ? 3 : 4;
+    for (int j = 0; j < count; j++)
+      edges.Append(((ON__UINT64)f.vi[j] << 32) | (ON__UINT32)f.vi[(j + 1) % count]);
+  }
+
+  ON__UINT64* begin = edges.Array();
+  ON__UINT64* end = begin + edges.Count();
+  std::sort(begin, end);
+  if (std::adjacent_find(begin, end) != end)
+    return false;
+  for (const ON__UINT64* e = begin; e < end; e++)
+  {
+    const ON__UINT64 reverse = (*e >> 32) | (*e << 32);
+    if (!std::binary_search(begin, end, reverse))
+      return false;
+  }
+  return true;
+}
+
+static int TriangleCount(const ON_Mesh* mesh)
+{
+  int count = 0;
+  for (int i = 0; i < mesh->m_F.Count(); i++)
+  {
+    if (mesh->m_F[i].IsTriangle())
+      count++;
+  }
+  return count;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Numbers are converted exactly as swscanf converted them
+class CTecplotNumbersTest : public CAnalysisTest
+{
+public:
+  CTecplotNumbersTest() : CAnalysisTest(L"Tecplot ASCII numbers", check_test) {}
+
+protected:
+  void Run() override
+  {
+    static const char* formats[] = { "%.6E", "%.17g", "%g", "%.3f", "%.10e", "%+.12E" };
+    const int format_count = (int)(sizeof(formats) / sizeof(formats[0]));
+    const int point_count = 4096;
+
+    ON_SimpleArray<char> text;
+    AppendText(text, "TITLE = \"numbers\"\nVARIABLES = \"x\" \"y\" \"z\" \"p\"\nZONE T=\"numbers\"\n I=%d, J=%d, K=1, DATAPACKING=POINT\n", 64, point_count / 64);
+
+    ON_SimpleArray<double> expected(4 * point_count);
+    for (int i = 0; i < point_count; i++)
+    {
+      for (int j = 0; j < 4; j++)
+      {
+        // Magnitudes from 1e-30 to 1e+30, and both signs
+        const double x = (i & 1 ? -1.0 : 1.0) * sin(i * 0.37 + j) * pow(10.0, (i * 7 + j) % 61 - 30);
+
+        char token[64];
+        snprintf(token, sizeof(token), formats[(i + j) % format_count], x);
+
+        double value = 0.0;
+        ON_wString wtoken(token);
+        swscanf(static_cast<const wchar_t*>(wtoken), L"%lf", &value);
+        expected.Append(value);
+
+        AppendText(text, j ? " %s" : "%s", token);
+      }
+      AppendText(text, "\n");
+    }
+
+    const ON_wString filename = TempFileName(L"numbers.tp");
+    if (!Check(WriteFile(filename, text.Array(), text.UnsignedCount()), L"writing the file"))
+      return;
+
+    ON_Mesh* mesh = ReadTecplotFile(filename, CTecplotImportOptions::double_precision);
+    const CAnalysisUserData* ud = CAnalysisUserData::Get(mesh);
+    if (Check(ud && mesh->VertexCount() == point_count, L"reading the file"))
+    {
+      int wrong_count = 0;
+      for (int i = 0; i < point_count; i++)
+      {
+        const ON_3fPoint& v = mesh->m_V[i];
+        if (v.x != (float)expected[4 * i] || v.y != (float)expected[4 * i + 1] || v.z != (float)expected[4 * i + 2])
+          wrong_count++;
+        if (ud->m_a[i] != expected[4 * i + 3])
+          wrong_count++;
+      }
+      Check(0 == wrong_count, L"values match swscanf");
+    }
+
+    delete mesh;
+    ::DeleteFileW(filename);
+  }
+};
+
+// The one and only CTecplotNumbersTest test
+static class CTecplotNumbersTest theTecplotNumbersTest;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Boundary only import of an ordered block makes the closed surface of
+// the block, with the slice planes inside it
+class CTecplotBoundaryTest : public CAnalysisTest
+{
+public:
+  CTecplotBoundaryTest() : CAnalysisTest(L"Tecplot boundary surfaces", check_test) {}
+
+protected:
+  void Run() override
+  {
+    const int imax = 4, jmax = 3, kmax = 5;
+    const int ci = imax - 1, cj = jmax - 1, ck = kmax - 1;
+    const int boundary_face_count = 2 * (ci * cj + cj * ck + ci * ck);
+    const int boundary_point_count = imax * jmax * kmax - (imax - 2) * (jmax - 2) * (kmax - 2);
+
+    ON_SimpleArray<char> zone;
+    AppendGridZone(zone, imax, jmax, kmax);
+
+    CTecplotImportOptions options;
+    options.m_bBoundaryOnly = true;
+    ON_Mesh* mesh = ReadZoneText(L"boundary.tp", zone, options);
+    if (Check(nullptr != mesh, L"reading the block"))
+    {
+      Check(boundary_face_count == mesh->m_F.Count() && 0 == TriangleCount(mesh), L"2(IJ+JK+IK) quads for the cells of the block");
+      Check(boundary_point_count == mesh->m_V.Count(), L"only the boundary points are kept");
+      Check(IsOutward(mesh) && IsClosed(mesh), L"the boundary is closed and points outward");
+    }
+    delete mesh;
+
+    // Two I slices and a K slice. The exterior planes are not added twice.
+    options.m_slices[0].Append(1);
+    options.m_slices[0].Append(2);
+    options.m_slices[0].Append(0);
+    options.m_slices[2].Append(2);
+    options.m_slices[2].Append(kmax - 1);
+    mesh = ReadZoneText(L"slices.tp", zone, options);
+    if (Check(nullptr != mesh, L"reading the block with slices"))
+    {
+      Check(boundary_face_count + 2 * cj * ck + ci * cj == mesh->m_F.Count(), L"one plane of faces for each slice inside the block");
+      Check(imax * jmax * kmax == mesh->m_V.Count(), L"the slices keep the points inside the block");
+
+      // Faces inside the block belong to a slice, and are oriented
+      // along +I or +K
+      const ON_BoundingBox bbox = mesh->BoundingBox();
+      int slice_face_count = 0;
+      bool bOriented = true;
+      for (int i = 0; i < mesh->m_F.Count(); i++)
+      {
+        const ON_MeshFace& f = mesh->m_F[i];
+        const ON_3dPoint center = FaceCenter(mesh, f);
+        const ON_3dVector normal = FaceNormal(mesh, f);
+        if (center.x > bbox.m_min.x && center.x < bbox.m_max.x && center.y > bbox.m_min.y && center.y < bbox.m_max.y && center.z > bbox.m_min.z && center.z < bbox.m_max.z)
+        {
+          slice_face_count++;
+          const bool bI = (center.x == floor(center.x));
+          if (!(bI ? (normal.x > 0.0 && 0.0 == normal.y && 0.0 == normal.z) : (normal.z > 0.0 && 0.0 == normal.x && 0.0 == normal.y)))
+            bOriented = false;
+        }
+      }
+      Check(2 * cj * ck + ci * cj == slice_face_count && bOriented, L"the slice faces are oriented along +I and +K");
+    }
+    delete mesh;
+
+    // A single plane is one layer of faces
+    options.m_slices[0].Empty();
+    options.m_slices[2].Empty();
+    ON_SimpleArray<char> plane;
+    AppendGridZone(plane, imax, jmax, 1);
+    mesh = ReadZoneText(L"plane.tp", plane, options);
+    Check(nullptr != mesh && ci * cj == mesh->m_F.Count() && imax * jmax == mesh->m_V.Count(), L"a block with one K plane");
+    delete mesh;
+  }
+};
+
+// The one and only CTecplotBoundaryTest test
+static class CTecplotBoundaryTest theTecplotBoundaryTest;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Brick and tetrahedron zones are imported as the closed surface of
+// their volume, and collapsed brick corners make triangles
+class CTecplotVolumeBoundaryTest : public CAnalysisTest
+{
+public:
+  CTecplotVolumeBoundaryTest() : CAnalysisTest(L"Tecplot volume element boundaries", check_test) {}
+
+protected:
+  void Run() override
+  {
+    // A 2 x 2 x 2 block of unit cubes
+    const int n = 3;
+    ON_3dPointArray points(n * n * n);
+    for (int k = 0; k < n; k++) for (int j = 0; j < n; j++) for (int i = 0; i < n; i++)
+      points.Append(ON_3dPoint(i, j, k));
+
+    ON_SimpleArray<int> bricks;
+    ON_SimpleArray<int> tets;
+    for (int k = 0; k + 1 < n; k++) for (int j = 0; j + 1 < n; j++) for (int i = 0; i + 1 < n; i++)
+    {
+      // Corners counterclockwise from +Z at the bottom, then at the top
+      const int v = i + (j + k * n) * n;
+      const int corners[8] = { v, v + 1, v + 1 + n, v + n, v + n * n, v + 1 + n * n, v + 1 + n + n * n, v + n + n * n };
+      bricks.Append(8, corners);
+      AppendCubeTetrahedra(points, v, n, tets);
+    }
+
+    CTecplotImportOptions options;
+    ON_SimpleArray<char> zone;
+    AppendElementZone(zone, "FEBRICK", points, bricks, 8);
+    ON_Mesh* mesh = ReadZoneText(L"bricks.tp", zone, options);
+    if (Check(nullptr != mesh, L"reading the bricks"))
+    {
+      Check(24 == mesh->m_F.Count() && 0 == TriangleCount(mesh), L"24 boundary quads of a 2 x 2 x 2 brick block");
+      Check(26 == mesh->m_V.Count(), L"the center node is dropped");
+      Check(IsOutward(mesh) && IsClosed(mesh), L"the brick boundary is closed and points outward");
+    }
+    delete mesh;
+
+    zone.SetCount(0);
+    AppendElementZone(zone, "FETETRAHEDRON", points, tets, 4);
+    mesh = ReadZoneText(L"tets.tp", zone, options);
+    if (Check(nullptr != mesh, L"reading the tetrahedra"))
+    {
+      Check(48 == mesh->m_F.Count() && 48 == TriangleCount(mesh), L"48 boundary triangles of the tetrahedralized block");
+      Check(IsOutward(mesh) && IsClosed(mesh), L"the tetrahedron boundary is closed and points outward");
+    }
+    delete mesh;
+
+    // Two triangular prisms, one on top of the other, written as bricks
+    // with the third and seventh corners repeated
+    ON_3dPointArray prism_points(9);
+    for (int k = 0; k < 3; k++)
+    {
+      prism_points.Append(ON_3dPoint(0.0, 0.0, k));
+      prism_points.Append(ON_3dPoint(1.0, 0.0, k));
+      prism_points.Append(ON_3dPoint(0.0, 1.0, k));
+    }
+    ON_SimpleArray<int> prisms;
+    for (int k = 0; k < 2; k++)
+    {
+      const int v = 3 * k;
+      const int corners[8] = { v, v + 1, v + 2, v + 2, v + 3, v + 4, v + 5, v + 5 };
+      prisms.Append(8, corners);
+    }
+    zone.SetCount(0);
+    AppendElementZone(zone, "FEBRICK", prism_points, prisms, 8);
+    mesh = ReadZoneText(L"prisms.tp", zone, options);
+    if (Check(nullptr != mesh, L"reading the prisms"))
+    {
+      Check(8 == mesh->m_F.Count() && 2 == TriangleCount(mesh), L"the prism column has two triangle caps and six quads");
+      Check(IsOutward(mesh) && IsClosed(mesh), L"the prism boundary is closed and points outward");
+    }
+    delete mesh;
+  }
+
+private:
+  /*
+  Description:
+    Appends the six tetrahedra of a unit cube that share the diagonal
+    from its first to its last corner, so neighboring cubes split their
+    shared faces the same way. Every tetrahedron has a positive volume.
+  */
+  static void AppendCubeTetrahedra(const ON_3dPointArray& points, int v, int n, ON_SimpleArray<int>& tets)
+  {
+    const int steps[3] = { 1, n, n * n };
+    static const int axes[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+    for (int t = 0; t < 6; t++)
+    {
+      int tet[4] = { v, 0, 0, 0 };
+      for (int c = 1; c < 4; c++)
+        tet[c] = tet[c - 1] + steps[axes[t][c - 1]];
+
+      const ON_3dPoint& p0 = points[tet[0]];
+      const double volume = ON_TripleProduct(points[tet[1]] - p0, points[tet[2]] - p0, points[tet[3]] - p0);
+      if (volume < 0.0)
+        std::swap(tet[1], tet[2]);
+      tets.Append(4, tet);
+    }
+  }
+};
+
+// The one and only CTecplotVolumeBoundaryTest test
+static class CTecplotVolumeBoundaryTest theTecplotVolumeBoundaryTest;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Parse throughput of the reader, and of the fgetws and swscanf
+// loop that it replaced, on the sample mesh scaled up
+class CTecplotThroughputBenchmark : public CAnalysisTest
+{
+public:
+  CTecplotThroughputBenchmark() : CAnalysisTest(L"Tecplot ASCII throughput", benchmark_test) {}
+
+protected:
+  void Run() override
+  {
+    // 33 x 65 in the sample, scaled up to a million points
+    const int imax = 33 * 30;
+    const int kmax = 65 * 16;
+
+    double megabytes = 0.0;
+    const ON_wString filename = TempFileName(L"throughput.tp");
+    if (!WriteSampleFile(filename, imax, 1, kmax, megabytes))
+      return;
+
+    double start = Seconds();
+    ON_Mesh* mesh = ReadTecplotFile(filename, CTecplotImportOptions::auto_precision);
+    const double read_seconds = Seconds() - start;
+    if (mesh)
+      Print(L"Reader: %.1f MB, %d points in %.3f seconds, %.1f MB/s", megabytes, mesh->VertexCount(), read_seconds, megabytes / read_seconds);
+    delete mesh;
+
+    start = Seconds();
+    const int line_count = ScanLines(filename);
+    const double scan_seconds = Seconds() - start;
+    Print(L"fgetws and swscanf: %d lines in %.3f seconds, %.1f MB/s", line_count, scan_seconds, megabytes / scan_seconds);
+
+    ::DeleteFileW(filename);
+  }
+
+private:
+  // The value loop of the original reader, without building a mesh
+  static int ScanLines(const wchar_t* filename)
+  {
+    FILE* fp = ON::OpenFile(filename, L"r");
+    if (nullptr == fp)
+      return 0;
+
+    int line_count = 0;
+    wchar_t line[129];
+    double x, y, z, a;
+    while (fgetws(line, 128, fp))
+    {
+      if (4 == swscanf(line, L"%lf %lf %lf %lf", &x, &y, &z, &a))
+        line_count++;
+    }
+
+    ON::CloseFile(fp);
+    return line_count;
+  }
+};
+
+// The one and only CTecplotThroughputBenchmark test
+static class CTecplotThroughputBenchmark theTecplotThroughputBenchmark;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// Time and peak memory of structured zone import, with every grid plane
+// and with only the boundary. The TP_GRID reader that this replaced
+// held a 56 byte TP_POINT for every node, on top of the mesh.
+class CTecplotStructuredBenchmark : public CAnalysisTest
+{
+public:
+  CTecplotStructuredBenchmark() : CAnalysisTest(L"Tecplot structured import", benchmark_test) {}
+
+protected:
+  void Run() override
+  {
+    const int n = 120;
+    double megabytes = 0.0;
+    const ON_wString filename = TempFileName(L"structured.tp");
+    if (!WriteSampleFile(filename, n, n, n, megabytes))
+      return;
+
+    const int point_count = n * n * n;
+    Print(L"%d x %d x %d grid, %d points, %.1f MB file", n, n, n, point_count, megabytes);
+    Print(L"A TP_GRID would have needed %.1f MB for its points", 56.0 * point_count / (1024.0 * 1024.0));
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+      CTecplotImportOptions options;
+      options.m_bBoundaryOnly = (1 == pass);
+
+      CAnalysisMemoryPeak peak;
+      const double start = Seconds();
+      CTecplotReader reader;
+      ON_Mesh* mesh = reader.Open(filename) ? reader.ReadZone(nullptr, &options) : nullptr;
+      const double seconds = Seconds() - start;
+      const size_t peak_bytes = peak.Stop();
+
+      if (mesh)
+      {
+        const size_t mesh_bytes = sizeof(ON_3fPoint) * mesh->m_V.Count() + sizeof(ON_MeshFace) * mesh->m_F.Count();
+        Print(L"%s: %d faces in %.3f seconds, %.1f MB peak, %.1f MB of vertices and faces",
+          options.m_bBoundaryOnly ? L"Boundary" : L"All planes", mesh->FaceCount(), seconds,
+          peak_bytes / (1024.0 * 1024.0), mesh_bytes / (1024.0 * 1024.0));
+      }
+      delete mesh;
+    }
+
+    ::DeleteFileW(filename);
+  }
+};
+
+// The one and only CTecplotStructuredBenchmark test
+static class CTecplotStructuredBenchmark theTecplotStructuredBenchmark;